@@ -0,0 +1,224 @@
+/**
+ * @author Matrixchung
+ * @brief  An AlgMatcher spots known algorithms in the live move stream (Aho-Corasick over the 18 moves).
+ *
+ * Algorithms are added by name and notation (all of them before build()), then build() turns the trie into a full transition table,
+ * so every incoming move is one table lookup, whatever the size of the library.
+ *
+ * Matching runs on the canonical stream of a MoveCanonicalizer, and algorithms are canonicalized the same way when added:
+ * R R matches R2, R R' and commuting opposite face turns in any order are handled.
+ * The automaton state is kept per canonical entry, so a merge or cancellation only recomputes the 1 - 2 entries that changed.
+ * An entry is final once a move on another axis follows it (or flush() is called when the cube goes still),
+ * and matches ending there are reported then, with the timestamps of their first and last quarter turns.
+ *
+ * Memory: 18 transitions per trie node (~40 bytes), a few hundred algorithms need a few thousand nodes. Indices are 16 bit,
+ * so a library is capped at 65,534 nodes and algorithms, addAlgorithm() refuses more.
+ *
+ * **/
+#ifndef _ALG_MATCHER_HPP
+#define _ALG_MATCHER_HPP
+
+#include <cstdint>
+#include <vector>
+using std::vector;
+#include <string>
+using std::string;
+#include "CubeModel.hpp"
+#include "MoveCanonicalizer.hpp"
+
+#define ALG_MATCHER_MAX_LENGTH CANON_WINDOW // canonical moves of the longest algorithm
+#define ALG_NONE 0xFFFF
+
+struct AlgMatch
+{
+    uint16_t alg;       // index in the order of addAlgorithm()
+    uint64_t startTime; // us of the first quarter turn
+    uint64_t endTime;   // us of the last quarter turn
+};
+
+class AlgMatcher
+{
+    public:
+        typedef void (*MatchCallback)(const AlgMatch &match);
+    private:
+        struct Node
+        {
+            uint16_t next[18];
+            uint16_t alg;      // algorithm ending here, ALG_NONE if not
+            uint16_t dictLink; // nearest suffix node with an algorithm, 0 if none
+        };
+        vector<Node> nodes;
+        vector<string> names;
+        vector<uint8_t> lengths;
+        bool built;
+        // stream state, states[] and reported[] run parallel to the canonicalizer's window
+        MoveCanonicalizer canon;
+        uint16_t states[CANON_WINDOW]; // node after each canonical entry
+        bool reported[CANON_WINDOW];
+        uint16_t baseState;            // node before the oldest entry of the window
+        uint32_t settledTo;            // entries before this are final and reported
+        MatchCallback callback;
+        void _settle(uint32_t end);
+        void _report(uint32_t position);
+    public:
+        AlgMatcher();
+        bool addAlgorithm(const char *name, const char *notation); // false if the notation is invalid, too long, already built or the library is full
+        void build();
+        void reset(); // start of a new stream, e.g. a new solve
+        void onMove(MOVE move, uint64_t timestamp);
+        void flush(); // finalize the last moves
+        void setCallback(MatchCallback callback);
+        const MoveCanonicalizer &getCanonicalizer() const;
+        const char *getName(uint16_t alg) const;
+        uint16_t size() const;
+};
+
+AlgMatcher::AlgMatcher()
+{
+    this->nodes.resize(1);
+    for(uint8_t i = 0; i < 18; i++) this->nodes[0].next[i] = 0;
+    this->nodes[0].alg = ALG_NONE;
+    this->nodes[0].dictLink = 0;
+    this->built = false;
+    this->callback = nullptr;
+    this->reset();
+}
+bool AlgMatcher::addAlgorithm(const char *name, const char *notation)
+{
+    if(this->built) return false;
+    MOVE raw[ALG_MATCHER_MAX_LENGTH * 2];
+    int16_t count = parseMoves(notation, raw, ALG_MATCHER_MAX_LENGTH * 2);
+    if(count <= 0) return false;
+    MoveCanonicalizer normalized;
+    for(int16_t i = 0; i < count; i++) normalized.push(raw[i]);
+    if(normalized.getBase() != 0 || normalized.getEnd() == 0) return false;
+    uint8_t length = normalized.getEnd();
+    MOVE moves[ALG_MATCHER_MAX_LENGTH];
+    for(uint8_t i = 0; i < length; i++) moves[i] = normalized.at(i).move;
+    // node indices and algorithm indices are 16 bit, and ALG_NONE is taken
+    if(this->names.size() >= ALG_NONE) return false;
+    uint16_t node = 0;
+    uint8_t i = 0;
+    for(; i < length && this->nodes[node].next[(uint8_t)moves[i]]; i++) node = this->nodes[node].next[(uint8_t)moves[i]];
+    if(this->nodes.size() + (length - i) >= 0xFFFF) return false;
+    for(; i < length; i++)
+    {
+        uint16_t &next = this->nodes[node].next[(uint8_t)moves[i]];
+        if(next == 0)
+        {
+            Node child;
+            for(uint8_t j = 0; j < 18; j++) child.next[j] = 0;
+            child.alg = ALG_NONE;
+            child.dictLink = 0;
+            next = this->nodes.size();
+            this->nodes.push_back(child); // invalidates 'next'
+        }
+        node = this->nodes[node].next[(uint8_t)moves[i]];
+    }
+    if(this->nodes[node].alg == ALG_NONE) this->nodes[node].alg = this->names.size(); // identical sequences keep the first name
+    this->names.push_back(name);
+    this->lengths.push_back(length);
+    this->built = false;
+    return true;
+}
+// BFS over the trie: fail links turn missing edges into the transitions of the longest proper suffix.
+void AlgMatcher::build()
+{
+    vector<uint16_t> fail(this->nodes.size(), 0);
+    vector<uint16_t> queue;
+    queue.reserve(this->nodes.size());
+    for(uint8_t c = 0; c < 18; c++)
+    {
+        uint16_t child = this->nodes[0].next[c];
+        if(child) queue.push_back(child);
+    }
+    for(size_t head = 0; head < queue.size(); head++)
+    {
+        uint16_t u = queue[head];
+        for(uint8_t c = 0; c < 18; c++)
+        {
+            uint16_t v = this->nodes[u].next[c];
+            uint16_t f = this->nodes[fail[u]].next[c];
+            if(v)
+            {
+                fail[v] = f;
+                this->nodes[v].dictLink = this->nodes[f].alg != ALG_NONE ? f : this->nodes[f].dictLink;
+                queue.push_back(v);
+            }
+            else this->nodes[u].next[c] = f;
+        }
+    }
+    this->built = true;
+    this->reset();
+}
+void AlgMatcher::reset()
+{
+    this->canon.reset();
+    this->baseState = 0;
+    this->settledTo = 0;
+}
+void AlgMatcher::onMove(MOVE move, uint64_t timestamp)
+{
+    if(!this->built || move >= MOVE::NONE) return;
+    uint32_t oldBase = this->canon.getBase();
+    uint32_t changed = this->canon.push(move, timestamp);
+    uint32_t base = this->canon.getBase();
+    if(base != oldBase) this->baseState = this->states[(base - 1) % CANON_WINDOW];
+    if(changed < base) changed = base;
+    for(uint32_t p = changed; p < this->canon.getEnd(); p++)
+    {
+        uint16_t before = p == base ? this->baseState : this->states[(p - 1) % CANON_WINDOW];
+        this->states[p % CANON_WINDOW] = this->nodes[before].next[(uint8_t)this->canon.at(p).move];
+        this->reported[p % CANON_WINDOW] = false;
+    }
+    if(changed < this->settledTo) this->settledTo = changed;
+    this->_settle(this->canon.getEnd() - this->canon.getTopBlock());
+}
+void AlgMatcher::flush()
+{
+    this->_settle(this->canon.getEnd());
+}
+void AlgMatcher::setCallback(MatchCallback callback)
+{
+    this->callback = callback;
+}
+const char *AlgMatcher::getName(uint16_t alg) const
+{
+    return alg < this->names.size() ? this->names[alg].c_str() : "";
+}
+uint16_t AlgMatcher::size() const
+{
+    return this->names.size();
+}
+const MoveCanonicalizer &AlgMatcher::getCanonicalizer() const
+{
+    return this->canon;
+}
+void AlgMatcher::_settle(uint32_t end)
+{
+    if(this->settledTo < this->canon.getBase()) this->settledTo = this->canon.getBase();
+    for(uint32_t p = this->settledTo; p < end; p++)
+    {
+        if(this->reported[p % CANON_WINDOW]) continue;
+        this->reported[p % CANON_WINDOW] = true;
+        this->_report(p);
+    }
+    this->settledTo = end;
+}
+void AlgMatcher::_report(uint32_t position)
+{
+    uint16_t node = this->states[position % CANON_WINDOW];
+    if(this->nodes[node].alg == ALG_NONE) node = this->nodes[node].dictLink;
+    while(node && this->callback)
+    {
+        uint16_t alg = this->nodes[node].alg;
+        uint32_t first = position + 1 - this->lengths[alg];
+        AlgMatch match;
+        match.alg = alg;
+        match.startTime = this->canon.at(first < this->canon.getBase() ? this->canon.getBase() : first).startTime;
+        match.endTime = this->canon.at(position).endTime;
+        this->callback(match);
+        node = this->nodes[node].dictLink;
+    }
+}
+#endif
@@ -0,0 +1,186 @@
+/**
+ * @author Matrixchung
+ * @brief  A CfopTracker splits a running solve into CFOP steps, like cstimer does.
+ *
+ * Steps: CROSS -> F2L_1 -> F2L_2 -> F2L_3 -> F2L_4 -> OLL -> PLL -> DONE
+ *
+ * Cross and F2L are bitmask predicates over CubeModel::getSolvedMask(), which is already kept incrementally:
+ *  cross on face f    : the 4 edges of f are solved
+ *  F2L pairs          : popcount of solved (corner, middle edge) pairs around the cross
+ *  OLL                : F2L solved and every last layer sticker shows the last layer's color
+ *  PLL                : OLL solved and the last layer is solved up to AUF
+ * Each onMove() is a handful of mask tests, with 8 table lookups for OLL / PLL once F2L is done.
+ * The cross color is detected (the first cross solved) unless fixed by reset(face).
+ * The OLL case is recognized when F2L is done and the PLL case when OLL is done, see LastLayer.hpp.
+ * Steps never regress: a split is the first time its predicate held, and skipped steps share the same split.
+ *
+ * **/
+#ifndef _CFOP_TRACKER_HPP
+#define _CFOP_TRACKER_HPP
+
+#include <cstdint>
+#include "CubeModel.hpp"
+#include "LastLayer.hpp"
+
+enum class CFOP_STEP : uint8_t {CROSS, F2L_1, F2L_2, F2L_3, F2L_4, OLL, PLL, DONE};
+
+// Edges of each face's cross, in solvedMask bits
+const static uint32_t CROSS_MASK[6] = {0x00F, 0x232, 0x464, 0x8C8, 0x191, 0xF00};
+// (corner, middle edge) pair of each F2L slot around a cross face, in the order of FACE_CORNERS
+const static uint32_t F2L_PAIR_MASK[6][4] = {{0x01010, 0x02020, 0x04040, 0x08080},
+                                              {0x01001, 0x10100, 0x20400, 0x02004},
+                                              {0x02002, 0x20200, 0x40800, 0x04008},
+                                              {0x04004, 0x40400, 0x80100, 0x08001},
+                                              {0x01002, 0x08008, 0x80800, 0x10200},
+                                              {0x10010, 0x80080, 0x40040, 0x20020}};
+
+class CfopTracker
+{
+    private:
+        CFOP_STEP step;
+        FACE crossFace;
+        FACE fixedCrossFace;
+        uint8_t pairCount;
+        uint8_t ollCase;
+        uint8_t pllCase;
+        uint32_t splits[(uint8_t)CFOP_STEP::DONE];
+        uint32_t _f2lMask() const;
+        bool _isLastLayerOriented(const CubeModel &cube) const;
+        bool _isLastLayerPermuted(const CubeModel &cube) const;
+        void _split(uint32_t elapsed);
+    public:
+        CfopTracker();
+        void reset(FACE crossFace = FACE::NONE); // FACE::NONE - detect the cross color
+        void onMove(const CubeModel &cube, uint32_t elapsed); // elapsed us since the solve started
+        CFOP_STEP getStep() const;
+        FACE getCrossFace() const;
+        uint8_t getPairCount() const;
+        uint8_t getOllCase() const; // LL_UNKNOWN until F2L is done
+        uint8_t getPllCase() const; // LL_UNKNOWN until OLL is done
+        uint32_t getSplit(CFOP_STEP step) const; // us since the solve started, 0 if not reached yet
+};
+
+CfopTracker::CfopTracker()
+{
+    this->fixedCrossFace = FACE::NONE;
+    this->reset();
+}
+void CfopTracker::reset(FACE crossFace)
+{
+    this->step = CFOP_STEP::CROSS;
+    this->fixedCrossFace = crossFace;
+    this->crossFace = crossFace;
+    this->pairCount = 0;
+    this->ollCase = LL_UNKNOWN;
+    this->pllCase = LL_UNKNOWN;
+    for(uint8_t i = 0; i < (uint8_t)CFOP_STEP::DONE; i++) this->splits[i] = 0;
+}
+void CfopTracker::onMove(const CubeModel &cube, uint32_t elapsed)
+{
+    uint32_t mask = cube.getSolvedMask();
+    if(this->step == CFOP_STEP::CROSS)
+    {
+        if(this->fixedCrossFace != FACE::NONE)
+        {
+            if((mask & CROSS_MASK[(uint8_t)this->fixedCrossFace]) != CROSS_MASK[(uint8_t)this->fixedCrossFace]) return;
+        }
+        else
+        {
+            uint8_t f = 0;
+            while(f < 6 && (mask & CROSS_MASK[f]) != CROSS_MASK[f]) f++;
+            if(f == 6) return;
+            this->crossFace = (FACE)f;
+        }
+        this->_split(elapsed);
+    }
+    if(this->step >= CFOP_STEP::F2L_1 && this->step <= CFOP_STEP::F2L_4)
+    {
+        uint8_t f = (uint8_t)this->crossFace;
+        this->pairCount = 0;
+        if((mask & CROSS_MASK[f]) == CROSS_MASK[f])
+        {
+            for(uint8_t i = 0; i < 4; i++) if((mask & F2L_PAIR_MASK[f][i]) == F2L_PAIR_MASK[f][i]) this->pairCount++;
+        }
+        while(this->step <= CFOP_STEP::F2L_4 && (uint8_t)this->step - (uint8_t)CFOP_STEP::F2L_1 < this->pairCount) this->_split(elapsed);
+        if(this->step <= CFOP_STEP::F2L_4) return;
+        this->ollCase = recognizeOll(cube, OPPOSITE_FACE[(uint8_t)this->crossFace]);
+    }
+    if(this->step == CFOP_STEP::OLL)
+    {
+        if((mask & this->_f2lMask()) != this->_f2lMask() || !this->_isLastLayerOriented(cube)) return;
+        this->_split(elapsed);
+        this->pllCase = recognizePll(cube, OPPOSITE_FACE[(uint8_t)this->crossFace]);
+    }
+    if(this->step == CFOP_STEP::PLL)
+    {
+        if((mask & this->_f2lMask()) != this->_f2lMask() || !this->_isLastLayerOriented(cube) || !this->_isLastLayerPermuted(cube)) return;
+        this->_split(elapsed);
+    }
+}
+CFOP_STEP CfopTracker::getStep() const
+{
+    return this->step;
+}
+FACE CfopTracker::getCrossFace() const
+{
+    return this->crossFace;
+}
+uint8_t CfopTracker::getPairCount() const
+{
+    return this->pairCount;
+}
+uint8_t CfopTracker::getOllCase() const
+{
+    return this->ollCase;
+}
+uint8_t CfopTracker::getPllCase() const
+{
+    return this->pllCase;
+}
+uint32_t CfopTracker::getSplit(CFOP_STEP step) const
+{
+    if(step >= CFOP_STEP::DONE || step >= this->step) return 0;
+    return this->splits[(uint8_t)step];
+}
+uint32_t CfopTracker::_f2lMask() const
+{
+    const uint32_t *pairs = F2L_PAIR_MASK[(uint8_t)this->crossFace];
+    return CROSS_MASK[(uint8_t)this->crossFace] | pairs[0] | pairs[1] | pairs[2] | pairs[3];
+}
+bool CfopTracker::_isLastLayerOriented(const CubeModel &cube) const
+{
+    FACE top = OPPOSITE_FACE[(uint8_t)this->crossFace];
+    for(uint8_t i = 0; i < 4; i++)
+    {
+        if(cube.getCornerFacing((CORNER)FACE_CORNERS[(uint8_t)top][i], top) != top) return false;
+        if(cube.getEdgeFacing((EDGE)FACE_EDGES[(uint8_t)top][i], top) != top) return false;
+    }
+    return true;
+}
+// The last layer is solved up to AUF if every cubie sits the same number of quarter turns away from its home slot.
+bool CfopTracker::_isLastLayerPermuted(const CubeModel &cube) const
+{
+    uint8_t top = (uint8_t)OPPOSITE_FACE[(uint8_t)this->crossFace];
+    int8_t offset = -1;
+    for(uint8_t i = 0; i < 4; i++)
+    {
+        uint8_t corner = cube.getCorner((CORNER)FACE_CORNERS[top][i]).index;
+        uint8_t edge = cube.getEdge((EDGE)FACE_EDGES[top][i]).index;
+        for(uint8_t j = 0; j < 4; j++)
+        {
+            if(FACE_CORNERS[top][j] == corner)
+            {
+                if(offset < 0) offset = (j + 4 - i) % 4;
+                else if(offset != (j + 4 - i) % 4) return false;
+            }
+        }
+        if(offset < 0 || FACE_EDGES[top][(i + offset) % 4] != edge) return false;
+    }
+    return true;
+}
+void CfopTracker::_split(uint32_t elapsed)
+{
+    this->splits[(uint8_t)this->step] = elapsed;
+    this->step = (CFOP_STEP)((uint8_t)this->step + 1);
+}
+#endif
@@ -0,0 +1,250 @@
+/**
+ * @author Matrixchung
+ * @brief  Distance of the 8 corners to solved up to a whole-cube rotation (a 2x2x2 cube), 4 bits per state.
+ *
+ * L is R' followed by a whole-cube turn as far as the corners go, and so on, so the 18 moves reach nothing that
+ * U, R and F cannot reach up to a rotation. The cube is therefore turned (cubies keep their identity) until the
+ * DLB cubie, untouched by U, R and F, sits at home oriented, and the other 7 corners are indexed:
+ *  index = rank of the 7 cubies in slots ULB ULF URF URB DLF DRF DRB * 729 + twists of the first 6 in base 3
+ * 7! * 3^6 = 3,674,160 states (~1.8 MB) instead of 8! * 3^7 (~44 MB).
+ *
+ * With the centers fixed, a rotated solved cube is not solved (the corners after U D' count 0 here), so the value is a lower
+ * bound of the exact corner distance: never above it, equal for ~97% of the states within 7 moves, 8.756 on average
+ * against 8.764 for Korf's exact table. As a heuristic for IDA* it is nearly as good, at 1/24 of the memory.
+ *
+ * The ESP32 has too little RAM to build or hold the table, so tools/gen_corner_table.cpp writes it to a file that is
+ * flashed to the "cornerdb" partition of partitions.csv, and FlashCornerTable maps it into the address space.
+ * File: CORNER_TABLE_HEADER bytes ("CRNR", version, bits per entry, 0, 0, entries as uint32 LE, 0 x 4), then either
+ *  4 bits : the NibbleTable bytes (entry i in the low nibble of byte i / 2 when i is even), ~1.8 MB
+ *  2 bits : the distances mod 3 (packMod3()), ~0.9 MB. A lookup alone is not a bound any more: cornerTableDistance()
+ *           follows moves that lower the distance by one down to solved, at most 11 of them, 9 lookups each
+ * Files written before the bits byte have 0 there, and 4 bits per entry.
+ *
+ * **/
+#ifndef _CORNER_TABLE_HPP
+#define _CORNER_TABLE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include "CubeModel.hpp"
+#include "CubieCube.hpp"
+#include "TwoPhaseSolver.hpp"
+
+#define CORNER_TABLE_SIZE      3674160    // 7! * 3^6
+#define CORNER_TABLE_FIXED     4          // DLB
+#define CORNER_TABLE_VERSION   1
+#define CORNER_TABLE_HEADER    16         // bytes before the entries
+#define CORNER_TABLE_PARTITION "cornerdb" // label in partitions.csv
+#define CORNER_TABLE_SUBTYPE   0x40       // data subtype in partitions.csv
+
+const static uint8_t CORNER_TABLE_SLOTS[7] = {0, 1, 2, 3, 5, 6, 7};
+const static MOVE CORNER_TABLE_MOVES[9] = {MOVE::U, MOVE::U2, MOVE::U_, MOVE::F, MOVE::F2, MOVE::F_, MOVE::R, MOVE::R2, MOVE::R_};
+
+// The rotation bringing the DLB cubie home oriented, by its slot and twist.
+struct CornerNormalizer
+{
+    uint8_t rotation[8][3];
+    CornerNormalizer();
+};
+CornerNormalizer::CornerNormalizer()
+{
+    for(uint8_t r = 0; r < ROTATION_COUNT; r++)
+    {
+        for(uint8_t s = 0; s < 8; s++)
+        {
+            if(ROTATION_CORNER[r][s] != CORNER_TABLE_FIXED) continue;
+            this->rotation[s][(3 - ROTATION_CORNER_TWIST[r][s]) % 3] = r;
+        }
+    }
+}
+const static CornerNormalizer CORNER_NORMALIZER;
+
+uint32_t cornerTableIndex(const CubieCube &cube);
+void cornerTableState(uint32_t index, CubieCube &cube); // corners only, DLB at home
+void buildCornerTable(NibbleTable &table); // ~3 s on a desktop
+void cornerTableHeader(uint8_t *header, uint8_t bits = 4);
+uint8_t cornerTableBits(const uint8_t *header); // 4 or 2, 0 if it is not a header of this table
+uint8_t cornerTableDistance(const uint8_t *mod3, const CubieCube &cube); // exact, from the distances mod 3
+
+#ifdef ESP_PLATFORM
+#include "esp_partition.h"
+#include "esp_spi_flash.h"
+
+// The table in the flash partition, read through the cache: one lookup is one flash read at worst.
+class FlashCornerTable
+{
+    private:
+        const uint8_t *data;
+        uint8_t bits;
+        spi_flash_mmap_handle_t handle;
+    public:
+        FlashCornerTable();
+        ~FlashCornerTable();
+        bool begin(); // false if the partition is missing or was not flashed with the table
+        void end();
+        bool isReady() const;
+        uint8_t get(uint32_t index) const; // the entry as stored, a distance or a distance mod 3
+        uint8_t bound(const CubieCube &cube) const; // lower bound of moves to solved, 0 if not ready
+};
+#endif
+
+uint32_t cornerTableIndex(const CubieCube &cube)
+{
+    uint8_t slot = 0;
+    while(cube.cp[slot] != CORNER_TABLE_FIXED) slot++;
+    uint8_t r = CORNER_NORMALIZER.rotation[slot][cube.co[slot]];
+    uint8_t cp[8], co[8];
+    for(uint8_t s = 0; s < 8; s++)
+    {
+        cp[ROTATION_CORNER[r][s]] = cube.cp[s];
+        co[ROTATION_CORNER[r][s]] = (cube.co[s] + ROTATION_CORNER_TWIST[r][s]) % 3;
+    }
+    uint8_t perm[7];
+    uint16_t twist = 0;
+    for(uint8_t i = 0; i < 7; i++)
+    {
+        uint8_t s = CORNER_TABLE_SLOTS[i];
+        perm[i] = cp[s] < CORNER_TABLE_FIXED ? cp[s] : cp[s] - 1;
+        if(i < 6) twist = twist * 3 + co[s];
+    }
+    return (uint32_t)CubieCube::permRank(perm, 7) * 729 + twist;
+}
+void cornerTableState(uint32_t index, CubieCube &cube)
+{
+    uint8_t perm[7];
+    CubieCube::permUnrank(index / 729, perm, 7);
+    uint16_t twist = index % 729;
+    uint8_t sum = 0;
+    for(int8_t i = 6; i >= 0; i--)
+    {
+        uint8_t s = CORNER_TABLE_SLOTS[i];
+        cube.cp[s] = perm[i] < CORNER_TABLE_FIXED ? perm[i] : perm[i] + 1;
+        if(i < 6)
+        {
+            cube.co[s] = twist % 3;
+            twist /= 3;
+            sum += cube.co[s];
+        }
+    }
+    cube.co[CORNER_TABLE_SLOTS[6]] = (3 - sum % 3) % 3;
+    cube.cp[CORNER_TABLE_FIXED] = CORNER_TABLE_FIXED;
+    cube.co[CORNER_TABLE_FIXED] = 0;
+}
+// Breadth-first search with U, R and F, which keep DLB home, one depth at a time like TwoPhaseTables::_build().
+void buildCornerTable(NibbleTable &table)
+{
+    table.resize(CORNER_TABLE_SIZE);
+    table.set(cornerTableIndex(CubieCube()), 0);
+    bool found = true;
+    for(uint8_t depth = 0; found && depth < 14; depth++)
+    {
+        found = false;
+        for(uint32_t index = 0; index < CORNER_TABLE_SIZE; index++)
+        {
+            if(table.get(index) != depth) continue;
+            CubieCube cube;
+            cornerTableState(index, cube);
+            for(uint8_t m = 0; m < 9; m++)
+            {
+                CubieCube next = cube;
+                next.applyMove(CORNER_TABLE_MOVES[m]);
+                uint32_t nextIndex = cornerTableIndex(next);
+                if(table.get(nextIndex) == 0xF)
+                {
+                    table.set(nextIndex, depth + 1);
+                    found = true;
+                }
+            }
+        }
+    }
+}
+void cornerTableHeader(uint8_t *header, uint8_t bits)
+{
+    memset(header, 0, CORNER_TABLE_HEADER);
+    memcpy(header, "CRNR", 4);
+    header[4] = CORNER_TABLE_VERSION;
+    header[5] = bits;
+    for(uint8_t i = 0; i < 4; i++) header[8 + i] = (uint32_t)CORNER_TABLE_SIZE >> (i * 8);
+}
+uint8_t cornerTableBits(const uint8_t *header)
+{
+    uint8_t bits = header[5] ? header[5] : 4;
+    if(bits != 4 && bits != 2) return 0;
+    uint8_t expected[CORNER_TABLE_HEADER];
+    cornerTableHeader(expected, header[5]);
+    return memcmp(header, expected, CORNER_TABLE_HEADER) == 0 ? bits : 0;
+}
+// A neighbor is one move closer, as far, or one move farther, and only a closer one has the distance - 1 mod 3.
+uint8_t cornerTableDistance(const uint8_t *mod3, const CubieCube &cube)
+{
+    const uint32_t solved = cornerTableIndex(CubieCube());
+    CubieCube current = cube;
+    uint32_t index = cornerTableIndex(current);
+    uint8_t distance = 0;
+    while(index != solved && distance < 14)
+    {
+        uint8_t closer = (mod3Get(mod3, index) + 2) % 3;
+        for(uint8_t m = 0; m < 9; m++)
+        {
+            CubieCube next = current;
+            next.applyMove(CORNER_TABLE_MOVES[m]);
+            uint32_t nextIndex = cornerTableIndex(next);
+            if(mod3Get(mod3, nextIndex) != closer) continue;
+            current = next;
+            index = nextIndex;
+            break;
+        }
+        distance++;
+    }
+    return distance;
+}
+
+#ifdef ESP_PLATFORM
+FlashCornerTable::FlashCornerTable()
+{
+    this->data = nullptr;
+    this->bits = 0;
+    this->handle = 0;
+}
+FlashCornerTable::~FlashCornerTable()
+{
+    this->end();
+}
+bool FlashCornerTable::begin()
+{
+    if(this->data) return true;
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)CORNER_TABLE_SUBTYPE, CORNER_TABLE_PARTITION);
+    uint8_t header[CORNER_TABLE_HEADER];
+    if(!partition || esp_partition_read(partition, 0, header, sizeof(header)) != ESP_OK) return false;
+    uint8_t bits = cornerTableBits(header);
+    size_t size = CORNER_TABLE_HEADER + (bits == 2 ? MOD3_BYTES(CORNER_TABLE_SIZE) : (CORNER_TABLE_SIZE + 1) / 2);
+    if(!bits || partition->size < size) return false;
+    const void *mapped;
+    if(esp_partition_mmap(partition, 0, size, SPI_FLASH_MMAP_DATA, &mapped, &this->handle) != ESP_OK) return false;
+    this->data = (const uint8_t *)mapped + CORNER_TABLE_HEADER;
+    this->bits = bits;
+    return true;
+}
+void FlashCornerTable::end()
+{
+    if(!this->data) return;
+    spi_flash_munmap(this->handle);
+    this->data = nullptr;
+}
+bool FlashCornerTable::isReady() const
+{
+    return this->data != nullptr;
+}
+uint8_t FlashCornerTable::get(uint32_t index) const
+{
+    if(this->bits == 2) return mod3Get(this->data, index);
+    return (this->data[index >> 1] >> ((index & 1) << 2)) & 0xF;
+}
+uint8_t FlashCornerTable::bound(const CubieCube &cube) const
+{
+    if(!this->data) return 0;
+    if(this->bits == 2) return cornerTableDistance(this->data, cube);
+    return this->get(cornerTableIndex(cube));
+}
+#endif
+#endif
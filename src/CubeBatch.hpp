@@ -0,0 +1,371 @@
+/**
+ * @author Matrixchung
+ * @brief  CubeBatch holds many cubes as structure of arrays, for predicates and coordinates over thousands of states.
+ *
+ * Each slot has a row of cubies and a row of orientations (as CubieCube's cp / co / ep / eo), one byte per state,
+ * padded to a multiple of CUBE_BATCH_LANES. Rows are reached through slot -> row tables:
+ *  - applyMove() turns every state. The permutation only relabels the tables, and the twists / flips are added to
+ *    the rows of the slots that get them, so U and D cost nothing and F / B touch 8 rows.
+ *  - piecesSolved(), isSolved() and equals() compare whole rows and AND the results per state
+ *  - getTwist() / getFlip() build the coordinates of CubieCube.hpp for 16 states at once
+ * With AVX2 (checked at runtime on x86) these take 32 states per instruction, otherwise the same loops run one state
+ * at a time. tools/batch_bench.cpp compares them with loops over CubeModel and CubieCube.
+ *
+ * **/
+#ifndef _CUBE_BATCH_HPP
+#define _CUBE_BATCH_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+using std::vector;
+#include "CubeModel.hpp"
+#include "CubieCube.hpp"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CUBE_BATCH_AVX2
+#endif
+
+#define CUBE_BATCH_LANES 32 // states per AVX2 register
+#define CUBE_BATCH_ROWS  40 // corner cubies, twists, edge cubies, flips
+
+class CubeBatch
+{
+    private:
+        vector<uint8_t> data; // row r at data[r * stride]
+        size_t count, stride;
+        uint8_t cornerRow[8], edgeRow[12]; // cubies of slot s in row cornerRow[s], twists in row cornerRow[s] + 8
+        bool avx2;
+        uint8_t *_row(uint8_t row);
+        const uint8_t *_row(uint8_t row) const;
+        uint8_t _solvedState(size_t i, uint32_t pieces) const;
+        #ifdef CUBE_BATCH_AVX2
+        size_t _piecesSolvedAvx2(uint32_t pieces, uint8_t *out, size_t &solved) const;
+        size_t _equalsAvx2(const CubeBatch &other, uint8_t *out, size_t &equal) const;
+        size_t _twistAvx2(uint16_t *out) const;
+        size_t _flipAvx2(uint16_t *out) const;
+        void _twistRowAvx2(uint8_t row, uint8_t twist);
+        void _flipRowAvx2(uint8_t row);
+        #endif
+    public:
+        CubeBatch(size_t count = 0);
+        void resize(size_t count); // new states are solved
+        size_t size() const;
+        void set(size_t i, const CubieCube &cube);
+        void set(size_t i, const CubeModel &cube);
+        CubieCube getCubie(size_t i) const;
+        CubeModel get(size_t i) const;
+        void applyMove(MOVE move); // to every state
+        // out[i] = 1 if the pieces (bits of CubeModel::getSolvedMask(), e.g. CROSS_MASK) of state i are home, returns how many
+        size_t piecesSolved(uint32_t pieces, uint8_t *out) const;
+        size_t isSolved(uint8_t *out) const;
+        size_t equals(const CubeBatch &other, uint8_t *out) const; // state by state, the batches have the same size
+        void getTwist(uint16_t *out) const;
+        void getFlip(uint16_t *out) const;
+};
+
+CubeBatch::CubeBatch(size_t count)
+{
+    this->count = 0;
+    this->stride = 0;
+    for(uint8_t s = 0; s < 8; s++) this->cornerRow[s] = s;
+    for(uint8_t s = 0; s < 12; s++) this->edgeRow[s] = 16 + s;
+    #ifdef CUBE_BATCH_AVX2
+    this->avx2 = __builtin_cpu_supports("avx2");
+    #else
+    this->avx2 = false;
+    #endif
+    this->resize(count);
+}
+void CubeBatch::resize(size_t count)
+{
+    size_t stride = (count + CUBE_BATCH_LANES - 1) / CUBE_BATCH_LANES * CUBE_BATCH_LANES;
+    vector<uint8_t> data(CUBE_BATCH_ROWS * stride, 0);
+    for(uint8_t s = 0; s < 8; s++) memset(&data[this->cornerRow[s] * stride], s, stride);
+    for(uint8_t s = 0; s < 12; s++) memset(&data[this->edgeRow[s] * stride], s, stride);
+    size_t kept = count < this->count ? count : this->count;
+    for(uint8_t r = 0; r < CUBE_BATCH_ROWS && kept; r++) memcpy(&data[r * stride], this->_row(r), kept);
+    this->data.swap(data);
+    this->count = count;
+    this->stride = stride;
+}
+size_t CubeBatch::size() const
+{
+    return this->count;
+}
+uint8_t *CubeBatch::_row(uint8_t row)
+{
+    return this->data.data() + row * this->stride;
+}
+const uint8_t *CubeBatch::_row(uint8_t row) const
+{
+    return this->data.data() + row * this->stride;
+}
+void CubeBatch::set(size_t i, const CubieCube &cube)
+{
+    for(uint8_t s = 0; s < 8; s++)
+    {
+        this->_row(this->cornerRow[s])[i] = cube.cp[s];
+        this->_row(this->cornerRow[s] + 8)[i] = cube.co[s];
+    }
+    for(uint8_t s = 0; s < 12; s++)
+    {
+        this->_row(this->edgeRow[s])[i] = cube.ep[s];
+        this->_row(this->edgeRow[s] + 12)[i] = cube.eo[s];
+    }
+}
+void CubeBatch::set(size_t i, const CubeModel &cube)
+{
+    this->set(i, CubieCube(cube));
+}
+CubieCube CubeBatch::getCubie(size_t i) const
+{
+    CubieCube cube;
+    for(uint8_t s = 0; s < 8; s++)
+    {
+        cube.cp[s] = this->_row(this->cornerRow[s])[i];
+        cube.co[s] = this->_row(this->cornerRow[s] + 8)[i];
+    }
+    for(uint8_t s = 0; s < 12; s++)
+    {
+        cube.ep[s] = this->_row(this->edgeRow[s])[i];
+        cube.eo[s] = this->_row(this->edgeRow[s] + 12)[i];
+    }
+    return cube;
+}
+CubeModel CubeBatch::get(size_t i) const
+{
+    return this->getCubie(i).toCubeModel();
+}
+// The move as a cube: slot s takes the cubie of slot cp[s], twisted by co[s], as in CubieCube::applyMove().
+void CubeBatch::applyMove(MOVE move)
+{
+    if(move >= MOVE::NONE) return;
+    CubieCube turn;
+    turn.applyMove(move);
+    uint8_t corners[8], edges[12];
+    for(uint8_t s = 0; s < 8; s++) corners[s] = this->cornerRow[turn.cp[s]];
+    for(uint8_t s = 0; s < 12; s++) edges[s] = this->edgeRow[turn.ep[s]];
+    memcpy(this->cornerRow, corners, sizeof(corners));
+    memcpy(this->edgeRow, edges, sizeof(edges));
+    for(uint8_t s = 0; s < 8; s++)
+    {
+        if(!turn.co[s]) continue;
+        uint8_t row = this->cornerRow[s] + 8;
+        #ifdef CUBE_BATCH_AVX2
+        if(this->avx2)
+        {
+            this->_twistRowAvx2(row, turn.co[s]);
+            continue;
+        }
+        #endif
+        uint8_t *twists = this->_row(row);
+        for(size_t i = 0; i < this->count; i++) twists[i] = (twists[i] + turn.co[s]) % 3;
+    }
+    for(uint8_t s = 0; s < 12; s++)
+    {
+        if(!turn.eo[s]) continue;
+        uint8_t row = this->edgeRow[s] + 12;
+        #ifdef CUBE_BATCH_AVX2
+        if(this->avx2)
+        {
+            this->_flipRowAvx2(row);
+            continue;
+        }
+        #endif
+        uint8_t *flips = this->_row(row);
+        for(size_t i = 0; i < this->count; i++) flips[i] ^= 1;
+    }
+}
+uint8_t CubeBatch::_solvedState(size_t i, uint32_t pieces) const
+{
+    for(uint8_t s = 0; s < 12; s++)
+    {
+        if(!(pieces >> s & 1)) continue;
+        if(this->_row(this->edgeRow[s])[i] != s || this->_row(this->edgeRow[s] + 12)[i]) return 0;
+    }
+    for(uint8_t s = 0; s < 8; s++)
+    {
+        if(!(pieces >> (12 + s) & 1)) continue;
+        if(this->_row(this->cornerRow[s])[i] != s || this->_row(this->cornerRow[s] + 8)[i]) return 0;
+    }
+    return 1;
+}
+size_t CubeBatch::piecesSolved(uint32_t pieces, uint8_t *out) const
+{
+    size_t from = 0, solved = 0;
+    #ifdef CUBE_BATCH_AVX2
+    if(this->avx2) from = this->_piecesSolvedAvx2(pieces, out, solved);
+    #endif
+    for(size_t i = from; i < this->count; i++) solved += out[i] = this->_solvedState(i, pieces);
+    return solved;
+}
+size_t CubeBatch::isSolved(uint8_t *out) const
+{
+    return this->piecesSolved(0xFFFFF, out);
+}
+size_t CubeBatch::equals(const CubeBatch &other, uint8_t *out) const
+{
+    size_t from = 0, equal = 0;
+    #ifdef CUBE_BATCH_AVX2
+    if(this->avx2) from = this->_equalsAvx2(other, out, equal);
+    #endif
+    for(size_t i = from; i < this->count; i++)
+    {
+        bool same = true;
+        for(uint8_t s = 0; s < 8 && same; s++)
+        {
+            same = this->_row(this->cornerRow[s])[i] == other._row(other.cornerRow[s])[i] && this->_row(this->cornerRow[s] + 8)[i] == other._row(other.cornerRow[s] + 8)[i];
+        }
+        for(uint8_t s = 0; s < 12 && same; s++)
+        {
+            same = this->_row(this->edgeRow[s])[i] == other._row(other.edgeRow[s])[i] && this->_row(this->edgeRow[s] + 12)[i] == other._row(other.edgeRow[s] + 12)[i];
+        }
+        equal += out[i] = same;
+    }
+    return equal;
+}
+void CubeBatch::getTwist(uint16_t *out) const
+{
+    size_t from = 0;
+    #ifdef CUBE_BATCH_AVX2
+    if(this->avx2) from = this->_twistAvx2(out);
+    #endif
+    for(size_t i = from; i < this->count; i++)
+    {
+        uint16_t twist = 0;
+        for(uint8_t s = 0; s < 7; s++) twist = twist * 3 + this->_row(this->cornerRow[s] + 8)[i];
+        out[i] = twist;
+    }
+}
+void CubeBatch::getFlip(uint16_t *out) const
+{
+    size_t from = 0;
+    #ifdef CUBE_BATCH_AVX2
+    if(this->avx2) from = this->_flipAvx2(out);
+    #endif
+    for(size_t i = from; i < this->count; i++)
+    {
+        uint16_t flip = 0;
+        for(uint8_t s = 0; s < 11; s++) flip = flip << 1 | this->_row(this->edgeRow[s] + 12)[i];
+        out[i] = flip;
+    }
+}
+
+#ifdef CUBE_BATCH_AVX2
+// The padding is part of the rows, so whole registers are read and turned; only whole registers of states are written out.
+__attribute__((target("avx2"))) void CubeBatch::_twistRowAvx2(uint8_t row, uint8_t twist)
+{
+    const __m256i three = _mm256_set1_epi8(3);
+    const __m256i add = _mm256_set1_epi8(twist);
+    uint8_t *twists = this->_row(row);
+    for(size_t i = 0; i < this->stride; i += CUBE_BATCH_LANES)
+    {
+        __m256i t = _mm256_add_epi8(_mm256_loadu_si256((const __m256i *)(twists + i)), add);
+        // t - 3 where t >= 3: the unsigned min is t - 3 exactly then, as t - 3 wraps above 3 otherwise
+        t = _mm256_min_epu8(t, _mm256_sub_epi8(t, three));
+        _mm256_storeu_si256((__m256i *)(twists + i), t);
+    }
+}
+__attribute__((target("avx2"))) void CubeBatch::_flipRowAvx2(uint8_t row)
+{
+    const __m256i one = _mm256_set1_epi8(1);
+    uint8_t *flips = this->_row(row);
+    for(size_t i = 0; i < this->stride; i += CUBE_BATCH_LANES)
+    {
+        _mm256_storeu_si256((__m256i *)(flips + i), _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(flips + i)), one));
+    }
+}
+__attribute__((target("avx2"))) size_t CubeBatch::_piecesSolvedAvx2(uint32_t pieces, uint8_t *out, size_t &solved) const
+{
+    const __m256i zero = _mm256_setzero_si256(), one = _mm256_set1_epi8(1);
+    size_t i = 0;
+    for(; i + CUBE_BATCH_LANES <= this->count; i += CUBE_BATCH_LANES)
+    {
+        __m256i home = _mm256_set1_epi8(-1);
+        for(uint8_t s = 0; s < 12; s++)
+        {
+            if(!(pieces >> s & 1)) continue;
+            __m256i cubies = _mm256_loadu_si256((const __m256i *)(this->_row(this->edgeRow[s]) + i));
+            __m256i flips = _mm256_loadu_si256((const __m256i *)(this->_row(this->edgeRow[s] + 12) + i));
+            home = _mm256_and_si256(home, _mm256_cmpeq_epi8(_mm256_or_si256(_mm256_xor_si256(cubies, _mm256_set1_epi8(s)), flips), zero));
+        }
+        for(uint8_t s = 0; s < 8; s++)
+        {
+            if(!(pieces >> (12 + s) & 1)) continue;
+            __m256i cubies = _mm256_loadu_si256((const __m256i *)(this->_row(this->cornerRow[s]) + i));
+            __m256i twists = _mm256_loadu_si256((const __m256i *)(this->_row(this->cornerRow[s] + 8) + i));
+            home = _mm256_and_si256(home, _mm256_cmpeq_epi8(_mm256_or_si256(_mm256_xor_si256(cubies, _mm256_set1_epi8(s)), twists), zero));
+        }
+        _mm256_storeu_si256((__m256i *)(out + i), _mm256_and_si256(home, one));
+        solved += __builtin_popcount(_mm256_movemask_epi8(home));
+    }
+    return i;
+}
+__attribute__((target("avx2"))) size_t CubeBatch::_equalsAvx2(const CubeBatch &other, uint8_t *out, size_t &equal) const
+{
+    const __m256i zero = _mm256_setzero_si256(), one = _mm256_set1_epi8(1);
+    uint8_t rows[CUBE_BATCH_ROWS], otherRows[CUBE_BATCH_ROWS];
+    for(uint8_t s = 0; s < 8; s++)
+    {
+        rows[s] = this->cornerRow[s];
+        rows[s + 8] = this->cornerRow[s] + 8;
+        otherRows[s] = other.cornerRow[s];
+        otherRows[s + 8] = other.cornerRow[s] + 8;
+    }
+    for(uint8_t s = 0; s < 12; s++)
+    {
+        rows[16 + s] = this->edgeRow[s];
+        rows[28 + s] = this->edgeRow[s] + 12;
+        otherRows[16 + s] = other.edgeRow[s];
+        otherRows[28 + s] = other.edgeRow[s] + 12;
+    }
+    size_t i = 0;
+    for(; i + CUBE_BATCH_LANES <= this->count; i += CUBE_BATCH_LANES)
+    {
+        __m256i differ = zero;
+        for(uint8_t r = 0; r < CUBE_BATCH_ROWS; r++)
+        {
+            __m256i a = _mm256_loadu_si256((const __m256i *)(this->_row(rows[r]) + i));
+            __m256i b = _mm256_loadu_si256((const __m256i *)(other._row(otherRows[r]) + i));
+            differ = _mm256_or_si256(differ, _mm256_xor_si256(a, b));
+        }
+        __m256i same = _mm256_cmpeq_epi8(differ, zero);
+        _mm256_storeu_si256((__m256i *)(out + i), _mm256_and_si256(same, one));
+        equal += __builtin_popcount(_mm256_movemask_epi8(same));
+    }
+    return i;
+}
+__attribute__((target("avx2"))) size_t CubeBatch::_twistAvx2(uint16_t *out) const
+{
+    const __m256i three = _mm256_set1_epi16(3);
+    size_t i = 0;
+    for(; i + CUBE_BATCH_LANES / 2 <= this->count; i += CUBE_BATCH_LANES / 2)
+    {
+        __m256i twist = _mm256_setzero_si256();
+        for(uint8_t s = 0; s < 7; s++)
+        {
+            __m256i co = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(this->_row(this->cornerRow[s] + 8) + i)));
+            twist = _mm256_add_epi16(_mm256_mullo_epi16(twist, three), co);
+        }
+        _mm256_storeu_si256((__m256i *)(out + i), twist);
+    }
+    return i;
+}
+__attribute__((target("avx2"))) size_t CubeBatch::_flipAvx2(uint16_t *out) const
+{
+    size_t i = 0;
+    for(; i + CUBE_BATCH_LANES / 2 <= this->count; i += CUBE_BATCH_LANES / 2)
+    {
+        __m256i flip = _mm256_setzero_si256();
+        for(uint8_t s = 0; s < 11; s++)
+        {
+            __m256i eo = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(this->_row(this->edgeRow[s] + 12) + i)));
+            flip = _mm256_or_si256(_mm256_slli_epi16(flip, 1), eo);
+        }
+        _mm256_storeu_si256((__m256i *)(out + i), flip);
+    }
+    return i;
+}
+#endif
+#endif
@@ -33,11 +33,12 @@
  * data[20] - data[23] means front and back faces' edge, start from BL, counter-clockwise. (BL-FL-FR-BR) (5-6-7-8)
  * data[24] - data[27] means bottom face's edge, start from DB, counter-clockwise. (DB-DL-DF-DR) (9-A-B-C)
  * 
- * data[28] - data[30]: 
- * BACK Face(YELLOW) roll +- 90 degree: 8 9 8
- * FRONT Face(WHITE) roll +- 90 degree: 2 6 2
- * Both: A F A (10 15 10)
- * A edge piece can be in two states, oriented or flipped.
+ * data[28] - data[30]: FLIPPED EDGES
+ * A 12 bit mask, most significant bit first, one bit per edge slot in the order above (UB = 0x800 ... DR = 0x001).
+ * An edge piece can be in two states, oriented or flipped. From solved:
+ * BACK Face(YELLOW) roll +- 90 degree: 8 9 8 (UB, BL, BR, DB)
+ * FRONT Face(WHITE) roll +- 90 degree: 2 6 2 (UF, FL, FR, DF)
+ * Both: A F A (10 15 10), and any other set of edges after longer sequences, e.g. F R: 3 4 2
  * 
  * data[31] = 0
  * 
@@ -59,6 +60,20 @@
  * UB UL UF UR BL FL FR BR DB DL DF DR
  * GY GR GW GO RY RW OW OY BY BR BW BO
  * 
+ * ** MOVES **
+ * Moves are coded as FACE * 3 + turn, with turn 0 - Clockwise, 1 - Half turn, 2 - Counter-clockwise (seen from the face).
+ * A corner's twist is counted from its U/D sticker, an edge's flip from its U/D sticker (or F/B sticker in the middle layer),
+ * so U, D, L, R never flip edges and U, D never twist corners. F and B flip exactly the edge groups reported in data[28] - data[30].
+ * 
+ * ** COLOR SCHEMES **
+ * CubeModelT<Scheme> takes the center colors and the protocol's face numbering from a scheme descriptor
+ * (XiaomiScheme, JapaneseScheme, or your own for a restickered cube). CubeModel is CubeModelT<XiaomiScheme>.
+ * 
+ * ** ROTATIONS **
+ * The protocol always reports green up and white front. rotated() describes the same cube as held in any of the 24
+ * orientations (RotationTables.hpp), and rotateMove() maps the reported moves likewise, one lookup per move.
+ * Colors follow the centers, so a rotated model still reports the cube's real colors.
+ * 
  * Solved cube cubeData example:
  * 1 2 3 4 5 6 7 8
  * 3 3 3 3 3 3 3 3
@@ -77,6 +92,7 @@ using std::array;
 using std::swap;
 #include <string>
 using std::string;
+#include "RotationTables.hpp"
 
 enum class FACE   : uint8_t {UP, LEFT, FRONT, RIGHT, BACK, DOWN, NONE};
 enum class COLOR  : uint8_t {BLUE = 0, YELLOW = 1, ORANGE = 2, WHITE = 3, RED = 4, GREEN = 5};
@@ -84,9 +100,52 @@ enum class COLOR  : uint8_t {BLUE = 0, YELLOW = 1, ORANGE = 2, WHITE = 3, RED =
 enum class EDGE   : uint8_t {UB, UL, UF, UR, BL, FL, FR, _BR, DB, DL, DF, DR};
 enum class CORNER : uint8_t {ULB, ULF, URF, URB, DLB, DLF, DRF, DRB};
 enum class DIR    : uint8_t {ORIENTED = 3, FLIPPED = 4, ROTATED = 2, ROTATED_TWICE = 1};
+enum class MOVE   : uint8_t {U, U2, U_, L, L2, L_, F, F2, F_, R, R2, R_, B, B2, B_, D, D2, D_, NONE};
+
+// Slots cycled by a clockwise quarter turn of each face: new[cycle[i]] = old[cycle[i+1]], twisted/flipped by the delta of the target slot.
+// Both cycles go counter-clockwise seen from the face, and FACE_EDGES[f][i] always lies between FACE_CORNERS[f][i-1] and FACE_CORNERS[f][i].
+const static uint8_t FACE_CORNERS[6][4] = {{0, 1, 2, 3}, {0, 4, 5, 1}, {1, 5, 6, 2}, {2, 6, 7, 3}, {0, 3, 7, 4}, {4, 7, 6, 5}};
+const static uint8_t FACE_CORNER_TWIST[6][4] = {{0, 0, 0, 0}, {2, 1, 2, 1}, {2, 1, 2, 1}, {2, 1, 2, 1}, {1, 2, 1, 2}, {0, 0, 0, 0}};
+const static uint8_t FACE_EDGES[6][4] = {{0, 1, 2, 3}, {1, 4, 9, 5}, {2, 5, 10, 6}, {3, 6, 11, 7}, {4, 0, 7, 8}, {9, 8, 11, 10}};
+const static uint8_t FACE_EDGE_FLIP[6] = {0, 0, 1, 0, 1, 0};
+// Faces of each slot's stickers, starting from the U/D (or F/B) sticker, corners going clockwise.
+// A cubie with twist t shows its own sticker (k - t) % 3 at the slot's sticker k, an edge with flip f shows (k + f) % 2.
+const static FACE CORNER_FACES[8][3] = {{FACE::UP, FACE::LEFT, FACE::BACK}, {FACE::UP, FACE::FRONT, FACE::LEFT}, {FACE::UP, FACE::RIGHT, FACE::FRONT}, {FACE::UP, FACE::BACK, FACE::RIGHT},
+                                        {FACE::DOWN, FACE::BACK, FACE::LEFT}, {FACE::DOWN, FACE::LEFT, FACE::FRONT}, {FACE::DOWN, FACE::FRONT, FACE::RIGHT}, {FACE::DOWN, FACE::RIGHT, FACE::BACK}};
+const static FACE EDGE_FACES[12][2] = {{FACE::UP, FACE::BACK}, {FACE::UP, FACE::LEFT}, {FACE::UP, FACE::FRONT}, {FACE::UP, FACE::RIGHT},
+                                       {FACE::BACK, FACE::LEFT}, {FACE::FRONT, FACE::LEFT}, {FACE::FRONT, FACE::RIGHT}, {FACE::BACK, FACE::RIGHT},
+                                       {FACE::DOWN, FACE::BACK}, {FACE::DOWN, FACE::LEFT}, {FACE::DOWN, FACE::FRONT}, {FACE::DOWN, FACE::RIGHT}};
+const static FACE OPPOSITE_FACE[6] = {FACE::DOWN, FACE::RIGHT, FACE::BACK, FACE::LEFT, FACE::FRONT, FACE::UP};
+// solvedMask bits: edges 0 - 11, corners 12 - 19
+#define SOLVED_MASK_ALL 0xFFFFFu
+
+// Color scheme descriptors: the center color of each face (FACE order) and the protocol's face numbering.
+// Every color of a CubeModelT comes from Scheme::CENTERS, so a scheme costs nothing at runtime.
+struct XiaomiScheme
+{
+    constexpr static COLOR CENTERS[6] = {COLOR::GREEN, COLOR::RED, COLOR::WHITE, COLOR::ORANGE, COLOR::YELLOW, COLOR::BLUE};
+    // Protocol face index (data[32], data[34]) to FACE: 1 - Blue(D), 2 - Yellow(B), 3 - Orange(R), 4 - White(F), 5 - Red(L), 6 - Green(U)
+    constexpr static FACE PROTOCOL_FACE[7] = {FACE::NONE, FACE::DOWN, FACE::BACK, FACE::RIGHT, FACE::FRONT, FACE::LEFT, FACE::UP};
+};
+constexpr COLOR XiaomiScheme::CENTERS[6];
+constexpr FACE XiaomiScheme::PROTOCOL_FACE[7];
+// The same cube restickered in the Japanese scheme: blue opposite white, yellow opposite green.
+struct JapaneseScheme : XiaomiScheme
+{
+    constexpr static COLOR CENTERS[6] = {COLOR::GREEN, COLOR::RED, COLOR::WHITE, COLOR::ORANGE, COLOR::BLUE, COLOR::YELLOW};
+};
+constexpr COLOR JapaneseScheme::CENTERS[6];
+
+template<class Scheme>
+constexpr bool uniqueCenters(uint8_t i = 0, uint8_t j = 1)
+{
+    return i >= 6 ? true : (j >= 6 ? uniqueCenters<Scheme>(i + 1, i + 2) : Scheme::CENTERS[i] != Scheme::CENTERS[j] && uniqueCenters<Scheme>(i, j + 1));
+}
 
-class CubeModel
+template<class Scheme>
+class CubeModelT
 {
+    static_assert(uniqueCenters<Scheme>(), "a color scheme needs six different center colors");
     public:
         struct Cubie
         {
@@ -98,27 +157,52 @@ class CubeModel
         array<Cubie, 12> edges;
         array<Cubie, 8>  corners;
         array<COLOR, 6>  centers;
+        uint32_t solvedMask; // bit set if the cubie in that slot is at home and oriented
         bool _checkValid();
+        void _updateSolvedMask(uint8_t face);
     public:
-        CubeModel();
-        // CubeModel(const CubeModel& cube);
-        bool operator==(const CubeModel &other) const;
-        bool operator!=(const CubeModel &other) const;
+        static uint8_t cornerTwist(DIR orientation) { return (3 - (uint8_t)orientation) % 3; } // 0 - 2 clockwise twists
+        static uint8_t edgeFlip(DIR orientation) { return orientation == DIR::FLIPPED ? 1 : 0; }
+        CubeModelT();
+        CubeModelT(const array<Cubie, 8> &corners, const array<Cubie, 12> &edges, const array<COLOR, 6> &centers);
+        // CubeModelT(const CubeModelT& cube);
+        bool operator==(const CubeModelT &other) const;
+        bool operator!=(const CubeModelT &other) const;
         bool isSolved() const;
+        uint32_t getSolvedMask() const;
+        uint32_t hash() const; // FNV-1a of the cubies, identifies a scramble
+        void applyMove(MOVE move);
+        Cubie getEdge(EDGE edge) const;
+        Cubie getCorner(CORNER corner) const;
+        FACE getCornerFacing(CORNER corner, FACE face) const; // home face of the sticker that the cubie in this slot shows on face
+        FACE getEdgeFacing(EDGE edge, FACE face) const;
         array<COLOR, 2> getEdgeColors(EDGE edge) const;
         array<COLOR, 3> getCornerColors(CORNER corner) const;
         array<array<COLOR, 3>, 3> getFaceColors(FACE face) const;
         COLOR getColor(FACE face, uint8_t row, uint8_t col) const;
+        CubeModelT rotated(uint8_t rotation) const; // the same cube seen in another orientation, see RotationTables.hpp
 
         // ** SPECIAL FOR XIAOMI CUBE **
-        CubeModel(const uint8_t *data); // 36 bytes cubeData
+        CubeModelT(const uint8_t *data); // 36 bytes cubeData
         FACE lastTurnedFace;
         uint8_t lastTurnedDir; // 0 - Clockwise, 1 - Counter-clockwise
         FACE turnedFace;
         uint8_t turnedDir;
+        MOVE turnedMove() const;
 };
+typedef CubeModelT<XiaomiScheme> CubeModel;
 
-CubeModel::CubeModel()
+string moveToString(MOVE move);
+MOVE invertMove(MOVE move);
+uint8_t moveQuarters(MOVE move); // clockwise quarter turns: 1, 2 or 3
+MOVE faceMove(uint8_t face, uint8_t quarters); // MOVE::NONE if the quarter turns cancel out
+// Parses face turns like "R U R' U2", returns the number of moves or -1 on an unknown token.
+int16_t parseMoves(const char *notation, MOVE *moves, uint16_t maxMoves);
+MOVE rotateMove(MOVE move, uint8_t rotation); // a protocol move as seen in that orientation
+uint8_t rotationOf(FACE up, FACE front); // the rotation holding these protocol faces up and front, 0xFF if impossible
+
+template<class Scheme>
+CubeModelT<Scheme>::CubeModelT()
 {
     for(uint8_t i = 0; i < 12; i++)
     {
@@ -130,12 +214,8 @@ CubeModel::CubeModel()
         this->corners[i].index = i;
         this->corners[i].orientation = DIR::ORIENTED;
     }
-    this->centers[uint8_t(FACE::UP)] = COLOR::GREEN;
-    this->centers[uint8_t(FACE::LEFT)] = COLOR::RED;
-    this->centers[uint8_t(FACE::FRONT)] = COLOR::WHITE;
-    this->centers[uint8_t(FACE::RIGHT)] = COLOR::ORANGE;
-    this->centers[uint8_t(FACE::BACK)] = COLOR::YELLOW;
-    this->centers[uint8_t(FACE::DOWN)] = COLOR::BLUE;
+    for(uint8_t i = 0; i < 6; i++) this->centers[i] = Scheme::CENTERS[i];
+    this->solvedMask = SOLVED_MASK_ALL;
     // ** SPECIAL FOR XIAOMI CUBE **
     this->lastTurnedFace = FACE::NONE;
     this->lastTurnedDir = 0;
@@ -143,9 +223,28 @@ CubeModel::CubeModel()
     this->turnedDir = 0;
 }
 
+template<class Scheme>
+CubeModelT<Scheme>::CubeModelT(const array<Cubie, 8> &corners, const array<Cubie, 12> &edges, const array<COLOR, 6> &centers)
+{
+    this->corners = corners;
+    this->edges = edges;
+    this->centers = centers;
+    this->solvedMask = 0;
+    for(uint8_t i = 0; i < 12; i++)
+    {
+        if(this->edges[i].index == i && this->edges[i].orientation == DIR::ORIENTED) this->solvedMask |= 1u << i;
+        if(i < 8 && this->corners[i].index == i && this->corners[i].orientation == DIR::ORIENTED) this->solvedMask |= 1u << (12 + i);
+    }
+    this->lastTurnedFace = FACE::NONE;
+    this->lastTurnedDir = 0;
+    this->turnedFace = FACE::NONE;
+    this->turnedDir = 0;
+}
+
 // ** SPECIAL FOR XIAOMI CUBE **
 // This constructor is special for Xiaomi Smart Cube.
-CubeModel::CubeModel(const uint8_t *data)
+template<class Scheme>
+CubeModelT<Scheme>::CubeModelT(const uint8_t *data)
 {
     // Align corners (data[0:15])
     for(uint8_t i = 0; i < 8; i++)
@@ -161,179 +260,49 @@ CubeModel::CubeModel(const uint8_t *data)
         this->edges[i].orientation = DIR::ORIENTED;
     }
     // now the pointer = 27
-    if((data[28] == 8 && data[29] == 9 && data[30] == 8) || (data[28] == 0x0A && data[29] == 0x0F && data[30] == 0x0A))
-    {
-        this->edges[(uint8_t)EDGE::UB].orientation = DIR::FLIPPED;
-        this->edges[(uint8_t)EDGE::BL].orientation = DIR::FLIPPED;
-        this->edges[(uint8_t)EDGE::_BR].orientation = DIR::FLIPPED;
-        this->edges[(uint8_t)EDGE::DB].orientation = DIR::FLIPPED;
-    }
-    if((data[28] == 2 && data[29] == 6 && data[30] == 2) || (data[28] == 0x0A && data[29] == 0x0F && data[30] == 0x0A))
-    {
-        this->edges[(uint8_t)EDGE::UF].orientation = DIR::FLIPPED;
-        this->edges[(uint8_t)EDGE::FL].orientation = DIR::FLIPPED;
-        this->edges[(uint8_t)EDGE::FR].orientation = DIR::FLIPPED;
-        this->edges[(uint8_t)EDGE::DF].orientation = DIR::FLIPPED;
-    }
+    // Flipped edges (data[28:30]), UB first
+    uint16_t flips = data[28] << 8 | data[29] << 4 | data[30];
+    for(uint8_t i = 0; i < 12; i++) if((flips >> (11 - i)) & 1) this->edges[i].orientation = DIR::FLIPPED;
     // data[31] = 0
-    this->turnedFace = (FACE)data[32];
+    this->turnedFace = data[32] < 7 ? Scheme::PROTOCOL_FACE[data[32]] : FACE::NONE;
     this->turnedDir = data[33] == 1 ? 0 : 1;
-    this->lastTurnedFace = (FACE)data[34];
+    this->lastTurnedFace = data[34] < 7 ? Scheme::PROTOCOL_FACE[data[34]] : FACE::NONE;
     this->lastTurnedDir = data[35] == 1 ? 0 : 1;
-    this->centers[uint8_t(FACE::UP)] = COLOR::GREEN;
-    this->centers[uint8_t(FACE::LEFT)] = COLOR::RED;
-    this->centers[uint8_t(FACE::FRONT)] = COLOR::WHITE;
-    this->centers[uint8_t(FACE::RIGHT)] = COLOR::ORANGE;
-    this->centers[uint8_t(FACE::BACK)] = COLOR::YELLOW;
-    this->centers[uint8_t(FACE::DOWN)] = COLOR::BLUE;
+    for(uint8_t i = 0; i < 6; i++) this->centers[i] = Scheme::CENTERS[i];
+    this->solvedMask = 0;
+    for(uint8_t i = 0; i < 12; i++)
+    {
+        if(this->edges[i].index == i && this->edges[i].orientation == DIR::ORIENTED) this->solvedMask |= 1u << i;
+        if(i < 8 && this->corners[i].index == i && this->corners[i].orientation == DIR::ORIENTED) this->solvedMask |= 1u << (12 + i);
+    }
 }
 
-array<COLOR, 2> CubeModel::getEdgeColors(EDGE edge) const
+// Each sticker shows the center color of its home face, so the colors follow the centers through rotated().
+template<class Scheme>
+array<COLOR, 2> CubeModelT<Scheme>::getEdgeColors(EDGE edge) const
 {
     array<COLOR, 2> result;
-    Cubie edge_cubie = this->edges.at((uint8_t)edge);
-    switch((EDGE)edge_cubie.index)
-    {
-        case EDGE::UB:
-            result[0] = COLOR::GREEN;
-            result[1] = COLOR::YELLOW;
-            break;
-        case EDGE::UL:
-            result[0] = COLOR::GREEN;
-            result[1] = COLOR::RED;
-            break;
-        case EDGE::UF:
-            result[0] = COLOR::GREEN;
-            result[1] = COLOR::WHITE;
-            break;
-        case EDGE::UR:
-            result[0] = COLOR::GREEN;
-            result[1] = COLOR::ORANGE;
-            break;
-        case EDGE::BL:
-            result[0] = COLOR::YELLOW;
-            result[1] = COLOR::RED;
-            break;
-        case EDGE::FL:
-            result[0] = COLOR::WHITE;
-            result[1] = COLOR::RED;
-            break;
-        case EDGE::FR:
-            result[0] = COLOR::WHITE;
-            result[1] = COLOR::ORANGE;
-            break;
-        case EDGE::_BR:
-            result[0] = COLOR::YELLOW;
-            result[1] = COLOR::ORANGE;
-            break;
-        case EDGE::DB:
-            result[0] = COLOR::BLUE;
-            result[1] = COLOR::YELLOW;
-            break;
-        case EDGE::DL:
-            result[0] = COLOR::BLUE;
-            result[1] = COLOR::RED;
-            break;
-        case EDGE::DF:
-            result[0] = COLOR::BLUE;
-            result[1] = COLOR::WHITE;
-            break;
-        case EDGE::DR:
-            result[0] = COLOR::BLUE;
-            result[1] = COLOR::ORANGE;
-            break;
-    }
-    if(edge_cubie.orientation == DIR::FLIPPED) swap(result[0], result[1]);
+    for(uint8_t k = 0; k < 2; k++) result[k] = this->centers[(uint8_t)this->getEdgeFacing(edge, EDGE_FACES[(uint8_t)edge][k])];
     return result;
 }
 /**
  * @return array<COLOR, 3> in the order of Z Y X
 */
-array<COLOR, 3> CubeModel::getCornerColors(CORNER corner) const
+template<class Scheme>
+array<COLOR, 3> CubeModelT<Scheme>::getCornerColors(CORNER corner) const
 {
     array<COLOR, 3> result;
-    // Get the specified location's corner cubie.
-    // ...and check the cubie's original position(stored in corner_cubie.index) to determine the color.
-    // ...if the ULB cubie(index=0) is in the ULF position(corner=1) which is equal to (index+corner)%2==1, then swap the i1 and i2 according to CORNER COLOR ORIENTATION NOTES.
-    // ...however, if the URB(index=3) is placed in the ULF position(corner=1), we should not swap i1 and i2.
-    Cubie corner_cubie = this->corners.at((uint8_t)corner);
-    uint8_t i0, i1, i2;
-    if(corner_cubie.orientation == DIR::ORIENTED) // 3
-    {
-        i0 = 0;
-        i1 = 1;
-        i2 = 2;
-        if((corner_cubie.index + (uint8_t)corner) % 2 == 1) 
-        {
-            swap(i1, i2);
-        }
-    }
-    else if(corner_cubie.orientation == DIR::ROTATED) // 2
-    {
-        i0 = 2;
-        i1 = 0;
-        i2 = 1;
-        if((corner_cubie.index + (uint8_t)corner) % 2 == 1) swap(i0, i2);
-    }
-    // TODO: Problem may kick in if the orientation is not corner's, like FLIPPED. But it should not happen.
-    else // 1
-    {
-        i0 = 1;
-        i1 = 2;
-        i2 = 0;
-        if((corner_cubie.index + (uint8_t)corner) % 2 == 1) 
-        {
-            swap(i0, i1);
-        }
-        else if(!this->isSolved()) swap(i0, i1);
-    }
-    switch((CORNER)corner_cubie.index)
+    for(uint8_t k = 0; k < 3; k++)
     {
-        case CORNER::ULB:
-            result[i0] = COLOR::GREEN;
-            result[i1] = COLOR::RED;
-            result[i2] = COLOR::YELLOW;
-            break;
-        case CORNER::ULF:
-            result[i0] = COLOR::GREEN;
-            result[i1] = COLOR::RED;
-            result[i2] = COLOR::WHITE;
-            break;
-        case CORNER::URF:
-            result[i0] = COLOR::GREEN;
-            result[i1] = COLOR::ORANGE;
-            result[i2] = COLOR::WHITE;
-            break;
-        case CORNER::URB:
-            result[i0] = COLOR::GREEN;
-            result[i1] = COLOR::ORANGE;
-            result[i2] = COLOR::YELLOW;
-            break;
-        case CORNER::DLB:
-            result[i0] = COLOR::BLUE;
-            result[i1] = COLOR::RED;
-            result[i2] = COLOR::YELLOW;
-            break;
-        case CORNER::DLF:
-            result[i0] = COLOR::BLUE;
-            result[i1] = COLOR::RED;
-            result[i2] = COLOR::WHITE;
-            break;
-        case CORNER::DRF:
-            result[i0] = COLOR::BLUE;
-            result[i1] = COLOR::ORANGE;
-            result[i2] = COLOR::WHITE;
-            break;
-        case CORNER::DRB:
-            result[i0] = COLOR::BLUE;
-            result[i1] = COLOR::ORANGE;
-            result[i2] = COLOR::YELLOW;
-            break;
+        FACE face = CORNER_FACES[(uint8_t)corner][k];
+        uint8_t axis = k == 0 ? 0 : (face == FACE::LEFT || face == FACE::RIGHT ? 1 : 2);
+        result[axis] = this->centers[(uint8_t)this->getCornerFacing(corner, face)];
     }
     return result;
 }
 // row and col are 0-indexed and start from the top-left corner.
-COLOR CubeModel::getColor(FACE face, uint8_t row, uint8_t col) const
+template<class Scheme>
+COLOR CubeModelT<Scheme>::getColor(FACE face, uint8_t row, uint8_t col) const
 {
     if(row == 1 && col == 1) return (COLOR)this->centers[(uint8_t)face];
     switch(face)
@@ -400,7 +369,7 @@ COLOR CubeModel::getColor(FACE face, uint8_t row, uint8_t col) const
             {
                 if(col == 0) return this->getCornerColors(CORNER::URF)[1];
                 else if (col == 1) return this->getEdgeColors(EDGE::UR)[1];
-                else return this->getCornerColors(CORNER::URF)[1];
+                else return this->getCornerColors(CORNER::URB)[1];
             }
             else if (row == 1)
             {
@@ -456,7 +425,8 @@ COLOR CubeModel::getColor(FACE face, uint8_t row, uint8_t col) const
             return COLOR::WHITE;
     }
 }
-array<array<COLOR, 3>, 3> CubeModel::getFaceColors(FACE face) const
+template<class Scheme>
+array<array<COLOR, 3>, 3> CubeModelT<Scheme>::getFaceColors(FACE face) const
 {
     array<array<COLOR, 3>, 3> faceColors;
     for(uint8_t row = 0; row < 3; row++)
@@ -468,16 +438,191 @@ array<array<COLOR, 3>, 3> CubeModel::getFaceColors(FACE face) const
     }
     return faceColors;
 }
-bool CubeModel::isSolved() const
+template<class Scheme>
+bool CubeModelT<Scheme>::isSolved() const
 {
-    for(uint8_t i = 0; i < 12; i++)
+    return this->solvedMask == SOLVED_MASK_ALL;
+}
+template<class Scheme>
+uint32_t CubeModelT<Scheme>::getSolvedMask() const
+{
+    return this->solvedMask;
+}
+template<class Scheme>
+uint32_t CubeModelT<Scheme>::hash() const
+{
+    uint32_t h = 2166136261u;
+    for(uint8_t i = 0; i < 12; i++) h = (h ^ (this->edges[i].index | (uint8_t)this->edges[i].orientation << 4)) * 16777619u;
+    for(uint8_t i = 0; i < 8; i++) h = (h ^ (this->corners[i].index | (uint8_t)this->corners[i].orientation << 4)) * 16777619u;
+    return h;
+}
+template<class Scheme>
+void CubeModelT<Scheme>::applyMove(MOVE move)
+{
+    if(move >= MOVE::NONE) return;
+    uint8_t face = (uint8_t)move / 3;
+    const uint8_t *c = FACE_CORNERS[face];
+    const uint8_t *e = FACE_EDGES[face];
+    for(uint8_t turn = 0; turn <= (uint8_t)move % 3; turn++)
     {
-        if(this->edges[i].index != i || this->edges[i].orientation != DIR::ORIENTED) return false;
-        if(i < 6 && (this->corners[i].index != i || this->corners[i].orientation != DIR::ORIENTED)) return false;
+        Cubie temp = this->corners[c[0]];
+        for(uint8_t i = 0; i < 4; i++)
+        {
+            Cubie from = i < 3 ? this->corners[c[i+1]] : temp;
+            from.orientation = (DIR)(3 - (cornerTwist(from.orientation) + FACE_CORNER_TWIST[face][i]) % 3);
+            this->corners[c[i]] = from;
+        }
+        temp = this->edges[e[0]];
+        for(uint8_t i = 0; i < 3; i++) this->edges[e[i]] = this->edges[e[i+1]];
+        this->edges[e[3]] = temp;
+        if(FACE_EDGE_FLIP[face])
+        {
+            for(uint8_t i = 0; i < 4; i++) this->edges[e[i]].orientation = (DIR)(7 - (uint8_t)this->edges[e[i]].orientation);
+        }
     }
-    return true;
+    this->_updateSolvedMask(face);
+}
+// Only the 8 slots of the turned face can change, so the mask is refreshed incrementally.
+template<class Scheme>
+void CubeModelT<Scheme>::_updateSolvedMask(uint8_t face)
+{
+    for(uint8_t i = 0; i < 4; i++)
+    {
+        uint8_t c = FACE_CORNERS[face][i], e = FACE_EDGES[face][i];
+        if(this->corners[c].index == c && this->corners[c].orientation == DIR::ORIENTED) this->solvedMask |= 1u << (12 + c);
+        else this->solvedMask &= ~(1u << (12 + c));
+        if(this->edges[e].index == e && this->edges[e].orientation == DIR::ORIENTED) this->solvedMask |= 1u << e;
+        else this->solvedMask &= ~(1u << e);
+    }
+}
+template<class Scheme>
+typename CubeModelT<Scheme>::Cubie CubeModelT<Scheme>::getEdge(EDGE edge) const
+{
+    return this->edges[(uint8_t)edge];
+}
+template<class Scheme>
+typename CubeModelT<Scheme>::Cubie CubeModelT<Scheme>::getCorner(CORNER corner) const
+{
+    return this->corners[(uint8_t)corner];
+}
+template<class Scheme>
+FACE CubeModelT<Scheme>::getCornerFacing(CORNER corner, FACE face) const
+{
+    const Cubie &cubie = this->corners[(uint8_t)corner];
+    for(uint8_t k = 0; k < 3; k++)
+    {
+        if(CORNER_FACES[(uint8_t)corner][k] == face) return CORNER_FACES[cubie.index][(k + 3 - cornerTwist(cubie.orientation)) % 3];
+    }
+    return FACE::NONE;
+}
+template<class Scheme>
+FACE CubeModelT<Scheme>::getEdgeFacing(EDGE edge, FACE face) const
+{
+    const Cubie &cubie = this->edges[(uint8_t)edge];
+    for(uint8_t k = 0; k < 2; k++)
+    {
+        if(EDGE_FACES[(uint8_t)edge][k] == face) return EDGE_FACES[cubie.index][(k + edgeFlip(cubie.orientation)) % 2];
+    }
+    return FACE::NONE;
+}
+template<class Scheme>
+CubeModelT<Scheme> CubeModelT<Scheme>::rotated(uint8_t rotation) const
+{
+    CubeModelT result = *this;
+    if(rotation >= ROTATION_COUNT) return result;
+    // Slots and cubies are renamed alike, an orientation changes by how differently its slot and its home slot turn.
+    result.solvedMask = 0;
+    for(uint8_t s = 0; s < 8; s++)
+    {
+        const Cubie &cubie = this->corners[s];
+        uint8_t twist = (cornerTwist(cubie.orientation) + ROTATION_CORNER_TWIST[rotation][s] + 3 - ROTATION_CORNER_TWIST[rotation][cubie.index]) % 3;
+        result.corners[ROTATION_CORNER[rotation][s]] = {ROTATION_CORNER[rotation][cubie.index], (DIR)(3 - twist)};
+        if(this->solvedMask & (1u << (12 + s))) result.solvedMask |= 1u << (12 + ROTATION_CORNER[rotation][s]);
+    }
+    for(uint8_t s = 0; s < 12; s++)
+    {
+        const Cubie &cubie = this->edges[s];
+        uint8_t flip = edgeFlip(cubie.orientation) ^ ROTATION_EDGE_FLIP[rotation][s] ^ ROTATION_EDGE_FLIP[rotation][cubie.index];
+        result.edges[ROTATION_EDGE[rotation][s]] = {ROTATION_EDGE[rotation][cubie.index], flip ? DIR::FLIPPED : DIR::ORIENTED};
+        if(this->solvedMask & (1u << s)) result.solvedMask |= 1u << ROTATION_EDGE[rotation][s];
+    }
+    for(uint8_t f = 0; f < 6; f++) result.centers[ROTATION_FACE[rotation][f]] = this->centers[f];
+    if(this->turnedFace < FACE::NONE) result.turnedFace = (FACE)ROTATION_FACE[rotation][(uint8_t)this->turnedFace];
+    if(this->lastTurnedFace < FACE::NONE) result.lastTurnedFace = (FACE)ROTATION_FACE[rotation][(uint8_t)this->lastTurnedFace];
+    return result;
+}
+template<class Scheme>
+MOVE CubeModelT<Scheme>::turnedMove() const
+{
+    if(this->turnedFace >= FACE::NONE) return MOVE::NONE;
+    return (MOVE)((uint8_t)this->turnedFace * 3 + (this->turnedDir ? 2 : 0));
+}
+string moveToString(MOVE move)
+{
+    if(move >= MOVE::NONE) return "";
+    string result(1, "ULFRBD"[(uint8_t)move / 3]);
+    if((uint8_t)move % 3 == 1) result += '2';
+    else if((uint8_t)move % 3 == 2) result += '\'';
+    return result;
+}
+MOVE invertMove(MOVE move)
+{
+    if(move >= MOVE::NONE) return move;
+    return (MOVE)((uint8_t)move / 3 * 3 + 2 - (uint8_t)move % 3);
+}
+uint8_t moveQuarters(MOVE move)
+{
+    return (uint8_t)move % 3 + 1;
+}
+MOVE faceMove(uint8_t face, uint8_t quarters)
+{
+    quarters %= 4;
+    if(quarters == 0) return MOVE::NONE;
+    return (MOVE)(face * 3 + quarters - 1);
+}
+MOVE rotateMove(MOVE move, uint8_t rotation)
+{
+    if(move >= MOVE::NONE || rotation >= ROTATION_COUNT) return move;
+    return (MOVE)ROTATION_MOVE[rotation][(uint8_t)move];
+}
+uint8_t rotationOf(FACE up, FACE front)
+{
+    if(up >= FACE::NONE || front >= FACE::NONE) return 0xFF;
+    return ROTATION_OF[(uint8_t)up][(uint8_t)front];
+}
+int16_t parseMoves(const char *notation, MOVE *moves, uint16_t maxMoves)
+{
+    const char *faces = "ULFRBD";
+    uint16_t count = 0;
+    while(*notation)
+    {
+        if(*notation == ' ' || *notation == '\t' || *notation == '\n' || *notation == '\r')
+        {
+            notation++;
+            continue;
+        }
+        uint8_t face = 0;
+        while(face < 6 && faces[face] != *notation) face++;
+        if(face == 6 || count >= maxMoves) return -1;
+        notation++;
+        uint8_t turn = 0;
+        if(*notation == '2')
+        {
+            turn = 1;
+            notation++;
+            if(*notation == '\'') notation++; // R2' is R2
+        }
+        else if(*notation == '\'')
+        {
+            turn = 2;
+            notation++;
+        }
+        moves[count++] = (MOVE)(face * 3 + turn);
+    }
+    return count;
 }
-bool CubeModel::operator==(const CubeModel &other) const
+template<class Scheme>
+bool CubeModelT<Scheme>::operator==(const CubeModelT &other) const
 {
     for(uint8_t i = 0; i < 12; i++)
     {
@@ -490,7 +635,8 @@ bool CubeModel::operator==(const CubeModel &other) const
     // for(uint8_t i = 0; i < this->edges.size(); i++) if(this->edges[i].index != other.edges[i].index || this->edges[i].orientation != other.edges[i].orientation) return false;
     // for(uint8_t i = 0; i < this->centers.size(); i++) if(this->centers[i] != other.centers[i]) return false;
 }
-bool CubeModel::operator!=(const CubeModel &other) const
+template<class Scheme>
+bool CubeModelT<Scheme>::operator!=(const CubeModelT &other) const
 {
     return !(*this == other);
 }
@@ -0,0 +1,147 @@
+/**
+ * @author Matrixchung
+ * @brief  The cube's 20 byte notify: decryption and half bytes, one packet at a time or in batches.
+ *
+ * A packet with pData[18] == 0xA7 is encrypted: the two half bytes of pData[19] are offsets into AES_KEY, and byte i
+ * is decrypted by adding AES_KEY[offset1 + i] + AES_KEY[offset2 + i]. The 36 half bytes of the first 18 bytes (high
+ * half first) are the cubeData of CubeModel.hpp.
+ *
+ * decodeBatch() writes the half bytes of many packets as structure of arrays, nibbles[i][packet], for capture file
+ * analysis on a host. With AVX2 (checked at runtime on x86), 32 packets go at once:
+ *  - 20 gathers load the packets as 20 rows of 32 bytes (byte i of every packet), transposed in registers
+ *  - the offsets are 4 bit, so the key bytes of row i are a 16 entry table lookup: vpshufb of AES_KEY[i..i+15]
+ *  - the half bytes of row i are two shifts and masks, stored straight to nibbles[2i] and nibbles[2i + 1]
+ * Other packets, and other targets, take the scalar path. tools/decode_bench.cpp compares both.
+ *
+ * **/
+#ifndef _CUBE_PACKET_HPP
+#define _CUBE_PACKET_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+using std::vector;
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CUBE_PACKET_AVX2
+#endif
+
+#define CUBE_PACKET_LENGTH 20
+#define CUBE_PACKET_NIBBLES 36
+#define CUBE_PACKET_ENCRYPTED 0xA7 // pData[18]
+
+const static uint8_t AES_KEY[36] = {176,81,104,224,86,137,237,119,38,26,193,161,210,126,150,81,93,13,236,249,89,235,88,24,113,81,214,131,130,199,2,169,39,165,171,41}; // Keys to decrypt cube color data
+
+// Half bytes of a batch of packets, nibbles[i][p] is cubeData[i] of packet p.
+struct DecodedBatch
+{
+    vector<uint8_t> nibbles[CUBE_PACKET_NIBBLES];
+    size_t count;
+    DecodedBatch();
+    void resize(size_t count);
+    void get(size_t packet, uint8_t *cubeData) const; // 36 half bytes of one packet
+};
+
+// Return i-th half byte of pData
+uint8_t getHalfByte(const uint8_t *pData, int i);
+void decryptPacket(uint8_t *pData); // in place, if encrypted
+void decodeBatch(const uint8_t (*packets)[CUBE_PACKET_LENGTH], size_t n, DecodedBatch &out);
+void decodeBatchScalar(const uint8_t (*packets)[CUBE_PACKET_LENGTH], size_t n, DecodedBatch &out, size_t from = 0);
+
+DecodedBatch::DecodedBatch()
+{
+    this->count = 0;
+}
+void DecodedBatch::resize(size_t count)
+{
+    this->count = count;
+    for(uint8_t i = 0; i < CUBE_PACKET_NIBBLES; i++) this->nibbles[i].resize(count);
+}
+void DecodedBatch::get(size_t packet, uint8_t *cubeData) const
+{
+    for(uint8_t i = 0; i < CUBE_PACKET_NIBBLES; i++) cubeData[i] = this->nibbles[i][packet];
+}
+
+uint8_t getHalfByte(const uint8_t *pData, int i)
+{
+    return i % 2 == 1 ? pData[i / 2] % 16 : pData[i / 2] / 16;
+}
+void decryptPacket(uint8_t *pData)
+{
+    if(pData[18] != CUBE_PACKET_ENCRYPTED) return;
+    uint8_t offset1 = getHalfByte(pData, 38);
+    uint8_t offset2 = getHalfByte(pData, 39);
+    for(int i = 0; i < CUBE_PACKET_LENGTH; i++) pData[i] += AES_KEY[offset1 + i] + AES_KEY[offset2 + i];
+}
+// Packets from `from` on, one at a time.
+void decodeBatchScalar(const uint8_t (*packets)[CUBE_PACKET_LENGTH], size_t n, DecodedBatch &out, size_t from)
+{
+    out.resize(n);
+    for(size_t p = from; p < n; p++)
+    {
+        uint8_t data[CUBE_PACKET_LENGTH];
+        for(uint8_t i = 0; i < CUBE_PACKET_LENGTH; i++) data[i] = packets[p][i];
+        decryptPacket(data);
+        for(uint8_t i = 0; i < CUBE_PACKET_NIBBLES; i++) out.nibbles[i][p] = getHalfByte(data, i);
+    }
+}
+
+#ifdef CUBE_PACKET_AVX2
+// Rows 4k .. 4k + 3 of 32 packets: gathered as one dword per packet, then transposed to one byte row per register.
+__attribute__((target("avx2"))) static inline void _gatherRows(const uint8_t (*packets)[CUBE_PACKET_LENGTH], uint8_t k, __m256i *rows)
+{
+    // in each 128 bit lane, 4 dwords of 4 bytes to 4 dwords of the same byte from 4 packets
+    const __m256i byteMajor = _mm256_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15,
+                                               0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    const __m256i laneMerge = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    const __m256i index = _mm256_setr_epi32(k, 5 + k, 10 + k, 15 + k, 20 + k, 25 + k, 30 + k, 35 + k);
+    __m256i q[4];
+    for(uint8_t i = 0; i < 4; i++)
+    {
+        __m256i dwords = _mm256_i32gather_epi32((const int *)packets[i * 8], index, 4);
+        // qword b: byte 4k + b of packets 8i .. 8i + 7
+        q[i] = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(dwords, byteMajor), laneMerge);
+    }
+    __m256i a = _mm256_unpacklo_epi64(q[0], q[1]), b = _mm256_unpackhi_epi64(q[0], q[1]);
+    __m256i c = _mm256_unpacklo_epi64(q[2], q[3]), d = _mm256_unpackhi_epi64(q[2], q[3]);
+    rows[0] = _mm256_permute2x128_si256(a, c, 0x20);
+    rows[1] = _mm256_permute2x128_si256(b, d, 0x20);
+    rows[2] = _mm256_permute2x128_si256(a, c, 0x31);
+    rows[3] = _mm256_permute2x128_si256(b, d, 0x31);
+}
+__attribute__((target("avx2"))) static size_t _decodeBatchAvx2(const uint8_t (*packets)[CUBE_PACKET_LENGTH], size_t n, DecodedBatch &out)
+{
+    const __m256i low = _mm256_set1_epi8(0x0F);
+    const __m256i encrypted = _mm256_set1_epi8((char)CUBE_PACKET_ENCRYPTED);
+    __m256i keys[18];
+    for(uint8_t i = 0; i < 18; i++) keys[i] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(AES_KEY + i)));
+    size_t p = 0;
+    for(; p + 32 <= n; p += 32)
+    {
+        __m256i rows[CUBE_PACKET_LENGTH];
+        for(uint8_t k = 0; k < CUBE_PACKET_LENGTH / 4; k++) _gatherRows(packets + p, k, rows + k * 4);
+        __m256i mask = _mm256_cmpeq_epi8(rows[18], encrypted);
+        __m256i offset1 = _mm256_and_si256(_mm256_srli_epi16(rows[19], 4), low);
+        __m256i offset2 = _mm256_and_si256(rows[19], low);
+        for(uint8_t i = 0; i < 18; i++)
+        {
+            __m256i key = _mm256_add_epi8(_mm256_shuffle_epi8(keys[i], offset1), _mm256_shuffle_epi8(keys[i], offset2));
+            __m256i row = _mm256_add_epi8(rows[i], _mm256_and_si256(key, mask));
+            _mm256_storeu_si256((__m256i *)(out.nibbles[i * 2].data() + p), _mm256_and_si256(_mm256_srli_epi16(row, 4), low));
+            _mm256_storeu_si256((__m256i *)(out.nibbles[i * 2 + 1].data() + p), _mm256_and_si256(row, low));
+        }
+    }
+    return p;
+}
+#endif
+
+void decodeBatch(const uint8_t (*packets)[CUBE_PACKET_LENGTH], size_t n, DecodedBatch &out)
+{
+    out.resize(n);
+    size_t done = 0;
+    #ifdef CUBE_PACKET_AVX2
+    if(__builtin_cpu_supports("avx2")) done = _decodeBatchAvx2(packets, n, out);
+    #endif
+    decodeBatchScalar(packets, n, out, done);
+}
+#endif
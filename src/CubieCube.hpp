@@ -0,0 +1,277 @@
+/**
+ * @author Matrixchung
+ * @brief  A CubieCube is the bare permutation / orientation form of a cube, for solvers and table generation.
+ *
+ * cp / ep : which cubie is in each slot (CORNER / EDGE order of CubeModel)
+ * co      : clockwise twists of the corner in each slot (0 - 2), eo : flip of the edge in each slot (0 - 1)
+ * Moves use the same cycle tables as CubeModel::applyMove(), so both always agree.
+ *
+ * Coordinates (as in Kociemba's two-phase algorithm, with this repo's slot order):
+ *  twist     : 0 - 2186, orientations of the first 7 corners in base 3
+ *  flip      : 0 - 2047, orientations of the first 11 edges in base 2
+ *  slice     : 0 - 494, positions of the 4 middle layer edges (BL FL FR BR), combinatorial number system
+ *  cornerPerm: 0 - 40319, rank of the corner permutation
+ *  edgePermUD: 0 - 40319, rank of the 8 U / D layer edges, while they stay in the U / D layers
+ *  slicePerm : 0 - 23, rank of the 4 middle layer edges, while they stay in the middle layer
+ * set*() only writes the part of the cube its coordinate describes.
+ *
+ * **/
+#ifndef _CUBIE_CUBE_HPP
+#define _CUBIE_CUBE_HPP
+
+#include <cstdint>
+#include "CubeModel.hpp"
+
+const static uint8_t UD_EDGE_SLOTS[8] = {0, 1, 2, 3, 8, 9, 10, 11};
+const static uint8_t SLICE_EDGE_SLOTS[4] = {4, 5, 6, 7};
+// BINOMIAL[n][k] = C(n, k)
+const static uint16_t BINOMIAL[12][5] = {
+    {1, 0, 0, 0, 0}, {1, 1, 0, 0, 0}, {1, 2, 1, 0, 0}, {1, 3, 3, 1, 0}, {1, 4, 6, 4, 1}, {1, 5, 10, 10, 5},
+    {1, 6, 15, 20, 15}, {1, 7, 21, 35, 35}, {1, 8, 28, 56, 70}, {1, 9, 36, 84, 126}, {1, 10, 45, 120, 210}, {1, 11, 55, 165, 330}
+};
+
+struct CubieCube
+{
+    uint8_t cp[8], co[8];
+    uint8_t ep[12], eo[12];
+    CubieCube();
+    explicit CubieCube(const CubeModel &cube);
+    CubeModel toCubeModel() const; // the same cube, in protocol orientation
+    bool operator==(const CubieCube &other) const;
+    bool isSolved() const;
+    void applyMove(MOVE move);
+    uint16_t getTwist() const;
+    void setTwist(uint16_t twist);
+    uint16_t getFlip() const;
+    void setFlip(uint16_t flip);
+    uint16_t getSlice() const;
+    void setSlice(uint16_t slice);
+    uint16_t getCornerPerm() const;
+    void setCornerPerm(uint16_t perm);
+    uint16_t getEdgePermUD() const;
+    void setEdgePermUD(uint16_t perm);
+    uint8_t getSlicePerm() const;
+    void setSlicePerm(uint8_t perm);
+    uint8_t cornerParity() const;
+    uint8_t edgeParity() const;
+    static uint16_t permRank(const uint8_t *perm, uint8_t n);
+    static void permUnrank(uint16_t rank, uint8_t *perm, uint8_t n);
+};
+
+CubieCube::CubieCube()
+{
+    for(uint8_t i = 0; i < 8; i++)
+    {
+        this->cp[i] = i;
+        this->co[i] = 0;
+    }
+    for(uint8_t i = 0; i < 12; i++)
+    {
+        this->ep[i] = i;
+        this->eo[i] = 0;
+    }
+}
+CubieCube::CubieCube(const CubeModel &cube)
+{
+    for(uint8_t i = 0; i < 8; i++)
+    {
+        CubeModel::Cubie corner = cube.getCorner((CORNER)i);
+        this->cp[i] = corner.index;
+        this->co[i] = CubeModel::cornerTwist(corner.orientation);
+    }
+    for(uint8_t i = 0; i < 12; i++)
+    {
+        CubeModel::Cubie edge = cube.getEdge((EDGE)i);
+        this->ep[i] = edge.index;
+        this->eo[i] = CubeModel::edgeFlip(edge.orientation);
+    }
+}
+CubeModel CubieCube::toCubeModel() const
+{
+    array<CubeModel::Cubie, 8> corners;
+    array<CubeModel::Cubie, 12> edges;
+    array<COLOR, 6> centers;
+    for(uint8_t i = 0; i < 8; i++) corners[i] = {this->cp[i], this->co[i] ? (DIR)(3 - this->co[i]) : DIR::ORIENTED};
+    for(uint8_t i = 0; i < 12; i++) edges[i] = {this->ep[i], this->eo[i] ? DIR::FLIPPED : DIR::ORIENTED};
+    for(uint8_t i = 0; i < 6; i++) centers[i] = XiaomiScheme::CENTERS[i];
+    return CubeModel(corners, edges, centers);
+}
+bool CubieCube::operator==(const CubieCube &other) const
+{
+    for(uint8_t i = 0; i < 12; i++)
+    {
+        if(this->ep[i] != other.ep[i] || this->eo[i] != other.eo[i]) return false;
+        if(i < 8 && (this->cp[i] != other.cp[i] || this->co[i] != other.co[i])) return false;
+    }
+    return true;
+}
+bool CubieCube::isSolved() const
+{
+    return *this == CubieCube();
+}
+void CubieCube::applyMove(MOVE move)
+{
+    if(move >= MOVE::NONE) return;
+    uint8_t face = (uint8_t)move / 3;
+    const uint8_t *c = FACE_CORNERS[face];
+    const uint8_t *e = FACE_EDGES[face];
+    for(uint8_t turn = 0; turn <= (uint8_t)move % 3; turn++)
+    {
+        uint8_t cp0 = this->cp[c[0]], co0 = this->co[c[0]];
+        for(uint8_t i = 0; i < 4; i++)
+        {
+            uint8_t piece = i < 3 ? this->cp[c[i + 1]] : cp0;
+            uint8_t twist = i < 3 ? this->co[c[i + 1]] : co0;
+            this->cp[c[i]] = piece;
+            this->co[c[i]] = (twist + FACE_CORNER_TWIST[face][i]) % 3;
+        }
+        uint8_t ep0 = this->ep[e[0]], eo0 = this->eo[e[0]];
+        for(uint8_t i = 0; i < 3; i++)
+        {
+            this->ep[e[i]] = this->ep[e[i + 1]];
+            this->eo[e[i]] = this->eo[e[i + 1]];
+        }
+        this->ep[e[3]] = ep0;
+        this->eo[e[3]] = eo0;
+        if(FACE_EDGE_FLIP[face])
+        {
+            for(uint8_t i = 0; i < 4; i++) this->eo[e[i]] ^= 1;
+        }
+    }
+}
+uint16_t CubieCube::getTwist() const
+{
+    uint16_t twist = 0;
+    for(uint8_t i = 0; i < 7; i++) twist = twist * 3 + this->co[i];
+    return twist;
+}
+void CubieCube::setTwist(uint16_t twist)
+{
+    uint8_t sum = 0;
+    for(int8_t i = 6; i >= 0; i--)
+    {
+        this->co[i] = twist % 3;
+        sum += this->co[i];
+        twist /= 3;
+    }
+    this->co[7] = (3 - sum % 3) % 3;
+}
+uint16_t CubieCube::getFlip() const
+{
+    uint16_t flip = 0;
+    for(uint8_t i = 0; i < 11; i++) flip = flip << 1 | this->eo[i];
+    return flip;
+}
+void CubieCube::setFlip(uint16_t flip)
+{
+    uint8_t sum = 0;
+    for(int8_t i = 10; i >= 0; i--)
+    {
+        this->eo[i] = flip & 1;
+        sum += this->eo[i];
+        flip >>= 1;
+    }
+    this->eo[11] = sum & 1;
+}
+uint16_t CubieCube::getSlice() const
+{
+    uint16_t slice = 0;
+    uint8_t k = 0;
+    for(uint8_t i = 0; i < 12; i++)
+    {
+        if(this->ep[i] >= 4 && this->ep[i] < 8) slice += BINOMIAL[i][++k];
+    }
+    return slice;
+}
+void CubieCube::setSlice(uint16_t slice)
+{
+    bool occupied[12] = {false};
+    for(int8_t k = 4, i = 11; k > 0; k--)
+    {
+        while(BINOMIAL[i][k] > slice) i--;
+        slice -= BINOMIAL[i][k];
+        occupied[i--] = true;
+    }
+    uint8_t nextSlice = 4, nextOther = 0;
+    for(uint8_t i = 0; i < 12; i++)
+    {
+        if(occupied[i]) this->ep[i] = nextSlice++;
+        else this->ep[i] = UD_EDGE_SLOTS[nextOther++];
+    }
+}
+uint16_t CubieCube::getCornerPerm() const
+{
+    return permRank(this->cp, 8);
+}
+void CubieCube::setCornerPerm(uint16_t perm)
+{
+    permUnrank(perm, this->cp, 8);
+}
+uint16_t CubieCube::getEdgePermUD() const
+{
+    uint8_t perm[8];
+    for(uint8_t i = 0; i < 8; i++)
+    {
+        uint8_t edge = this->ep[UD_EDGE_SLOTS[i]];
+        perm[i] = edge < 4 ? edge : edge - 4;
+    }
+    return permRank(perm, 8);
+}
+void CubieCube::setEdgePermUD(uint16_t perm)
+{
+    uint8_t edges[8];
+    permUnrank(perm, edges, 8);
+    for(uint8_t i = 0; i < 8; i++) this->ep[UD_EDGE_SLOTS[i]] = UD_EDGE_SLOTS[edges[i]];
+}
+uint8_t CubieCube::getSlicePerm() const
+{
+    uint8_t perm[4];
+    for(uint8_t i = 0; i < 4; i++) perm[i] = this->ep[SLICE_EDGE_SLOTS[i]] - 4;
+    return permRank(perm, 4);
+}
+void CubieCube::setSlicePerm(uint8_t perm)
+{
+    uint8_t edges[4];
+    permUnrank(perm, edges, 4);
+    for(uint8_t i = 0; i < 4; i++) this->ep[SLICE_EDGE_SLOTS[i]] = SLICE_EDGE_SLOTS[edges[i]];
+}
+uint8_t CubieCube::cornerParity() const
+{
+    uint8_t parity = 0;
+    for(uint8_t i = 0; i < 8; i++) for(uint8_t j = i + 1; j < 8; j++) parity ^= this->cp[j] < this->cp[i];
+    return parity;
+}
+uint8_t CubieCube::edgeParity() const
+{
+    uint8_t parity = 0;
+    for(uint8_t i = 0; i < 12; i++) for(uint8_t j = i + 1; j < 12; j++) parity ^= this->ep[j] < this->ep[i];
+    return parity;
+}
+// Lehmer code, n <= 8
+uint16_t CubieCube::permRank(const uint8_t *perm, uint8_t n)
+{
+    uint16_t rank = 0;
+    for(uint8_t i = 0; i < n; i++)
+    {
+        uint8_t smaller = 0;
+        for(uint8_t j = i + 1; j < n; j++) smaller += perm[j] < perm[i];
+        rank = rank * (n - i) + smaller;
+    }
+    return rank;
+}
+void CubieCube::permUnrank(uint16_t rank, uint8_t *perm, uint8_t n)
+{
+    uint8_t digits[8], available[8];
+    for(int8_t i = n - 1; i >= 0; i--)
+    {
+        digits[i] = rank % (n - i);
+        rank /= (n - i);
+    }
+    for(uint8_t i = 0; i < n; i++) available[i] = i;
+    for(uint8_t i = 0; i < n; i++)
+    {
+        perm[i] = available[digits[i]];
+        for(uint8_t j = digits[i]; j + 1 < n - i; j++) available[j] = available[j + 1];
+    }
+}
+#endif
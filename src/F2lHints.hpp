@@ -0,0 +1,280 @@
+/**
+ * @author Matrixchung
+ * @brief  F2lHints finds the shortest insertion of any F2L pair that keeps the cross and the solved pairs.
+ *
+ * Only the pieces that matter are tracked, in the frame with the cross face down (rotated(), RotationTables.hpp):
+ * the 4 pairs and the 4 cross edges, 24 states each (slot * 3 + twist for a corner, slot * 2 + flip for an edge),
+ * moved by table lookups. IDA* runs over U L F R B (D is never needed to insert a pair).
+ *
+ * F2lHintTables holds, for one slot's pair together with one cross edge, the moves to bring both home:
+ * 24 * 24 * 24 states for each of the 4 places of the cross edge around the slot, 4 bits each (27 KB). The other
+ * slots are the same tables seen after a y turn. The bound of a node is
+ *  max(each solved pair with each cross edge, min over unsolved slots of (max of that pair with each cross edge))
+ * which is what makes the search short: the pair table alone, without the cross, searches ~30x the nodes.
+ *
+ * Pairs take 3 - 9 moves; find() searches ~200 nodes for the first pair and ~3,000 for the last on average.
+ *
+ * **/
+#ifndef _F2L_HINTS_HPP
+#define _F2L_HINTS_HPP
+
+#include <cstdint>
+#include "CubeModel.hpp"
+#include "CubieCube.hpp"
+#include "RotationTables.hpp"
+#include "TwoPhaseSolver.hpp"
+
+#define F2L_HINT_MAX_LENGTH 12
+#define F2L_HINT_MAX_NODES  100000 // per find()
+#define F2L_TABLE_SIZE      13824  // 24 corner * 24 edge * 24 cross edge states, per cross edge place
+
+// The state of a piece after each move.
+struct F2lMoveMap
+{
+    uint8_t corner[18][24];
+    uint8_t edge[18][24];
+    F2lMoveMap();
+};
+F2lMoveMap::F2lMoveMap()
+{
+    for(uint8_t m = 0; m < 18; m++)
+    {
+        CubieCube cube;
+        cube.applyMove((MOVE)m);
+        for(uint8_t s = 0; s < 8; s++)
+        {
+            for(uint8_t t = 0; t < 3; t++) this->corner[m][cube.cp[s] * 3 + t] = s * 3 + (t + cube.co[s]) % 3;
+        }
+        for(uint8_t s = 0; s < 12; s++)
+        {
+            for(uint8_t f = 0; f < 2; f++) this->edge[m][cube.ep[s] * 2 + f] = s * 2 + (f ^ cube.eo[s]);
+        }
+    }
+}
+const static F2lMoveMap F2L_MOVE_MAP;
+
+// The y turn taking slot k to slot 0 (DLB, BL): piece states as seen after it, and where cross edge DB + j is seen.
+struct F2lSymmetry
+{
+    uint8_t corner[4][24];
+    uint8_t pairEdge[4][24];
+    uint8_t crossEdge[4][24];
+    uint8_t crossPlace[4][4];
+    F2lSymmetry();
+};
+F2lSymmetry::F2lSymmetry()
+{
+    for(uint8_t k = 0; k < 4; k++)
+    {
+        uint8_t r = 0;
+        while(ROTATION_CORNER[r][4 + k] != 4) r++;
+        for(uint8_t s = 0; s < 8; s++)
+        {
+            for(uint8_t t = 0; t < 3; t++)
+            {
+                this->corner[k][s * 3 + t] = ROTATION_CORNER[r][s] * 3 + (t + 3 + ROTATION_CORNER_TWIST[r][s] - ROTATION_CORNER_TWIST[r][4 + k]) % 3;
+            }
+        }
+        for(uint8_t s = 0; s < 12; s++)
+        {
+            for(uint8_t f = 0; f < 2; f++)
+            {
+                this->pairEdge[k][s * 2 + f] = ROTATION_EDGE[r][s] * 2 + (f ^ ROTATION_EDGE_FLIP[r][s] ^ ROTATION_EDGE_FLIP[r][4 + k]);
+                this->crossEdge[k][s * 2 + f] = ROTATION_EDGE[r][s] * 2 + (f ^ ROTATION_EDGE_FLIP[r][s] ^ ROTATION_EDGE_FLIP[r][8 + k]);
+            }
+        }
+        for(uint8_t j = 0; j < 4; j++) this->crossPlace[k][j] = ROTATION_EDGE[r][8 + j] - 8;
+    }
+}
+const static F2lSymmetry F2L_SYMMETRY;
+
+class F2lHintTables
+{
+    private:
+        NibbleTable distance; // (place * 576 + corner * 24 + edge) * 24 + cross edge, slot 0
+        bool built;
+    public:
+        F2lHintTables();
+        void build(); // ~3 ms on a desktop core
+        bool isBuilt() const;
+        size_t bytes() const;
+        // moves to bring the pair of slot k and every cross edge home, each cross edge taken alone
+        uint8_t bound(uint8_t slot, uint8_t corner, uint8_t edge, const uint8_t *cross) const;
+};
+
+class F2lHints
+{
+    private:
+        struct State
+        {
+            uint8_t corners[4], edges[4]; // pair k: corner DLB + k, edge BL + k
+            uint8_t cross[4];             // edge DB + k
+        };
+        const F2lHintTables &tables;
+        uint8_t solved; // slots solved when find() was called, bit k
+        MOVE path[F2L_HINT_MAX_LENGTH];
+        uint8_t found;  // slot inserted by path
+        uint32_t nodes, maxNodes;
+        uint8_t _bound(const State &state) const;
+        bool _search(const State &state, uint8_t depth, uint8_t togo, uint8_t lastFace);
+    public:
+        struct Hint
+        {
+            CORNER slot;    // corner of the F2L slot, protocol frame
+            uint8_t length;
+            MOVE moves[F2L_HINT_MAX_LENGTH]; // protocol moves
+        };
+        F2lHints(const F2lHintTables &tables);
+        // false if the cross is not solved, F2L is done, the tables are not built or nothing is found within the limits
+        bool find(const CubeModel &cube, FACE crossFace, Hint &hint, uint8_t maxLength = F2L_HINT_MAX_LENGTH, uint32_t maxNodes = F2L_HINT_MAX_NODES);
+        uint32_t getNodes() const; // searched by the last find()
+};
+
+F2lHintTables::F2lHintTables()
+{
+    this->built = false;
+}
+// Breadth-first search one depth at a time, like TwoPhaseTables::_build().
+void F2lHintTables::build()
+{
+    if(this->built) return;
+    this->distance.resize(4 * F2L_TABLE_SIZE);
+    for(uint8_t place = 0; place < 4; place++)
+    {
+        uint32_t base = place * F2L_TABLE_SIZE;
+        this->distance.set(base + (4 * 3 * 24 + 4 * 2) * 24 + (8 + place) * 2, 0);
+        bool found = true;
+        for(uint8_t depth = 0; found && depth < 14; depth++)
+        {
+            found = false;
+            for(uint32_t index = 0; index < F2L_TABLE_SIZE; index++)
+            {
+                if(this->distance.get(base + index) != depth) continue;
+                uint8_t corner = index / 576, edge = index / 24 % 24, cross = index % 24;
+                for(uint8_t m = 0; m < 15; m++)
+                {
+                    uint32_t next = base + (F2L_MOVE_MAP.corner[m][corner] * 24 + F2L_MOVE_MAP.edge[m][edge]) * 24 + F2L_MOVE_MAP.edge[m][cross];
+                    if(this->distance.get(next) != 0xF) continue;
+                    this->distance.set(next, depth + 1);
+                    found = true;
+                }
+            }
+        }
+    }
+    this->built = true;
+}
+bool F2lHintTables::isBuilt() const
+{
+    return this->built;
+}
+size_t F2lHintTables::bytes() const
+{
+    return this->distance.bytes();
+}
+uint8_t F2lHintTables::bound(uint8_t slot, uint8_t corner, uint8_t edge, const uint8_t *cross) const
+{
+    uint32_t pair = F2L_SYMMETRY.corner[slot][corner] * 576 + F2L_SYMMETRY.pairEdge[slot][edge] * 24;
+    uint8_t bound = 0;
+    for(uint8_t j = 0; j < 4; j++)
+    {
+        uint8_t d = this->distance.get(F2L_SYMMETRY.crossPlace[slot][j] * F2L_TABLE_SIZE + pair + F2L_SYMMETRY.crossEdge[slot][cross[j]]);
+        if(d > bound) bound = d;
+    }
+    return bound;
+}
+
+F2lHints::F2lHints(const F2lHintTables &tables) : tables(tables)
+{
+    this->solved = 0;
+    this->found = 0;
+    this->nodes = 0;
+    this->maxNodes = F2L_HINT_MAX_NODES;
+}
+bool F2lHints::find(const CubeModel &cube, FACE crossFace, Hint &hint, uint8_t maxLength, uint32_t maxNodes)
+{
+    this->nodes = 0;
+    this->maxNodes = maxNodes;
+    if(crossFace >= FACE::NONE || !this->tables.isBuilt()) return false;
+    uint8_t up = (uint8_t)OPPOSITE_FACE[(uint8_t)crossFace], front = 0;
+    while(front == up || front == (uint8_t)crossFace) front++;
+    uint8_t rotation = rotationOf((FACE)up, (FACE)front);
+    CubieCube seen(cube.rotated(rotation));
+    State state;
+    for(uint8_t s = 0; s < 8; s++)
+    {
+        if(seen.cp[s] >= 4) state.corners[seen.cp[s] - 4] = s * 3 + seen.co[s];
+    }
+    for(uint8_t s = 0; s < 12; s++)
+    {
+        uint8_t e = seen.ep[s];
+        if(e >= 4 && e < 8) state.edges[e - 4] = s * 2 + seen.eo[s];
+        else if(e >= 8) state.cross[e - 8] = s * 2 + seen.eo[s];
+    }
+    this->solved = 0;
+    for(uint8_t k = 0; k < 4; k++)
+    {
+        if(state.cross[k] != (8 + k) * 2) return false;
+        if(state.corners[k] == (4 + k) * 3 && state.edges[k] == (4 + k) * 2) this->solved |= 1u << k;
+    }
+    if(this->solved == 0xF) return false;
+    if(maxLength > F2L_HINT_MAX_LENGTH) maxLength = F2L_HINT_MAX_LENGTH;
+    uint8_t inverse = ROTATION_INVERSE[rotation];
+    for(uint8_t depth = this->_bound(state); depth <= maxLength && this->nodes <= this->maxNodes; depth++)
+    {
+        if(!this->_search(state, 0, depth, (uint8_t)FACE::NONE)) continue;
+        hint.slot = (CORNER)ROTATION_CORNER[inverse][4 + this->found];
+        hint.length = depth;
+        for(uint8_t i = 0; i < depth; i++) hint.moves[i] = rotateMove(this->path[i], inverse);
+        return true;
+    }
+    return false;
+}
+uint32_t F2lHints::getNodes() const
+{
+    return this->nodes;
+}
+uint8_t F2lHints::_bound(const State &state) const
+{
+    uint8_t keep = 0, insert = 0xFF;
+    for(uint8_t k = 0; k < 4; k++)
+    {
+        uint8_t d = this->tables.bound(k, state.corners[k], state.edges[k], state.cross);
+        if(this->solved & (1u << k))
+        {
+            if(d > keep) keep = d;
+        }
+        else if(d < insert) insert = d;
+    }
+    return insert > keep ? insert : keep;
+}
+bool F2lHints::_search(const State &state, uint8_t depth, uint8_t togo, uint8_t lastFace)
+{
+    this->nodes++;
+    if(this->_bound(state) > togo || this->nodes > this->maxNodes) return false;
+    if(togo == 0)
+    {
+        // the bound is 0: the cross and the solved pairs are home, and so is at least one more pair
+        for(this->found = 0; this->solved & (1u << this->found) || state.corners[this->found] != (4 + this->found) * 3 ||
+            state.edges[this->found] != (4 + this->found) * 2; this->found++);
+        return true;
+    }
+    for(uint8_t face = 0; face < 5; face++)
+    {
+        if(skipAfter(face, lastFace)) continue;
+        for(uint8_t turn = 0; turn < 3; turn++)
+        {
+            uint8_t m = face * 3 + turn;
+            State next;
+            for(uint8_t k = 0; k < 4; k++)
+            {
+                next.corners[k] = F2L_MOVE_MAP.corner[m][state.corners[k]];
+                next.edges[k] = F2L_MOVE_MAP.edge[m][state.edges[k]];
+                next.cross[k] = F2L_MOVE_MAP.edge[m][state.cross[k]];
+            }
+            this->path[depth] = (MOVE)m;
+            if(this->_search(next, depth + 1, togo - 1, face)) return true;
+        }
+    }
+    return false;
+}
+#endif
@@ -0,0 +1,277 @@
+/**
+ * @author Matrixchung
+ * @brief  A FaceletCube stores the 54 sticker colors directly, for renderers and color based recognizers.
+ *
+ * Facelet f * 9 + row * 3 + col holds the COLOR at (row, col) of face f, the same layout as CubeModel::getColor():
+ * U with B on top, D with F on top, the side faces with U on top (tools/gen_facelet_tables.py).
+ *
+ * A face turn is a fixed byte permutation of the facelets, so a renderer can follow the moves sticker by sticker
+ * instead of deriving all 54 colors from the cubies again:
+ *  ESP32 / generic: five 4-cycles per quarter turn (FACELET_CYCLES), 20 byte moves, the center never moves.
+ *  SSSE3 / AVX2   : the facelets are padded to 64 bytes and each move is a set of pshufb masks, built once from
+ *                   the same cycles. AVX2 broadcasts each 16 byte source lane and needs 8 shuffles, SSSE3 needs 16.
+ *
+ * toModel() finds each cubie by its colors, with the centers telling which color belongs to which face,
+ * so a rotated cube (see CubeModel::rotated()) converts back as well. It fails if the stickers do not make
+ * 20 different cubies, it does not check solvability.
+ *
+ * **/
+#ifndef _FACELET_CUBE_HPP
+#define _FACELET_CUBE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include "CubeModel.hpp"
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+#include <immintrin.h>
+#define FACELET_SHUFFLE 1
+#else
+#define FACELET_SHUFFLE 0
+#endif
+
+#define FACELET_COUNT 54
+#define FACELET_PADDED 64 // storage with FACELET_SHUFFLE, 4 * 16 bytes
+
+// Facelets cycled by a clockwise quarter turn of each face: new[cycle[i]] = old[cycle[i+1]], like FACE_CORNERS.
+const static uint8_t FACELET_CYCLES[6][5][4] = {
+    {{6, 8, 2, 0}, {3, 7, 5, 1}, {18, 27, 36, 9}, {19, 28, 37, 10}, {20, 29, 38, 11}},
+    {{44, 45, 18, 0}, {41, 48, 21, 3}, {38, 51, 24, 6}, {15, 17, 11, 9}, {12, 16, 14, 10}},
+    {{17, 47, 27, 6}, {14, 46, 30, 7}, {11, 45, 33, 8}, {24, 26, 20, 18}, {21, 25, 23, 19}},
+    {{20, 47, 42, 2}, {23, 50, 39, 5}, {26, 53, 36, 8}, {33, 35, 29, 27}, {30, 34, 32, 28}},
+    {{29, 53, 15, 0}, {32, 52, 12, 1}, {35, 51, 9, 2}, {42, 44, 38, 36}, {39, 43, 41, 37}},
+    {{42, 33, 24, 15}, {43, 34, 25, 16}, {44, 35, 26, 17}, {51, 53, 47, 45}, {48, 52, 50, 46}}
+};
+// Facelet of each slot's stickers, in the order of CORNER_FACES / EDGE_FACES.
+const static uint8_t CORNER_FACELETS[8][3] = {
+    {0, 9, 38}, {6, 18, 11}, {8, 27, 20}, {2, 36, 29}, {51, 44, 15}, {45, 17, 24}, {47, 26, 33}, {53, 35, 42}
+};
+const static uint8_t EDGE_FACELETS[12][2] = {
+    {1, 37}, {3, 10}, {7, 19}, {5, 28}, {41, 12}, {21, 14}, {23, 30}, {39, 32}, {52, 43}, {48, 16}, {46, 25}, {50, 34}
+};
+
+class FaceletCube
+{
+    private:
+        #if FACELET_SHUFFLE
+        alignas(32) uint8_t facelets[FACELET_PADDED];
+        #else
+        uint8_t facelets[FACELET_COUNT];
+        #endif
+    public:
+        FaceletCube(); // solved, CubeModel colors
+        template<class Scheme>
+        explicit FaceletCube(const CubeModelT<Scheme> &cube);
+        template<class Scheme>
+        bool toModel(CubeModelT<Scheme> &cube) const; // false if the stickers are not 20 different cubies
+        bool operator==(const FaceletCube &other) const;
+        bool operator!=(const FaceletCube &other) const;
+        COLOR getColor(FACE face, uint8_t row, uint8_t col) const;
+        const uint8_t *getFacelets() const; // FACELET_COUNT colors
+        void applyMove(MOVE move);
+        static void permute(uint8_t *facelets, MOVE move); // the cycles on any 54 bytes
+};
+
+#if FACELET_SHUFFLE
+// pshufb masks of every move: byte i of output register j takes byte mask[i] of source lane k, 0x80 - none.
+struct FaceletShuffles
+{
+    #if defined(__AVX2__)
+    alignas(32) uint8_t masks[18][2][4][32];
+    #else
+    alignas(16) uint8_t masks[18][4][4][16];
+    #endif
+    FaceletShuffles();
+};
+FaceletShuffles::FaceletShuffles()
+{
+    for(uint8_t m = 0; m < 18; m++)
+    {
+        // the source of each facelet, by moving the indexes themselves
+        uint8_t source[FACELET_PADDED];
+        for(uint8_t i = 0; i < FACELET_PADDED; i++) source[i] = i;
+        FaceletCube::permute(source, (MOVE)m);
+        uint8_t *mask = &this->masks[m][0][0][0];
+        for(uint8_t i = 0; i < FACELET_PADDED; i++)
+        {
+            #if defined(__AVX2__)
+            uint8_t reg = i / 32, pos = i % 32;
+            #else
+            uint8_t reg = i / 16, pos = i % 16;
+            #endif
+            for(uint8_t k = 0; k < 4; k++)
+            {
+                mask[(reg * 4 + k) * sizeof(this->masks[0][0][0]) + pos] = source[i] / 16 == k ? source[i] % 16 : 0x80;
+            }
+        }
+    }
+}
+const static FaceletShuffles FACELET_SHUFFLES;
+#endif
+
+FaceletCube::FaceletCube()
+{
+    *this = FaceletCube(CubeModel());
+}
+template<class Scheme>
+FaceletCube::FaceletCube(const CubeModelT<Scheme> &cube)
+{
+    memset(this->facelets, 0, sizeof(this->facelets));
+    COLOR centers[6];
+    for(uint8_t f = 0; f < 6; f++)
+    {
+        centers[f] = cube.getColor((FACE)f, 1, 1);
+        this->facelets[f * 9 + 4] = (uint8_t)centers[f];
+    }
+    // slot sticker k shows the cubie's own sticker (k - twist) % 3, or (k + flip) % 2
+    for(uint8_t s = 0; s < 8; s++)
+    {
+        typename CubeModelT<Scheme>::Cubie cubie = cube.getCorner((CORNER)s);
+        uint8_t twist = CubeModelT<Scheme>::cornerTwist(cubie.orientation);
+        for(uint8_t k = 0; k < 3; k++) this->facelets[CORNER_FACELETS[s][k]] = (uint8_t)centers[(uint8_t)CORNER_FACES[cubie.index][(k + 3 - twist) % 3]];
+    }
+    for(uint8_t s = 0; s < 12; s++)
+    {
+        typename CubeModelT<Scheme>::Cubie cubie = cube.getEdge((EDGE)s);
+        uint8_t flip = CubeModelT<Scheme>::edgeFlip(cubie.orientation);
+        for(uint8_t k = 0; k < 2; k++) this->facelets[EDGE_FACELETS[s][k]] = (uint8_t)centers[(uint8_t)EDGE_FACES[cubie.index][(k + flip) % 2]];
+    }
+}
+template<class Scheme>
+bool FaceletCube::toModel(CubeModelT<Scheme> &cube) const
+{
+    // home face of each color
+    uint8_t faceOf[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    array<COLOR, 6> centers;
+    for(uint8_t f = 0; f < 6; f++)
+    {
+        uint8_t color = this->facelets[f * 9 + 4];
+        if(color >= 6 || faceOf[color] != 0xFF) return false;
+        faceOf[color] = f;
+        centers[f] = (COLOR)color;
+    }
+    array<typename CubeModelT<Scheme>::Cubie, 8> corners;
+    array<typename CubeModelT<Scheme>::Cubie, 12> edges;
+    uint32_t used = 0;
+    for(uint8_t s = 0; s < 8; s++)
+    {
+        FACE shown[3];
+        for(uint8_t k = 0; k < 3; k++)
+        {
+            uint8_t color = this->facelets[CORNER_FACELETS[s][k]];
+            if(color >= 6) return false;
+            shown[k] = (FACE)faceOf[color];
+        }
+        bool found = false;
+        for(uint8_t i = 0; i < 8 && !found; i++)
+        {
+            for(uint8_t twist = 0; twist < 3 && !found; twist++)
+            {
+                found = true;
+                for(uint8_t k = 0; k < 3; k++) found = found && CORNER_FACES[i][(k + 3 - twist) % 3] == shown[k];
+                if(found) corners[s] = {i, (DIR)(3 - twist)};
+            }
+        }
+        if(!found || (used & (1u << (12 + corners[s].index)))) return false;
+        used |= 1u << (12 + corners[s].index);
+    }
+    for(uint8_t s = 0; s < 12; s++)
+    {
+        FACE shown[2];
+        for(uint8_t k = 0; k < 2; k++)
+        {
+            uint8_t color = this->facelets[EDGE_FACELETS[s][k]];
+            if(color >= 6) return false;
+            shown[k] = (FACE)faceOf[color];
+        }
+        bool found = false;
+        for(uint8_t i = 0; i < 12 && !found; i++)
+        {
+            for(uint8_t flip = 0; flip < 2 && !found; flip++)
+            {
+                found = EDGE_FACES[i][flip] == shown[0] && EDGE_FACES[i][1 - flip] == shown[1];
+                if(found) edges[s] = {i, flip ? DIR::FLIPPED : DIR::ORIENTED};
+            }
+        }
+        if(!found || (used & (1u << edges[s].index))) return false;
+        used |= 1u << edges[s].index;
+    }
+    cube = CubeModelT<Scheme>(corners, edges, centers);
+    return true;
+}
+bool FaceletCube::operator==(const FaceletCube &other) const
+{
+    return memcmp(this->facelets, other.facelets, FACELET_COUNT) == 0;
+}
+bool FaceletCube::operator!=(const FaceletCube &other) const
+{
+    return !(*this == other);
+}
+COLOR FaceletCube::getColor(FACE face, uint8_t row, uint8_t col) const
+{
+    return (COLOR)this->facelets[(uint8_t)face * 9 + row * 3 + col];
+}
+const uint8_t *FaceletCube::getFacelets() const
+{
+    return this->facelets;
+}
+void FaceletCube::permute(uint8_t *facelets, MOVE move)
+{
+    if(move >= MOVE::NONE) return;
+    const uint8_t (*cycles)[4] = FACELET_CYCLES[(uint8_t)move / 3];
+    for(uint8_t i = 0; i < 5; i++)
+    {
+        const uint8_t *c = cycles[i];
+        uint8_t temp = facelets[c[0]];
+        switch((uint8_t)move % 3)
+        {
+            case 0:
+                facelets[c[0]] = facelets[c[1]];
+                facelets[c[1]] = facelets[c[2]];
+                facelets[c[2]] = facelets[c[3]];
+                facelets[c[3]] = temp;
+                break;
+            case 1:
+                facelets[c[0]] = facelets[c[2]];
+                facelets[c[2]] = temp;
+                temp = facelets[c[1]];
+                facelets[c[1]] = facelets[c[3]];
+                facelets[c[3]] = temp;
+                break;
+            default:
+                facelets[c[0]] = facelets[c[3]];
+                facelets[c[3]] = facelets[c[2]];
+                facelets[c[2]] = facelets[c[1]];
+                facelets[c[1]] = temp;
+                break;
+        }
+    }
+}
+void FaceletCube::applyMove(MOVE move)
+{
+    if(move >= MOVE::NONE) return;
+    #if FACELET_SHUFFLE && defined(__AVX2__)
+    const __m256i *mask = (const __m256i *)FACELET_SHUFFLES.masks[(uint8_t)move];
+    __m256i lane[4];
+    for(uint8_t k = 0; k < 4; k++) lane[k] = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)(this->facelets + k * 16)));
+    for(uint8_t j = 0; j < 2; j++)
+    {
+        __m256i result = _mm256_shuffle_epi8(lane[0], _mm256_load_si256(mask + j * 4));
+        for(uint8_t k = 1; k < 4; k++) result = _mm256_or_si256(result, _mm256_shuffle_epi8(lane[k], _mm256_load_si256(mask + j * 4 + k)));
+        _mm256_store_si256((__m256i *)(this->facelets + j * 32), result);
+    }
+    #elif FACELET_SHUFFLE
+    const __m128i *mask = (const __m128i *)FACELET_SHUFFLES.masks[(uint8_t)move];
+    __m128i lane[4];
+    for(uint8_t k = 0; k < 4; k++) lane[k] = _mm_load_si128((const __m128i *)(this->facelets + k * 16));
+    for(uint8_t j = 0; j < 4; j++)
+    {
+        __m128i result = _mm_shuffle_epi8(lane[0], _mm_load_si128(mask + j * 4));
+        for(uint8_t k = 1; k < 4; k++) result = _mm_or_si128(result, _mm_shuffle_epi8(lane[k], _mm_load_si128(mask + j * 4 + k)));
+        _mm_store_si128((__m128i *)(this->facelets + j * 16), result);
+    }
+    #else
+    FaceletCube::permute(this->facelets, move);
+    #endif
+}
+#endif
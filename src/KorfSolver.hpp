@@ -0,0 +1,478 @@
+/**
+ * @author Matrixchung
+ * @brief  Optimal solver: IDA* with pattern databases (Korf, 1997), host only.
+ *
+ * The bound is the max of three tables, KORF_TABLE_BITS per entry (sizes for 4 bits):
+ *  corners : CornerTable.hpp, 3,674,160 entries (~1.8 MB)
+ *  edges   : positions and flips of the first KORF_EDGE_GROUP edges (UB UL UF UR BL FL FR for 7),
+ *            12! / 5! * 2^7 = 510,935,040 entries (~255 MB) for 7, 42,577,920 (~21 MB) for 6
+ *  edges B : the last KORF_EDGE_GROUP edges, read from the same table after a z2 turn of the whole cube,
+ *            which maps them onto the first ones (a rotated cube is as far from solved as the cube)
+ *
+ * Building the 7-edge table takes ~7 minutes on one desktop core, so KorfTables::save() / load() keep it in a file.
+ * load() can put the tables on huge pages (PageMemory.hpp), which takes most TLB misses out of the lookups, and
+ * replicate() copies loaded tables for threads on another NUMA node, called from a thread pinned to that node.
+ * Coordinates are computed from the cubies at each node, as in TwoPhaseSolver.
+ *
+ * With KORF_TABLE_BITS 2 the tables keep the distances mod 3 (Cooperman and Finkelstein), half the memory. One move
+ * changes each distance by at most one, so a child's exact distances follow from its parent's (mod3Distance()), and
+ * the search passes them down its path. Only the first cube needs a walk down to solved, once per solve(). The file
+ * says which encoding it has, and a 4-bit file is packed to 2 bits on loading.
+ *
+ * Nearly every lookup misses the cache, so a node is expanded as a small pipeline: all children are turned and indexed
+ * first, with a prefetch of their three entries each, and only then bounded and searched in move order. The misses of
+ * one node overlap instead of following each other.
+ *
+ * **/
+#ifndef _KORF_SOLVER_HPP
+#define _KORF_SOLVER_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include "CubeModel.hpp"
+#include "CubieCube.hpp"
+#include "TwoPhaseSolver.hpp"
+#include "CornerTable.hpp"
+#include "PageMemory.hpp"
+
+#ifndef KORF_EDGE_GROUP
+#define KORF_EDGE_GROUP 7 // edges per edge table, 6 builds in ~40 s but searches ~2x the nodes
+#endif
+#ifndef KORF_TABLE_BITS
+#define KORF_TABLE_BITS 2 // 4 - distances as they are, 2 - distances mod 3
+#endif
+#define KORF_ENTRIES_PER_BYTE (8 / KORF_TABLE_BITS)
+#define KORF_MAX_LENGTH 20
+#define KORF_FILE_VERSION 1
+#ifndef KORF_PREFETCH
+#define KORF_PREFETCH 1 // 0 - expand nodes the same way without prefetching, for comparison
+#endif
+
+// Where each move takes the edge in a slot, and whether it flips it.
+struct EdgeMoveMap
+{
+    uint8_t slot[18][12];
+    uint8_t flip[18][12];
+    EdgeMoveMap();
+};
+EdgeMoveMap::EdgeMoveMap()
+{
+    for(uint8_t m = 0; m < 18; m++)
+    {
+        CubieCube cube;
+        cube.applyMove((MOVE)m);
+        for(uint8_t s = 0; s < 12; s++)
+        {
+            this->slot[m][cube.ep[s]] = s;
+            this->flip[m][cube.ep[s]] = cube.eo[s];
+        }
+    }
+}
+const static EdgeMoveMap EDGE_MOVE_MAP;
+
+// Table entries of one cube.
+struct KorfIndex
+{
+    uint32_t corners, edgesA, edgesB;
+};
+
+class KorfTables
+{
+    private:
+        NibbleTable corners, edges; // after build() with 4 bits
+        PageBuffer memory; // after load() or replicate(), or build() with 2 bits, both tables
+        const uint8_t *cornerData, *edgeData;
+        uint8_t mirror; // z2, the last edges onto the first ones
+        bool built;
+        static uint32_t _edgeIndex(const uint8_t *slots, const uint8_t *flips);
+        static void _edgeState(uint32_t index, uint8_t *slots, uint8_t *flips);
+        static void _buildEdges(NibbleTable &table);
+        static size_t _cornerBytes() { return (CORNER_TABLE_SIZE + KORF_ENTRIES_PER_BYTE - 1) / KORF_ENTRIES_PER_BYTE; }
+        static size_t _edgeBytes() { return (EDGE_TABLE_SIZE + KORF_ENTRIES_PER_BYTE - 1) / KORF_ENTRIES_PER_BYTE; }
+        bool _pack(const NibbleTable &corners, const NibbleTable &edges, PAGES pages);
+        uint8_t _edgeDistance(const CubieCube &cube, bool last) const;
+    public:
+        const static uint32_t EDGE_TABLE_SIZE;
+        KorfTables();
+        void build();
+        bool save(const char *path) const;
+        bool load(const char *path, PAGES pages = PAGES::NORMAL); // false if missing, or made with another KORF_EDGE_GROUP or with 2 bits for 4
+        bool replicate(const KorfTables &from, PAGES pages = PAGES::NORMAL); // a copy in memory first written by this thread
+        bool isBuilt() const;
+        size_t bytes() const;
+        PAGES getPages() const; // NORMAL after build()
+        size_t getHugeBytes() const;
+        uint8_t bound(const CubieCube &cube) const; // lower bound of moves to solved
+        void distances(const CubieCube &cube, uint8_t *exact) const; // of the corners, edges A and edges B
+        void index(const CubieCube &cube, KorfIndex &index) const;
+        void prefetch(const KorfIndex &index) const;
+        uint8_t bound(const KorfIndex &index, const uint8_t *parent, uint8_t *exact) const; // of a cube one move from parent
+};
+
+class KorfSolver
+{
+    private:
+        const KorfTables &tables;
+        MOVE path[KORF_MAX_LENGTH];
+        uint64_t nodes;
+        bool _search(const CubieCube &cube, const uint8_t *distances, uint8_t depth, uint8_t togo, uint8_t lastFace);
+    public:
+        KorfSolver(const KorfTables &tables);
+        // Writes an optimal solution, returns its length or -1 if it is longer than maxLength.
+        int8_t solve(const CubieCube &cube, MOVE *solution, uint8_t maxLength = KORF_MAX_LENGTH);
+        int8_t solve(const CubeModel &cube, MOVE *solution, uint8_t maxLength = KORF_MAX_LENGTH);
+        uint64_t getNodes() const; // searched by the last solve()
+};
+
+// 12 * 11 * ... * (13 - KORF_EDGE_GROUP) placements, times 2^KORF_EDGE_GROUP flips
+const uint32_t KorfTables::EDGE_TABLE_SIZE = []()
+{
+    uint32_t size = 1u << KORF_EDGE_GROUP;
+    for(uint8_t i = 0; i < KORF_EDGE_GROUP; i++) size *= 12 - i;
+    return size;
+}();
+
+KorfTables::KorfTables()
+{
+    this->built = false;
+    this->cornerData = nullptr;
+    this->edgeData = nullptr;
+    this->mirror = 0;
+    for(uint8_t r = 0; r < ROTATION_COUNT; r++)
+    {
+        if(ROTATION_FACE[r][(uint8_t)FACE::UP] == (uint8_t)FACE::DOWN && ROTATION_FACE[r][(uint8_t)FACE::FRONT] == (uint8_t)FACE::FRONT) this->mirror = r;
+    }
+}
+void KorfTables::build()
+{
+    if(this->built) return;
+    buildCornerTable(this->corners);
+    _buildEdges(this->edges);
+    #if KORF_TABLE_BITS == 2
+    this->built = this->_pack(this->corners, this->edges, PAGES::NORMAL);
+    this->corners = NibbleTable();
+    this->edges = NibbleTable();
+    #else
+    this->cornerData = this->corners.raw();
+    this->edgeData = this->edges.raw();
+    this->built = true;
+    #endif
+}
+// Both 4-bit tables to 2 bits, into memory.
+bool KorfTables::_pack(const NibbleTable &corners, const NibbleTable &edges, PAGES pages)
+{
+    if(!this->memory.allocate(this->bytes(), pages)) return false;
+    this->cornerData = this->memory.raw();
+    this->edgeData = this->cornerData + _cornerBytes();
+    packMod3(corners, CORNER_TABLE_SIZE, this->memory.raw());
+    packMod3(edges, EDGE_TABLE_SIZE, this->memory.raw() + _cornerBytes());
+    return true;
+}
+bool KorfTables::save(const char *path) const
+{
+    if(!this->built) return false;
+    FILE *file = fopen(path, "wb");
+    if(!file) return false;
+    uint8_t header[8] = {'K', 'O', 'R', 'F', KORF_FILE_VERSION, KORF_EDGE_GROUP, KORF_TABLE_BITS, 0};
+    bool ok = fwrite(header, 1, sizeof(header), file) == sizeof(header);
+    ok = ok && fwrite(this->cornerData, 1, _cornerBytes(), file) == _cornerBytes();
+    ok = ok && fwrite(this->edgeData, 1, _edgeBytes(), file) == _edgeBytes();
+    return fclose(file) == 0 && ok;
+}
+bool KorfTables::load(const char *path, PAGES pages)
+{
+    if(this->built) return false;
+    FILE *file = fopen(path, "rb");
+    if(!file) return false;
+    uint8_t header[8] = {0};
+    bool ok = fread(header, 1, sizeof(header), file) == sizeof(header);
+    ok = ok && memcmp(header, "KORF", 4) == 0 && header[4] == KORF_FILE_VERSION && header[5] == KORF_EDGE_GROUP;
+    uint8_t bits = header[6] ? header[6] : 4; // 0 in files from before the encodings
+    if(ok && bits == 4 && KORF_TABLE_BITS == 2)
+    {
+        NibbleTable corners, edges;
+        corners.resize(CORNER_TABLE_SIZE);
+        edges.resize(EDGE_TABLE_SIZE);
+        ok = fread(corners.raw(), 1, corners.bytes(), file) == corners.bytes();
+        ok = ok && fread(edges.raw(), 1, edges.bytes(), file) == edges.bytes();
+        ok = ok && this->_pack(corners, edges, pages);
+    }
+    else
+    {
+        ok = ok && bits == KORF_TABLE_BITS && this->memory.allocate(this->bytes(), pages);
+        ok = ok && fread(this->memory.raw(), 1, this->bytes(), file) == this->bytes();
+        this->cornerData = this->memory.raw();
+        this->edgeData = this->cornerData + _cornerBytes();
+    }
+    fclose(file);
+    if(!ok)
+    {
+        this->memory.free();
+        return false;
+    }
+    this->built = true;
+    return true;
+}
+bool KorfTables::replicate(const KorfTables &from, PAGES pages)
+{
+    if(this->built || !from.built || !this->memory.allocate(this->bytes(), pages)) return false;
+    uint8_t *data = this->memory.raw();
+    memcpy(data, from.cornerData, _cornerBytes());
+    memcpy(data + _cornerBytes(), from.edgeData, _edgeBytes());
+    this->cornerData = data;
+    this->edgeData = data + _cornerBytes();
+    this->built = true;
+    return true;
+}
+bool KorfTables::isBuilt() const
+{
+    return this->built;
+}
+// The same after build() and load(): both tables are rounded up to whole bytes.
+size_t KorfTables::bytes() const
+{
+    return _cornerBytes() + _edgeBytes();
+}
+PAGES KorfTables::getPages() const
+{
+    return this->memory.raw() ? this->memory.getPages() : PAGES::NORMAL;
+}
+size_t KorfTables::getHugeBytes() const
+{
+    return this->memory.getHugeBytes();
+}
+uint8_t KorfTables::bound(const CubieCube &cube) const
+{
+    uint8_t exact[3];
+    this->distances(cube, exact);
+    if(exact[1] > exact[0]) exact[0] = exact[1];
+    return exact[2] > exact[0] ? exact[2] : exact[0];
+}
+void KorfTables::distances(const CubieCube &cube, uint8_t *exact) const
+{
+    #if KORF_TABLE_BITS == 2
+    exact[0] = cornerTableDistance(this->cornerData, cube);
+    exact[1] = this->_edgeDistance(cube, false);
+    exact[2] = this->_edgeDistance(cube, true);
+    #else
+    KorfIndex index;
+    this->index(cube, index);
+    const uint8_t none[3] = {0, 0, 0};
+    this->bound(index, none, exact);
+    #endif
+}
+// As cornerTableDistance(), for the first or the last edges.
+uint8_t KorfTables::_edgeDistance(const CubieCube &cube, bool last) const
+{
+    KorfIndex index;
+    this->index(CubieCube(), index);
+    const uint32_t solved = last ? index.edgesB : index.edgesA;
+    CubieCube current = cube;
+    this->index(current, index);
+    uint8_t distance = 0;
+    while((last ? index.edgesB : index.edgesA) != solved && distance < 14)
+    {
+        uint8_t closer = (mod3Get(this->edgeData, last ? index.edgesB : index.edgesA) + 2) % 3;
+        for(uint8_t m = 0; m < 18; m++)
+        {
+            CubieCube next = current;
+            next.applyMove((MOVE)m);
+            KorfIndex nextIndex;
+            this->index(next, nextIndex);
+            if(mod3Get(this->edgeData, last ? nextIndex.edgesB : nextIndex.edgesA) != closer) continue;
+            current = next;
+            index = nextIndex;
+            break;
+        }
+        distance++;
+    }
+    return distance;
+}
+void KorfTables::index(const CubieCube &cube, KorfIndex &index) const
+{
+    uint8_t slotsA[KORF_EDGE_GROUP], flipsA[KORF_EDGE_GROUP], slotsB[KORF_EDGE_GROUP], flipsB[KORF_EDGE_GROUP];
+    for(uint8_t s = 0; s < 12; s++)
+    {
+        uint8_t e = cube.ep[s];
+        if(e < KORF_EDGE_GROUP)
+        {
+            slotsA[e] = s;
+            flipsA[e] = cube.eo[s];
+        }
+        if(e >= 12 - KORF_EDGE_GROUP)
+        {
+            uint8_t mirrored = ROTATION_EDGE[this->mirror][e];
+            slotsB[mirrored] = ROTATION_EDGE[this->mirror][s];
+            flipsB[mirrored] = cube.eo[s] ^ ROTATION_EDGE_FLIP[this->mirror][s] ^ ROTATION_EDGE_FLIP[this->mirror][e];
+        }
+    }
+    index.corners = cornerTableIndex(cube);
+    index.edgesA = _edgeIndex(slotsA, flipsA);
+    index.edgesB = _edgeIndex(slotsB, flipsB);
+}
+void KorfTables::prefetch(const KorfIndex &index) const
+{
+    __builtin_prefetch(this->cornerData + index.corners / KORF_ENTRIES_PER_BYTE);
+    __builtin_prefetch(this->edgeData + index.edgesA / KORF_ENTRIES_PER_BYTE);
+    __builtin_prefetch(this->edgeData + index.edgesB / KORF_ENTRIES_PER_BYTE);
+}
+uint8_t KorfTables::bound(const KorfIndex &index, const uint8_t *parent, uint8_t *exact) const
+{
+    #if KORF_TABLE_BITS == 2
+    exact[0] = mod3Distance(parent[0], mod3Get(this->cornerData, index.corners));
+    exact[1] = mod3Distance(parent[1], mod3Get(this->edgeData, index.edgesA));
+    exact[2] = mod3Distance(parent[2], mod3Get(this->edgeData, index.edgesB));
+    #else
+    exact[0] = (this->cornerData[index.corners >> 1] >> ((index.corners & 1) << 2)) & 0xF;
+    exact[1] = (this->edgeData[index.edgesA >> 1] >> ((index.edgesA & 1) << 2)) & 0xF;
+    exact[2] = (this->edgeData[index.edgesB >> 1] >> ((index.edgesB & 1) << 2)) & 0xF;
+    #endif
+    uint8_t bound = exact[1] > exact[0] ? exact[1] : exact[0];
+    return exact[2] > bound ? exact[2] : bound;
+}
+// Slots as a partial permutation (mixed radix 12, 11, ...), then the flips as bits.
+uint32_t KorfTables::_edgeIndex(const uint8_t *slots, const uint8_t *flips)
+{
+    uint32_t rank = 0;
+    uint16_t used = 0;
+    uint8_t flipBits = 0;
+    for(uint8_t i = 0; i < KORF_EDGE_GROUP; i++)
+    {
+        rank = rank * (12 - i) + slots[i] - __builtin_popcount(used & ((1u << slots[i]) - 1));
+        used |= 1u << slots[i];
+        flipBits = flipBits << 1 | flips[i];
+    }
+    return rank << KORF_EDGE_GROUP | flipBits;
+}
+void KorfTables::_edgeState(uint32_t index, uint8_t *slots, uint8_t *flips)
+{
+    uint8_t digits[KORF_EDGE_GROUP];
+    for(int8_t i = KORF_EDGE_GROUP - 1; i >= 0; i--)
+    {
+        flips[i] = index & 1;
+        index >>= 1;
+    }
+    for(int8_t i = KORF_EDGE_GROUP - 1; i >= 0; i--)
+    {
+        digits[i] = index % (12 - i);
+        index /= 12 - i;
+    }
+    uint16_t used = 0;
+    for(uint8_t i = 0; i < KORF_EDGE_GROUP; i++)
+    {
+        uint8_t s = 0;
+        for(uint8_t free = digits[i] + 1; ; s++)
+        {
+            if(!(used & (1u << s)) && --free == 0) break;
+        }
+        slots[i] = s;
+        used |= 1u << s;
+    }
+}
+// Breadth-first search one depth at a time, moving the tracked edges only.
+void KorfTables::_buildEdges(NibbleTable &table)
+{
+    table.resize(EDGE_TABLE_SIZE);
+    uint8_t slots[KORF_EDGE_GROUP], flips[KORF_EDGE_GROUP];
+    for(uint8_t i = 0; i < KORF_EDGE_GROUP; i++)
+    {
+        slots[i] = i;
+        flips[i] = 0;
+    }
+    table.set(_edgeIndex(slots, flips), 0);
+    bool found = true;
+    for(uint8_t depth = 0; found && depth < 14; depth++)
+    {
+        found = false;
+        for(uint32_t index = 0; index < EDGE_TABLE_SIZE; index++)
+        {
+            if(table.get(index) != depth) continue;
+            _edgeState(index, slots, flips);
+            for(uint8_t m = 0; m < 18; m++)
+            {
+                uint8_t nextSlots[KORF_EDGE_GROUP], nextFlips[KORF_EDGE_GROUP];
+                for(uint8_t i = 0; i < KORF_EDGE_GROUP; i++)
+                {
+                    nextSlots[i] = EDGE_MOVE_MAP.slot[m][slots[i]];
+                    nextFlips[i] = flips[i] ^ EDGE_MOVE_MAP.flip[m][slots[i]];
+                }
+                uint32_t nextIndex = _edgeIndex(nextSlots, nextFlips);
+                if(table.get(nextIndex) == 0xF)
+                {
+                    table.set(nextIndex, depth + 1);
+                    found = true;
+                }
+            }
+        }
+    }
+}
+
+KorfSolver::KorfSolver(const KorfTables &tables) : tables(tables)
+{
+    this->nodes = 0;
+}
+int8_t KorfSolver::solve(const CubieCube &cube, MOVE *solution, uint8_t maxLength)
+{
+    this->nodes = 0;
+    if(!this->tables.isBuilt()) return -1;
+    if(maxLength > KORF_MAX_LENGTH) maxLength = KORF_MAX_LENGTH;
+    uint8_t distances[3];
+    this->tables.distances(cube, distances);
+    uint8_t bound = distances[1] > distances[0] ? distances[1] : distances[0];
+    for(uint8_t depth = distances[2] > bound ? distances[2] : bound; depth <= maxLength; depth++)
+    {
+        if(!this->_search(cube, distances, 0, depth, (uint8_t)FACE::NONE)) continue;
+        for(uint8_t i = 0; i < depth; i++) solution[i] = this->path[i];
+        return depth;
+    }
+    return -1;
+}
+int8_t KorfSolver::solve(const CubeModel &cube, MOVE *solution, uint8_t maxLength)
+{
+    return this->solve(CubieCube(cube), solution, maxLength);
+}
+uint64_t KorfSolver::getNodes() const
+{
+    return this->nodes;
+}
+// The cube's bound is checked by its parent (or by solve() for the first one), which also passes its exact distances
+// down, and nodes counts every cube turned to.
+bool KorfSolver::_search(const CubieCube &cube, const uint8_t *distances, uint8_t depth, uint8_t togo, uint8_t lastFace)
+{
+    this->nodes++;
+    if(togo == 0) return cube.isSolved();
+    CubieCube children[18];
+    KorfIndex indexes[18];
+    uint8_t moves[18], exact[18][3], count = 0;
+    for(uint8_t face = 0; face < 6; face++)
+    {
+        if(skipAfter(face, lastFace)) continue;
+        for(uint8_t turn = 0; turn < 3; turn++)
+        {
+            moves[count] = face * 3 + turn;
+            children[count] = cube;
+            children[count].applyMove((MOVE)moves[count]);
+            if(togo > 1) // leaves only need isSolved()
+            {
+                this->tables.index(children[count], indexes[count]);
+                #if KORF_PREFETCH
+                this->tables.prefetch(indexes[count]);
+                #endif
+            }
+            count++;
+        }
+    }
+    for(uint8_t i = 0; i < count; i++)
+    {
+        if(togo > 1 && this->tables.bound(indexes[i], distances, exact[i]) > togo - 1)
+        {
+            this->nodes++;
+            continue;
+        }
+        this->path[depth] = (MOVE)moves[i];
+        if(this->_search(children[i], exact[i], depth + 1, togo - 1, moves[i] / 3)) return true;
+    }
+    return false;
+}
+#endif
@@ -0,0 +1,165 @@
+/**
+ * @author Matrixchung
+ * @brief  OLL / PLL case recognition from a last layer fingerprint.
+ *
+ * Once F2L is solved, the last layer is fingerprinted relative to its face, going around FACE_CORNERS / FACE_EDGES of that face:
+ *  OLL: twist of each corner's last layer sticker (base 3) + 81 * flip bits of the edges   -> 0 - 1295
+ *  PLL: rank of the corners' permutation relative to the first one * 24 + rank of the edges' -> 0 - 143
+ * Since the fingerprint only looks at cubies relative to each other around the last layer face, it does not depend on
+ * the cross color (whole cube rotations) nor on the final AUF. The tables are built for every pre-AUF, so one lookup
+ * gives the case and the AUF (U turns to undo before the usual algorithm).
+ *
+ * Table entry: case | (auf << 6), 0xFF - not a last layer state. Case 0 is a skip.
+ * The AUF counts turns of the top face from the first slot of FACE_CORNERS[top], i.e. green top and white front for UP.
+ * OLL cases follow the usual 1 - 57 numbering, PLL cases index PLL_NAMES.
+ * Tables generated by tools/gen_ll_tables.py.
+ *
+ * **/
+#ifndef _LAST_LAYER_HPP
+#define _LAST_LAYER_HPP
+
+#include <cstdint>
+#include "CubeModel.hpp"
+
+#define LL_UNKNOWN 0xFF
+
+const static char *const PLL_NAMES[22] = {"Skip", "Aa", "Ab", "E", "F", "Ga", "Gb", "Gc", "Gd", "H", "Ja", "Jb", "Na", "Nb", "Ra", "Rb", "T", "Ua", "Ub", "V", "Y", "Z"};
+
+const static uint8_t OLL_TABLE[1296] = {
+    0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x57, 0xFF, 0x18, 0xFF, 0xFF, 0xFF, 0x19, 0xFF, 0x9B, 0xFF, 0x97, 0xFF, 0xFF, 0xFF, 0x99, 0xFF, 0x58, 0xFF, 0xFF,
+    0xFF, 0xFF, 0x1A, 0xFF, 0xFF, 0xD8, 0xFF, 0x5B, 0xFF, 0x59, 0xFF, 0xFF, 0xFF, 0x1B, 0xFF, 0xDB, 0xFF, 0xFF, 0xFF, 0xFF, 0x56, 0xD7, 0xFF, 0xFF,
+    0xFF, 0xFF, 0x55, 0xFF, 0x96, 0xFF, 0xFF, 0x17, 0xFF, 0xD9, 0xFF, 0xFF, 0xFF, 0xFF, 0xDA, 0x98, 0xFF, 0xFF, 0xFF, 0xFF, 0x16, 0xFF, 0x15, 0xFF,
+    0xFF, 0xFF, 0x9A, 0xFF, 0xD6, 0xFF, 0x5A, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0x9C, 0xFF, 0xFF, 0xFF, 0xFF, 0xAC, 0xFF, 0xA0, 0xFF, 0xFF, 0xFF, 0xA6, 0xFF, 0x87, 0xFF, 0xA9, 0xFF, 0xFF, 0xFF, 0xE4, 0xFF,
+    0x9E, 0xFF, 0xFF, 0xFF, 0xFF, 0xCC, 0xFF, 0xFF, 0xDF, 0xFF, 0x05, 0xFF, 0x23, 0xFF, 0xFF, 0xFF, 0x8B, 0xFF, 0x4A, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF,
+    0x6A, 0xFF, 0xFF, 0xFF, 0xFF, 0xF5, 0xFF, 0xB0, 0xFF, 0xFF, 0xEB, 0xFF, 0xA5, 0xFF, 0xFF, 0xFF, 0xFF, 0xC6, 0x9D, 0xFF, 0xFF, 0xFF, 0xFF, 0x32,
+    0xFF, 0xB6, 0xFF, 0xFF, 0xFF, 0xC8, 0xFF, 0xF1, 0xFF, 0x89, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x39, 0xFF, 0xFF,
+    0xFF, 0xFF, 0x2D, 0xFF, 0x21, 0xFF, 0xFF, 0xFF, 0xA7, 0xFF, 0x8D, 0xFF, 0xEE, 0xFF, 0xFF, 0xFF, 0x27, 0xFF, 0xA2, 0xFF, 0xFF, 0xFF, 0xFF, 0x10,
+    0xFF, 0xFF, 0x22, 0xFF, 0x8F, 0xFF, 0xA8, 0xFF, 0xFF, 0xFF, 0x0D, 0xFF, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xF4, 0xAD, 0xFF, 0xFF, 0xFF, 0xFF, 0x38,
+    0xFF, 0x33, 0xFF, 0xFF, 0x6E, 0xFF, 0x28, 0xFF, 0xFF, 0xFF, 0xFF, 0x0E, 0xA1, 0xFF, 0xFF, 0xFF, 0xFF, 0xB3, 0xFF, 0x37, 0xFF, 0xFF, 0xFF, 0x90,
+    0xFF, 0x74, 0xFF, 0x8E, 0xFF, 0xFF, 0xDC, 0xFF, 0xFF, 0xFF, 0xFF, 0x2B, 0xFF, 0x1F, 0xFF, 0xFF, 0xFF, 0xE5, 0xFF, 0x45, 0xFF, 0xEC, 0xFF, 0xFF,
+    0xFF, 0x63, 0xFF, 0xE0, 0xFF, 0xFF, 0xFF, 0xFF, 0x06, 0xFF, 0xFF, 0xDD, 0xFF, 0xCB, 0xFF, 0xE6, 0xFF, 0xFF, 0xFF, 0x8A, 0xFF, 0xC7, 0xFF, 0xFF,
+    0xFF, 0xFF, 0x72, 0xE9, 0xFF, 0xFF, 0xFF, 0xFF, 0xF6, 0xFF, 0x2F, 0xFF, 0xFF, 0xAA, 0xFF, 0x24, 0xFF, 0xFF, 0xFF, 0xFF, 0x08, 0xDE, 0xFF, 0xFF,
+    0xFF, 0xFF, 0x31, 0xFF, 0x35, 0xFF, 0xFF, 0xFF, 0xC9, 0xFF, 0xF0, 0xFF, 0x0C, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x5C, 0xFF, 0xFF, 0xFF, 0xFF, 0x69, 0xFF, 0x5E, 0xFF, 0xFF, 0xFF, 0xE3, 0xFF, 0x0A, 0xFF,
+    0x2A, 0xFF, 0xFF, 0xFF, 0x65, 0xFF, 0x5D, 0xFF, 0xFF, 0xFF, 0xFF, 0x49, 0xFF, 0xFF, 0x60, 0xFF, 0x47, 0xFF, 0xA4, 0xFF, 0xFF, 0xFF, 0xC5, 0xFF,
+    0x4B, 0xFF, 0xFF, 0xFF, 0xFF, 0x70, 0xAB, 0xFF, 0xFF, 0xFF, 0xFF, 0x76, 0xFF, 0xB1, 0xFF, 0xFF, 0x6C, 0xFF, 0x66, 0xFF, 0xFF, 0xFF, 0xFF, 0x8C,
+    0x9F, 0xFF, 0xFF, 0xFF, 0xFF, 0xAF, 0xFF, 0xB5, 0xFF, 0xFF, 0xFF, 0x86, 0xFF, 0xF2, 0xFF, 0x88, 0xFF, 0xFF, 0x79, 0xFF, 0xFF, 0xFF, 0xFF, 0xAE,
+    0xFF, 0x62, 0xFF, 0xFF, 0xFF, 0x68, 0xFF, 0xCF, 0xFF, 0x6D, 0xFF, 0xFF, 0xFF, 0xE8, 0xFF, 0x61, 0xFF, 0xFF, 0xFF, 0xFF, 0x4E, 0xFF, 0xFF, 0xE1,
+    0xFF, 0x4D, 0xFF, 0xE7, 0xFF, 0xFF, 0xFF, 0x4F, 0xFF, 0xCD, 0xFF, 0xFF, 0xFF, 0xFF, 0xF3, 0x2E, 0xFF, 0xFF, 0xFF, 0xFF, 0x77, 0xFF, 0x34, 0xFF,
+    0xFF, 0xED, 0xFF, 0x67, 0xFF, 0xFF, 0xFF, 0xFF, 0xD0, 0xE2, 0xFF, 0xFF, 0xFF, 0xFF, 0xB4, 0xFF, 0x78, 0xFF, 0xFF, 0xFF, 0xCE, 0xFF, 0x73, 0xFF,
+    0x50, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x1C, 0xFF, 0xFF, 0xFF, 0xFF, 0xEA, 0xFF, 0x1D, 0xFF, 0xFF, 0xFF, 0x64,
+    0xFF, 0x0B, 0xFF, 0x6B, 0xFF, 0xFF, 0xFF, 0x26, 0xFF, 0x5F, 0xFF, 0xFF, 0xFF, 0xFF, 0x48, 0xFF, 0xFF, 0x1E, 0xFF, 0xCA, 0xFF, 0x25, 0xFF, 0xFF,
+    0xFF, 0x07, 0xFF, 0x85, 0xFF, 0xFF, 0xFF, 0xFF, 0x71, 0x2C, 0xFF, 0xFF, 0xFF, 0xFF, 0x75, 0xFF, 0xB2, 0xFF, 0xFF, 0x29, 0xFF, 0xA3, 0xFF, 0xFF,
+    0xFF, 0xFF, 0x09, 0x20, 0xFF, 0xFF, 0xFF, 0xFF, 0x30, 0xFF, 0x36, 0xFF, 0xFF, 0xFF, 0x4C, 0xFF, 0x6F, 0xFF, 0x46, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x14, 0xFF, 0xFF, 0xFF, 0xFF, 0xD2, 0xFF, 0xD3, 0xFF,
+    0xFF, 0xFF, 0xD1, 0xFF, 0x43, 0xFF, 0x12, 0xFF, 0xFF, 0xFF, 0x51, 0xFF, 0x13, 0xFF, 0xFF, 0xFF, 0xFF, 0x04, 0xFF, 0xFF, 0x93, 0xFF, 0x03, 0xFF,
+    0x11, 0xFF, 0xFF, 0xFF, 0xC3, 0xFF, 0x83, 0xFF, 0xFF, 0xFF, 0xFF, 0x42, 0x52, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0xFF, 0x82, 0xFF, 0xFF, 0x92, 0xFF,
+    0x91, 0xFF, 0xFF, 0xFF, 0xFF, 0xC4, 0x53, 0xFF, 0xFF, 0xFF, 0xFF, 0x02, 0xFF, 0x41, 0xFF, 0xFF, 0xFF, 0x84, 0xFF, 0xC2, 0xFF, 0x44, 0xFF, 0xFF
+};
+const static uint8_t PLL_TABLE[144] = {
+    0x00, 0xFF, 0xFF, 0x11, 0x12, 0xFF, 0xFF, 0x55, 0xD1, 0xFF, 0xFF, 0x91, 0xD2, 0xFF, 0xFF, 0x51, 0x09, 0xFF, 0xFF, 0x92, 0x52, 0xFF, 0xFF, 0x15,
+    0xFF, 0x0B, 0x0F, 0xFF, 0xFF, 0x10, 0x0E, 0xFF, 0xFF, 0x41, 0x06, 0xFF, 0xFF, 0x05, 0x04, 0xFF, 0xFF, 0x08, 0x82, 0xFF, 0xFF, 0xCA, 0x07, 0xFF,
+    0xFF, 0x8A, 0xCB, 0xFF, 0xFF, 0xC4, 0xCF, 0xFF, 0xFF, 0x01, 0xC7, 0xFF, 0xFF, 0xC8, 0xD0, 0xFF, 0xFF, 0xC6, 0x42, 0xFF, 0xFF, 0xCE, 0xC5, 0xFF,
+    0xC2, 0xFF, 0xFF, 0x4B, 0x46, 0xFF, 0xFF, 0x44, 0x4F, 0xFF, 0xFF, 0x4E, 0x48, 0xFF, 0xFF, 0x0A, 0x81, 0xFF, 0xFF, 0x45, 0x47, 0xFF, 0xFF, 0x50,
+    0xC1, 0xFF, 0xFF, 0x85, 0x8B, 0xFF, 0xFF, 0x84, 0x87, 0xFF, 0xFF, 0x86, 0x8F, 0xFF, 0xFF, 0x88, 0x02, 0xFF, 0xFF, 0x8E, 0x4A, 0xFF, 0xFF, 0x90,
+    0xFF, 0x13, 0x54, 0xFF, 0xFF, 0x0C, 0x93, 0xFF, 0xFF, 0x43, 0x53, 0xFF, 0xFF, 0xD3, 0x0D, 0xFF, 0xFF, 0x94, 0x03, 0xFF, 0xFF, 0xD4, 0x14, 0xFF
+};
+
+uint8_t recognizeOll(const CubeModel &cube, FACE top, uint8_t *auf = nullptr); // OLL case 0 - 57, or LL_UNKNOWN
+uint8_t recognizePll(const CubeModel &cube, FACE top, uint8_t *auf = nullptr); // PLL case 0 - 21, or LL_UNKNOWN
+
+// Lehmer code of n distinct small values
+static uint8_t _permutationRank(const uint8_t *perm, uint8_t n)
+{
+    uint8_t rank = 0;
+    for(uint8_t i = 0; i < n; i++)
+    {
+        uint8_t smaller = 0;
+        for(uint8_t j = i + 1; j < n; j++) if(perm[j] < perm[i]) smaller++;
+        rank = rank * (n - i) + smaller;
+    }
+    return rank;
+}
+// Position of slot in the 4-cycle of a face, 4 if it is not on that face.
+static uint8_t _cyclePosition(const uint8_t *cycle, uint8_t slot)
+{
+    uint8_t i = 0;
+    while(i < 4 && cycle[i] != slot) i++;
+    return i;
+}
+uint8_t recognizeOll(const CubeModel &cube, FACE top, uint8_t *auf)
+{
+    const uint8_t *corners = FACE_CORNERS[(uint8_t)top];
+    const uint8_t *edges = FACE_EDGES[(uint8_t)top];
+    uint16_t index = 0;
+    uint8_t base = 1;
+    for(uint8_t i = 0; i < 4; i++)
+    {
+        CubeModel::Cubie cubie = cube.getCorner((CORNER)corners[i]);
+        uint8_t shown = 3, home = 3;
+        for(uint8_t k = 0; k < 3; k++)
+        {
+            if(CORNER_FACES[corners[i]][k] == top) shown = (k + 3 - CubeModel::cornerTwist(cubie.orientation)) % 3;
+            if(CORNER_FACES[cubie.index][k] == top) home = k;
+        }
+        if(home == 3) return LL_UNKNOWN;
+        index += (shown + 3 - home) % 3 * base;
+        base *= 3;
+    }
+    for(uint8_t i = 0; i < 4; i++)
+    {
+        if(_cyclePosition(edges, cube.getEdge((EDGE)edges[i]).index) == 4) return LL_UNKNOWN;
+        if(cube.getEdgeFacing((EDGE)edges[i], top) != top) index += 81 << i;
+    }
+    uint8_t entry = OLL_TABLE[index];
+    if(entry == LL_UNKNOWN) return LL_UNKNOWN;
+    if(auf) *auf = entry >> 6;
+    return entry & 0x3F;
+}
+uint8_t recognizePll(const CubeModel &cube, FACE top, uint8_t *auf)
+{
+    const uint8_t *corners = FACE_CORNERS[(uint8_t)top];
+    const uint8_t *edges = FACE_EDGES[(uint8_t)top];
+    uint8_t cornerPos[4], edgePos[4];
+    for(uint8_t i = 0; i < 4; i++)
+    {
+        cornerPos[i] = _cyclePosition(corners, cube.getCorner((CORNER)corners[i]).index);
+        edgePos[i] = _cyclePosition(edges, cube.getEdge((EDGE)edges[i]).index);
+        if(cornerPos[i] == 4 || edgePos[i] == 4) return LL_UNKNOWN;
+    }
+    for(uint8_t i = 0; i < 4; i++)
+    {
+        edgePos[i] = (edgePos[i] + 4 - cornerPos[0]) % 4;
+        if(i) cornerPos[i] = (cornerPos[i] + 4 - cornerPos[0]) % 4;
+    }
+    uint8_t entry = PLL_TABLE[_permutationRank(cornerPos + 1, 3) * 24 + _permutationRank(edgePos, 4)];
+    if(entry == LL_UNKNOWN) return LL_UNKNOWN;
+    if(auf) *auf = entry >> 6;
+    return entry & 0x3F;
+}
+#endif
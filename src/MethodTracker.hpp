@@ -0,0 +1,356 @@
+/**
+ * @author Matrixchung
+ * @brief  A MethodTracker splits a running solve into the steps of the selected method profile (CFOP, Roux or ZZ).
+ *
+ * A profile is a table of MethodSteps, each naming the cubies it completes in the solver's frame (solvedMask bit layout)
+ * and how they are checked. Adding a method is adding a table to METHOD_PROFILES, the per-move work stays the same:
+ *  CFOP : CfopTracker, unchanged (cross, 4 F2L pairs, OLL, PLL)
+ *  Roux : first block, second block, CMLL, LSE
+ *  ZZ   : EOLine, first block, second block, ZBLL
+ *
+ * With the centers fixed, M moves turn the blocks of a Roux solve away from the centers (M' is R' L as far as the
+ * model goes), so blocks are solved up to a whole-cube rotation. For every cubie the tracker keeps fit[] = the set of
+ * the 24 rotations (RotationTables.hpp) that would bring it where it is, and for every edge slot whether its edge is
+ * oriented on each axis (ZZ's EO). A move refreshes the 8 cubies of the turned face, one table lookup each, and a step
+ * holds if the AND of fit[] over its cubies keeps a rotation it allows: the identity, or any turn about the solver's L-R
+ * axis for Roux. So only the current step is tested, a few ANDs per move.
+ *
+ * The solver's grip (which of the 24 orientations is their U / F) is detected with the first step, like the cross color.
+ * Steps never regress: a split is the first time its predicate held, and skipped steps share the same split.
+ *
+ * **/
+#ifndef _METHOD_TRACKER_HPP
+#define _METHOD_TRACKER_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <strings.h>
+#include "CubeModel.hpp"
+#include "RotationTables.hpp"
+#include "CfopTracker.hpp"
+
+enum class METHOD : uint8_t {CFOP, ROUX, ZZ};
+
+#define METHOD_COUNT     3
+#define METHOD_MAX_STEPS 7
+
+// MethodStep checks
+#define STEP_CFOP         0x01 // done by CfopTracker
+#define STEP_DRIFT        0x02 // the cubies may be turned about the solver's L-R axis (M moves)
+#define STEP_EO           0x04 // and every edge is oriented on the solver's F-B axis
+#define STEP_LAST_CORNERS 0x08 // and the U corners are solved up to AUF, relative to the blocks
+#define STEP_SOLVED       0x10 // the cube is solved
+
+// Cubies in the solver's frame, solvedMask bits
+#define PIECES_LEFT_BLOCK  0x30230 // DL FL BL, DLB DLF
+#define PIECES_RIGHT_BLOCK 0xC08C0 // DR FR BR, DRF DRB
+#define PIECES_LINE        0x00500 // DF DB
+
+struct MethodStep
+{
+    const char *name;
+    uint32_t pieces[2]; // either set of cubies completes the step, 0 - unused
+    uint8_t check;
+};
+struct MethodProfile
+{
+    const char *name;
+    uint8_t stepCount;
+    const MethodStep *steps;
+};
+
+const static MethodStep CFOP_STEPS[] = {
+    {"Cross", {0, 0}, STEP_CFOP},
+    {"F2L 1", {0, 0}, STEP_CFOP},
+    {"F2L 2", {0, 0}, STEP_CFOP},
+    {"F2L 3", {0, 0}, STEP_CFOP},
+    {"F2L 4", {0, 0}, STEP_CFOP},
+    {"OLL",   {0, 0}, STEP_CFOP},
+    {"PLL",   {0, 0}, STEP_CFOP},
+};
+const static MethodStep ROUX_STEPS[] = {
+    {"First block",  {PIECES_LEFT_BLOCK, 0}, STEP_DRIFT},
+    {"Second block", {PIECES_LEFT_BLOCK | PIECES_RIGHT_BLOCK, 0}, STEP_DRIFT},
+    {"CMLL",         {PIECES_LEFT_BLOCK | PIECES_RIGHT_BLOCK, 0}, STEP_DRIFT | STEP_LAST_CORNERS},
+    {"LSE",          {0, 0}, STEP_SOLVED},
+};
+const static MethodStep ZZ_STEPS[] = {
+    {"EOLine",       {PIECES_LINE, 0}, STEP_EO},
+    {"First block",  {PIECES_LINE | PIECES_LEFT_BLOCK, PIECES_LINE | PIECES_RIGHT_BLOCK}, 0},
+    {"Second block", {PIECES_LINE | PIECES_LEFT_BLOCK | PIECES_RIGHT_BLOCK, 0}, 0},
+    {"ZBLL",         {0, 0}, STEP_SOLVED},
+};
+const static MethodProfile METHOD_PROFILES[METHOD_COUNT] = {
+    {"CFOP", 7, CFOP_STEPS},
+    {"Roux", 4, ROUX_STEPS},
+    {"ZZ",   4, ZZ_STEPS},
+};
+
+// Per (slot, cubie, orientation): the rotations that bring the solved cubie there, and the axes its edge is oriented on.
+struct CubieFit
+{
+    uint32_t corner[8][8][3];
+    uint32_t edge[12][12][2];
+    uint8_t edgeAxes[12][12][2]; // bit (min of the axis' two faces), 0 - U-D, 1 - L-R, 2 - F-B
+    uint32_t turning[6];         // the rotations about each face's axis
+    CubieFit();
+};
+CubieFit::CubieFit()
+{
+    memset(this, 0, sizeof(CubieFit));
+    for(uint8_t r = 0; r < ROTATION_COUNT; r++)
+    {
+        for(uint8_t c = 0; c < 8; c++) this->corner[ROTATION_CORNER[r][c]][c][ROTATION_CORNER_TWIST[r][c]] |= 1u << r;
+        for(uint8_t e = 0; e < 12; e++) this->edge[ROTATION_EDGE[r][e]][e][ROTATION_EDGE_FLIP[r][e]] |= 1u << r;
+        for(uint8_t f = 0; f < 6; f++)
+        {
+            if(ROTATION_FACE[r][f] == f) this->turning[f] |= 1u << r;
+        }
+    }
+    // An edge is oriented on an axis if it is after a rotation taking that axis to F-B, where F and B flip edges.
+    for(uint8_t axis = 0; axis < 3; axis++)
+    {
+        uint8_t r = 0;
+        while(ROTATION_FACE[r][axis] != (uint8_t)FACE::FRONT) r++;
+        for(uint8_t s = 0; s < 12; s++)
+        {
+            for(uint8_t e = 0; e < 12; e++)
+            {
+                for(uint8_t flip = 0; flip < 2; flip++)
+                {
+                    if((flip ^ ROTATION_EDGE_FLIP[r][s] ^ ROTATION_EDGE_FLIP[r][e]) == 0) this->edgeAxes[s][e][flip] |= 1u << axis;
+                }
+            }
+        }
+    }
+}
+const static CubieFit CUBIE_FIT;
+
+class MethodTracker
+{
+    private:
+        METHOD method;
+        METHOD nextMethod;
+        CfopTracker cfop;
+        uint8_t step;
+        uint8_t grip;          // the solver's orientation, ROTATION_COUNT until the first step is found
+        uint32_t fit[20];      // solvedMask bit layout
+        uint16_t oriented[3];  // edge slots oriented on each axis
+        uint32_t pieces[2];    // of the current step, in the protocol's frame
+        uint32_t firstPieces[ROTATION_COUNT][2]; // of the first step for every grip, to find the grip
+        uint32_t splits[METHOD_MAX_STEPS];
+        void _updateSlots(const CubeModel &cube, uint8_t face);
+        void _enterStep();
+        bool _holds(const CubeModel &cube, const MethodStep &step, const uint32_t *pieces, uint8_t grip) const;
+        bool _isLastLayerSolved(const CubeModel &cube, uint8_t grip, uint8_t rotation) const;
+        static uint32_t _toProtocol(uint32_t pieces, uint8_t grip);
+        static uint8_t _protocolFace(FACE face, uint8_t grip);
+    public:
+        MethodTracker();
+        void setMethod(METHOD method); // takes effect at the next start()
+        METHOD getMethod() const;
+        const MethodProfile &getProfile() const;
+        void start(const CubeModel &cube); // the first move of a solve is applied, elapsed 0
+        void onMove(const CubeModel &cube, MOVE move, uint32_t elapsed); // elapsed us since the solve started
+        uint8_t getStep() const; // steps done, getProfile().stepCount when solved
+        FACE getBottomFace() const; // the cross face for CFOP, the solver's D otherwise, FACE::NONE if not found yet
+        uint32_t getSplit(uint8_t step) const; // us since the solve started, 0 if not reached yet
+        const CfopTracker &getCfop() const;
+};
+METHOD parseMethod(const char *name); // "cfop", "roux" or "zz", case-insensitive, METHOD_COUNT if unknown
+
+MethodTracker::MethodTracker()
+{
+    this->method = METHOD::CFOP;
+    this->nextMethod = METHOD::CFOP;
+    this->step = 0;
+    this->grip = ROTATION_COUNT;
+    for(uint8_t i = 0; i < METHOD_MAX_STEPS; i++) this->splits[i] = 0;
+}
+void MethodTracker::setMethod(METHOD method)
+{
+    if((uint8_t)method < METHOD_COUNT) this->nextMethod = method;
+}
+METHOD MethodTracker::getMethod() const
+{
+    return this->method;
+}
+const MethodProfile &MethodTracker::getProfile() const
+{
+    return METHOD_PROFILES[(uint8_t)this->method];
+}
+void MethodTracker::start(const CubeModel &cube)
+{
+    if(this->method != this->nextMethod)
+    {
+        this->method = this->nextMethod;
+        const MethodStep &first = this->getProfile().steps[0];
+        for(uint8_t g = 0; g < ROTATION_COUNT; g++)
+        {
+            for(uint8_t i = 0; i < 2; i++) this->firstPieces[g][i] = _toProtocol(first.pieces[i], g);
+        }
+    }
+    this->step = 0;
+    this->grip = ROTATION_COUNT;
+    for(uint8_t i = 0; i < METHOD_MAX_STEPS; i++) this->splits[i] = 0;
+    if(this->method == METHOD::CFOP)
+    {
+        this->cfop.reset();
+        this->cfop.onMove(cube, 0);
+        return;
+    }
+    this->oriented[0] = this->oriented[1] = this->oriented[2] = 0;
+    for(uint8_t f = 0; f < 6; f += 5) this->_updateSlots(cube, f);
+    for(uint8_t i = 4; i < 8; i++)
+    {
+        CubeModel::Cubie edge = cube.getEdge((EDGE)i);
+        uint8_t flip = CubeModel::edgeFlip(edge.orientation);
+        this->fit[edge.index] = CUBIE_FIT.edge[i][edge.index][flip];
+        for(uint8_t axis = 0; axis < 3; axis++)
+        {
+            if(CUBIE_FIT.edgeAxes[i][edge.index][flip] & (1u << axis)) this->oriented[axis] |= 1u << i;
+        }
+    }
+    this->onMove(cube, MOVE::NONE, 0);
+}
+void MethodTracker::onMove(const CubeModel &cube, MOVE move, uint32_t elapsed)
+{
+    if(this->method == METHOD::CFOP)
+    {
+        this->cfop.onMove(cube, elapsed);
+        return;
+    }
+    if(move < MOVE::NONE) this->_updateSlots(cube, (uint8_t)move / 3);
+    const MethodProfile &profile = this->getProfile();
+    while(this->step < profile.stepCount)
+    {
+        const MethodStep &current = profile.steps[this->step];
+        if(this->grip < ROTATION_COUNT)
+        {
+            if(!this->_holds(cube, current, this->pieces, this->grip)) return;
+        }
+        else
+        {
+            uint8_t g = 0;
+            while(g < ROTATION_COUNT && !this->_holds(cube, current, this->firstPieces[g], g)) g++;
+            if(g == ROTATION_COUNT) return;
+            this->grip = g;
+        }
+        this->splits[this->step++] = elapsed;
+        this->_enterStep();
+    }
+}
+uint8_t MethodTracker::getStep() const
+{
+    if(this->method == METHOD::CFOP) return (uint8_t)this->cfop.getStep();
+    return this->step;
+}
+FACE MethodTracker::getBottomFace() const
+{
+    if(this->method == METHOD::CFOP) return this->cfop.getCrossFace();
+    if(this->grip >= ROTATION_COUNT) return FACE::NONE;
+    return (FACE)_protocolFace(FACE::DOWN, this->grip);
+}
+uint32_t MethodTracker::getSplit(uint8_t step) const
+{
+    if(this->method == METHOD::CFOP) return this->cfop.getSplit((CFOP_STEP)step);
+    if(step >= METHOD_MAX_STEPS || step >= this->step) return 0;
+    return this->splits[step];
+}
+const CfopTracker &MethodTracker::getCfop() const
+{
+    return this->cfop;
+}
+// Only the 8 slots of the turned face change, like CubeModel::_updateSolvedMask().
+void MethodTracker::_updateSlots(const CubeModel &cube, uint8_t face)
+{
+    for(uint8_t i = 0; i < 4; i++)
+    {
+        uint8_t s = FACE_CORNERS[face][i];
+        CubeModel::Cubie corner = cube.getCorner((CORNER)s);
+        this->fit[12 + corner.index] = CUBIE_FIT.corner[s][corner.index][CubeModel::cornerTwist(corner.orientation)];
+        s = FACE_EDGES[face][i];
+        CubeModel::Cubie edge = cube.getEdge((EDGE)s);
+        uint8_t flip = CubeModel::edgeFlip(edge.orientation);
+        this->fit[edge.index] = CUBIE_FIT.edge[s][edge.index][flip];
+        for(uint8_t axis = 0; axis < 3; axis++)
+        {
+            if(CUBIE_FIT.edgeAxes[s][edge.index][flip] & (1u << axis)) this->oriented[axis] |= 1u << s;
+            else this->oriented[axis] &= ~(1u << s);
+        }
+    }
+}
+void MethodTracker::_enterStep()
+{
+    const MethodProfile &profile = this->getProfile();
+    if(this->step >= profile.stepCount) return;
+    for(uint8_t i = 0; i < 2; i++) this->pieces[i] = _toProtocol(profile.steps[this->step].pieces[i], this->grip);
+}
+bool MethodTracker::_holds(const CubeModel &cube, const MethodStep &step, const uint32_t *pieces, uint8_t grip) const
+{
+    if(step.check & STEP_SOLVED) return cube.isSolved();
+    if(step.check & STEP_EO)
+    {
+        uint8_t front = _protocolFace(FACE::FRONT, grip);
+        uint8_t back = (uint8_t)OPPOSITE_FACE[front];
+        if(this->oriented[front < back ? front : back] != 0xFFF) return false;
+    }
+    uint32_t allowed = step.check & STEP_DRIFT ? CUBIE_FIT.turning[_protocolFace(FACE::LEFT, grip)] : 1u;
+    for(uint8_t i = 0; i < 2; i++)
+    {
+        if(!pieces[i]) continue;
+        uint32_t rotations = allowed;
+        for(uint32_t rest = pieces[i]; rest && rotations; rest &= rest - 1) rotations &= this->fit[__builtin_ctz(rest)];
+        if(!rotations) continue;
+        if(!(step.check & STEP_LAST_CORNERS)) return true;
+        return this->_isLastLayerSolved(cube, grip, __builtin_ctz(rotations));
+    }
+    return false;
+}
+// The solver's U corners, turned with the blocks, sit on the same face a number of quarter turns from home, oriented.
+bool MethodTracker::_isLastLayerSolved(const CubeModel &cube, uint8_t grip, uint8_t rotation) const
+{
+    uint8_t home = _protocolFace(FACE::UP, grip);
+    uint8_t top = ROTATION_FACE[rotation][home];
+    int8_t offset = -1;
+    for(uint8_t i = 0; i < 4; i++)
+    {
+        uint8_t s = FACE_CORNERS[top][i];
+        if(cube.getCornerFacing((CORNER)s, (FACE)top) != (FACE)home) return false;
+        uint8_t target = ROTATION_CORNER[rotation][cube.getCorner((CORNER)s).index];
+        uint8_t j = 0;
+        while(j < 4 && FACE_CORNERS[top][j] != target) j++;
+        if(j == 4) return false;
+        if(offset < 0) offset = (j + 4 - i) % 4;
+        else if(offset != (j + 4 - i) % 4) return false;
+    }
+    return true;
+}
+// Cubies named in the frame of grip, as protocol cubies.
+uint32_t MethodTracker::_toProtocol(uint32_t pieces, uint8_t grip)
+{
+    uint32_t result = 0;
+    for(uint8_t e = 0; e < 12; e++)
+    {
+        if(pieces & (1u << ROTATION_EDGE[grip][e])) result |= 1u << e;
+    }
+    for(uint8_t c = 0; c < 8; c++)
+    {
+        if(pieces & (1u << (12 + ROTATION_CORNER[grip][c]))) result |= 1u << (12 + c);
+    }
+    return result;
+}
+uint8_t MethodTracker::_protocolFace(FACE face, uint8_t grip)
+{
+    return ROTATION_FACE[ROTATION_INVERSE[grip]][(uint8_t)face];
+}
+
+METHOD parseMethod(const char *name)
+{
+    for(uint8_t m = 0; m < METHOD_COUNT; m++)
+    {
+        if(strcasecmp(name, METHOD_PROFILES[m].name) == 0) return (METHOD)m;
+    }
+    return (METHOD)METHOD_COUNT;
+}
+#endif
@@ -0,0 +1,297 @@
+/**
+ * @author Matrixchung
+ * @brief  Optimal solver for short positions: bidirectional breadth-first search, meeting in the middle. Host only.
+ *
+ * One search grows from the cube, one from solved, always the side with the smaller frontier by one whole depth.
+ * The first state reached from both sides gives an optimal solution: every state within d1 moves of the cube and
+ * d2 of solved is stored by then, so nothing shorter than d1 + d2 + 1 can exist. It needs no tables, but a 14 move
+ * position takes ~10^8 stored states (~1 GB), so this is the mode for training states (F2L, last layer),
+ * not for random ones.
+ *
+ * States are packed into 66 bits: cornerPerm * 2187 + twist (27 bits) above edgePerm / 2 * 2048 + flip (39 bits),
+ * the edge permutation halved since its parity is the corner parity. The visited set is an open addressing hash table
+ * of packed states (9 bytes per slot with the move that reached it, so paths are walked back by undoing moves),
+ * doubled while it stays within the memory cap, together with the frontiers.
+ *
+ * **/
+#ifndef _MITM_SOLVER_HPP
+#define _MITM_SOLVER_HPP
+
+#include <cstdint>
+#include <vector>
+using std::vector;
+#include "CubeModel.hpp"
+#include "CubieCube.hpp"
+#include "TwoPhaseSolver.hpp"
+
+#define MITM_MAX_LENGTH 20
+#define MITM_MEMORY_CAP ((size_t)1 << 30) // bytes for the hash table and the frontiers
+#define MITM_MIN_SLOTS  (1u << 16)
+#define MITM_EMPTY      0xFF
+
+// meta: bits 0 - 1 packed state bits 64 - 65, bit 2 side (1 - from solved), bits 3 - 7 move that reached it
+struct MitmSlot
+{
+    uint64_t low;
+    uint8_t meta;
+} __attribute__((packed));
+
+class MitmSolver
+{
+    private:
+        vector<MitmSlot> slots;
+        vector<uint64_t> frontierKeys[2], nextKeys;
+        vector<uint8_t> frontierMeta[2], nextMeta; // as in the table
+        size_t memoryCap;
+        uint64_t mask, states;
+        uint8_t shift; // 64 - log2(slots), the hash takes the top bits
+        bool outOfMemory;
+        static void _pack(const CubieCube &cube, uint64_t &low, uint8_t &high);
+        static void _unpack(uint64_t low, uint8_t high, CubieCube &cube);
+        static uint32_t _edgeRank(const uint8_t *ep);
+        static void _edgeUnrank(uint32_t rank, uint8_t *ep);
+        uint64_t _hash(uint64_t low, uint8_t high) const;
+        uint64_t _find(uint64_t low, uint8_t high) const; // slot of the state, or the empty slot it would go in
+        bool _insert(uint64_t slot, uint64_t low, uint8_t meta);
+        bool _grow();
+        size_t _frontierBytes() const;
+        bool _expand(uint8_t side, bool lookupOnly, MOVE *solution, uint8_t &length);
+        uint8_t _walk(uint64_t low, uint8_t high, MOVE *moves) const; // moves back to the side's root, last first
+    public:
+        MitmSolver(size_t memoryCap = MITM_MEMORY_CAP);
+        // Writes an optimal solution, returns its length or -1 if it is longer than maxLength or the memory cap was hit.
+        int8_t solve(const CubieCube &cube, MOVE *solution, uint8_t maxLength = MITM_MAX_LENGTH);
+        int8_t solve(const CubeModel &cube, MOVE *solution, uint8_t maxLength = MITM_MAX_LENGTH);
+        uint64_t getStates() const; // stored by the last solve()
+        bool isOutOfMemory() const; // the last solve() stopped at the memory cap
+};
+
+MitmSolver::MitmSolver(size_t memoryCap)
+{
+    this->memoryCap = memoryCap;
+    this->mask = 0;
+    this->shift = 64;
+    this->states = 0;
+    this->outOfMemory = false;
+}
+int8_t MitmSolver::solve(const CubieCube &cube, MOVE *solution, uint8_t maxLength)
+{
+    this->states = 0;
+    this->outOfMemory = false;
+    if(cube.isSolved()) return 0;
+    if(maxLength > MITM_MAX_LENGTH) maxLength = MITM_MAX_LENGTH;
+    // small again, clearing a table grown by a long solve would cost more than a short solve
+    MitmSlot empty = {0, MITM_EMPTY};
+    this->slots.assign(MITM_MIN_SLOTS, empty);
+    this->mask = MITM_MIN_SLOTS - 1;
+    for(this->shift = 64; (1ull << (64 - this->shift)) < MITM_MIN_SLOTS; this->shift--);
+    uint8_t depth[2] = {0, 0};
+    CubieCube roots[2] = {cube, CubieCube()};
+    for(uint8_t side = 0; side < 2; side++)
+    {
+        uint64_t low;
+        uint8_t high;
+        _pack(roots[side], low, high);
+        uint8_t meta = high | side << 2 | (uint8_t)MOVE::NONE << 3;
+        this->_insert(this->_find(low, high), low, meta);
+        this->frontierKeys[side].assign(1, low);
+        this->frontierMeta[side].assign(1, meta);
+    }
+    while(depth[0] + depth[1] < maxLength)
+    {
+        uint8_t side = this->frontierKeys[1].size() < this->frontierKeys[0].size() ? 1 : 0;
+        uint8_t length = 0;
+        // the states of the last depth are only looked up, nothing would search from them
+        bool found = this->_expand(side, depth[0] + depth[1] + 1 == maxLength, solution, length);
+        if(found) return length;
+        if(this->outOfMemory) return -1;
+        depth[side]++;
+    }
+    return -1;
+}
+int8_t MitmSolver::solve(const CubeModel &cube, MOVE *solution, uint8_t maxLength)
+{
+    return this->solve(CubieCube(cube), solution, maxLength);
+}
+uint64_t MitmSolver::getStates() const
+{
+    return this->states;
+}
+bool MitmSolver::isOutOfMemory() const
+{
+    return this->outOfMemory;
+}
+bool MitmSolver::_expand(uint8_t side, bool lookupOnly, MOVE *solution, uint8_t &length)
+{
+    this->nextKeys.clear();
+    this->nextMeta.clear();
+    const vector<uint64_t> &keys = this->frontierKeys[side];
+    const vector<uint8_t> &metas = this->frontierMeta[side];
+    for(size_t i = 0; i < keys.size(); i++)
+    {
+        CubieCube cube;
+        _unpack(keys[i], metas[i] & 3, cube);
+        // all children first, so their slots are fetched while the others are packed
+        uint8_t lastFace = (metas[i] >> 3) / 3, count = 0;
+        uint8_t moves[18], nextHigh[18];
+        uint64_t nextLow[18];
+        for(uint8_t m = 0; m < 18; m++)
+        {
+            // a second turn of the same face reaches a state of a lower depth
+            if(m / 3 == lastFace) continue;
+            CubieCube next = cube;
+            next.applyMove((MOVE)m);
+            _pack(next, nextLow[count], nextHigh[count]);
+            __builtin_prefetch(&this->slots[this->_hash(nextLow[count], nextHigh[count])]);
+            moves[count++] = m;
+        }
+        for(uint8_t k = 0; k < count; k++)
+        {
+            uint64_t slot = this->_find(nextLow[k], nextHigh[k]);
+            uint8_t found = this->slots[slot].meta;
+            if(found != MITM_EMPTY)
+            {
+                if(((found >> 2) & 1) == side) continue;
+                // met: the moves from the cube to the meeting state, then back from there to solved
+                MOVE fromCube[MITM_MAX_LENGTH], fromSolved[MITM_MAX_LENGTH];
+                uint8_t a, b;
+                if(side == 0)
+                {
+                    a = this->_walk(keys[i], metas[i] & 3, fromCube);
+                    fromCube[a] = (MOVE)moves[k];
+                    for(uint8_t j = 0; j < a / 2; j++) swap(fromCube[j], fromCube[a - 1 - j]);
+                    a++;
+                    b = this->_walk(nextLow[k], nextHigh[k], fromSolved);
+                }
+                else
+                {
+                    a = this->_walk(nextLow[k], nextHigh[k], fromCube);
+                    for(uint8_t j = 0; j < a / 2; j++) swap(fromCube[j], fromCube[a - 1 - j]);
+                    fromSolved[0] = (MOVE)moves[k];
+                    b = 1 + this->_walk(keys[i], metas[i] & 3, fromSolved + 1);
+                }
+                for(uint8_t j = 0; j < a; j++) solution[j] = fromCube[j];
+                for(uint8_t j = 0; j < b; j++) solution[a + j] = invertMove(fromSolved[j]);
+                length = a + b;
+                return true;
+            }
+            if(lookupOnly) continue;
+            uint8_t meta = nextHigh[k] | side << 2 | moves[k] << 3;
+            if(!this->_insert(slot, nextLow[k], meta) || this->slots.size() * sizeof(MitmSlot) + this->_frontierBytes() + 9 > this->memoryCap)
+            {
+                this->outOfMemory = true;
+                return false;
+            }
+            this->nextKeys.push_back(nextLow[k]);
+            this->nextMeta.push_back(meta);
+        }
+    }
+    this->frontierKeys[side].swap(this->nextKeys);
+    this->frontierMeta[side].swap(this->nextMeta);
+    return false;
+}
+// Follows the stored moves back to the root of the state's side.
+uint8_t MitmSolver::_walk(uint64_t low, uint8_t high, MOVE *moves) const
+{
+    uint8_t count = 0;
+    CubieCube cube;
+    _unpack(low, high, cube);
+    while(true)
+    {
+        MOVE move = (MOVE)(this->slots[this->_find(low, high)].meta >> 3);
+        if(move >= MOVE::NONE) return count;
+        moves[count++] = move;
+        cube.applyMove(invertMove(move));
+        _pack(cube, low, high);
+    }
+}
+uint64_t MitmSolver::_hash(uint64_t low, uint8_t high) const
+{
+    return ((low ^ (uint64_t)high << 62) * 0x9E3779B97F4A7C15ull) >> this->shift;
+}
+uint64_t MitmSolver::_find(uint64_t low, uint8_t high) const
+{
+    uint64_t slot = this->_hash(low, high);
+    while(this->slots[slot].meta != MITM_EMPTY && (this->slots[slot].low != low || (this->slots[slot].meta & 3) != high)) slot = (slot + 1) & this->mask;
+    return slot;
+}
+// slot from _find(), looked up again if the table grows
+bool MitmSolver::_insert(uint64_t slot, uint64_t low, uint8_t meta)
+{
+    // at most 3/4 full, linear probing slows down beyond
+    if((this->states + 1) * 4 > (this->mask + 1) * 3)
+    {
+        if(!this->_grow()) return false;
+        slot = this->_find(low, meta & 3);
+    }
+    this->slots[slot].low = low;
+    this->slots[slot].meta = meta;
+    this->states++;
+    return true;
+}
+bool MitmSolver::_grow()
+{
+    size_t count = (this->mask + 1) * 2;
+    if(count * sizeof(MitmSlot) + this->_frontierBytes() > this->memoryCap) return false;
+    MitmSlot empty = {0, MITM_EMPTY};
+    vector<MitmSlot> old(count, empty);
+    old.swap(this->slots);
+    this->mask = count - 1;
+    this->shift--;
+    for(size_t i = 0; i < old.size(); i++)
+    {
+        if(old[i].meta == MITM_EMPTY) continue;
+        this->slots[this->_find(old[i].low, old[i].meta & 3)] = old[i];
+    }
+    return true;
+}
+size_t MitmSolver::_frontierBytes() const
+{
+    return (this->frontierKeys[0].size() + this->frontierKeys[1].size() + this->nextKeys.size()) * 9;
+}
+void MitmSolver::_pack(const CubieCube &cube, uint64_t &low, uint8_t &high)
+{
+    uint64_t corners = (uint64_t)cube.getCornerPerm() * TWIST_COUNT + cube.getTwist();
+    uint64_t edges = (uint64_t)(_edgeRank(cube.ep) >> 1) * FLIP_COUNT + cube.getFlip();
+    low = edges | corners << 39;
+    high = corners >> 25;
+}
+void MitmSolver::_unpack(uint64_t low, uint8_t high, CubieCube &cube)
+{
+    uint32_t corners = (uint32_t)(low >> 39) | (uint32_t)high << 25;
+    uint64_t edges = low & ((1ull << 39) - 1);
+    cube.setCornerPerm(corners / TWIST_COUNT);
+    cube.setTwist(corners % TWIST_COUNT);
+    cube.setFlip(edges & 2047);
+    // of the two permutations sharing rank / 2, the one with the corners' parity
+    _edgeUnrank((uint32_t)(edges >> 11) << 1, cube.ep);
+    if(cube.edgeParity() != cube.cornerParity()) swap(cube.ep[10], cube.ep[11]);
+}
+// Lehmer code of the 12 edges, the last two swapped differ by 1
+uint32_t MitmSolver::_edgeRank(const uint8_t *ep)
+{
+    uint32_t rank = 0;
+    for(uint8_t i = 0; i < 12; i++)
+    {
+        uint8_t smaller = 0;
+        for(uint8_t j = i + 1; j < 12; j++) smaller += ep[j] < ep[i];
+        rank = rank * (12 - i) + smaller;
+    }
+    return rank;
+}
+void MitmSolver::_edgeUnrank(uint32_t rank, uint8_t *ep)
+{
+    uint8_t digits[12], available[12];
+    for(int8_t i = 11; i >= 0; i--)
+    {
+        digits[i] = rank % (12 - i);
+        rank /= 12 - i;
+    }
+    for(uint8_t i = 0; i < 12; i++) available[i] = i;
+    for(uint8_t i = 0; i < 12; i++)
+    {
+        ep[i] = available[digits[i]];
+        for(uint8_t j = digits[i]; j + 1 < 12 - i; j++) available[j] = available[j + 1];
+    }
+}
+#endif
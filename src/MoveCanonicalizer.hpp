@@ -0,0 +1,202 @@
+/**
+ * @author Matrixchung
+ * @brief  A MoveCanonicalizer keeps the canonical (simplified) form of a move stream in constant memory.
+ *
+ * Canonical form:
+ *  - no two turns of the same face in a row: R R -> R2, R R R -> R', R R' -> nothing
+ *  - turns of opposite faces commute, they are kept with the lower FACE first: D U -> U D, U D U' -> D
+ * Cancellations cascade (R U U' R' -> nothing) as long as the moves are still in the window.
+ *
+ * Only the last CANON_WINDOW canonical moves are kept in a ring buffer; older ones are committed to the counters.
+ * Entries are addressed by their absolute position since reset(), valid in [getBase(), getEnd()).
+ *
+ * Metrics:
+ *  raw : moves pushed (quarter turns as reported by the cube)
+ *  ETM : raw moves, with consecutive turns of the same face counted once (how they were executed)
+ *  HTM : canonical moves, half turns count 1
+ *  QTM : canonical moves, half turns count 2
+ *
+ * **/
+#ifndef _MOVE_CANONICALIZER_HPP
+#define _MOVE_CANONICALIZER_HPP
+
+#include <cstdint>
+#include "CubeModel.hpp"
+
+#define CANON_WINDOW 64
+
+class MoveCanonicalizer
+{
+    public:
+        struct Entry
+        {
+            MOVE move;
+            uint64_t startTime; // us of the first move merged into this one
+            uint64_t endTime;   // us of the last move merged into this one
+        };
+    private:
+        Entry entries[CANON_WINDOW];
+        uint32_t base;  // absolute position of the oldest kept entry
+        uint32_t count; // kept entries
+        uint32_t rawCount, etmCount;
+        uint32_t committedHtm, committedQtm;
+        uint32_t windowQtm;
+        uint8_t lastRawFace;
+        Entry &_at(uint32_t position) { return this->entries[position % CANON_WINDOW]; }
+        void _push(MOVE move, uint64_t timestamp);
+        void _pop();
+        static uint8_t _qtm(MOVE move) { return moveQuarters(move) == 2 ? 2 : 1; }
+    public:
+        MoveCanonicalizer();
+        void reset();
+        // Returns the lowest absolute position which changed: entries from there up to getEnd() are new or modified.
+        uint32_t push(MOVE move, uint64_t timestamp = 0);
+        uint32_t getBase() const;
+        uint32_t getEnd() const;
+        const Entry &at(uint32_t position) const;
+        uint8_t getTopBlock() const; // 0 - 2 top entries on one axis, which the next move may still change
+        uint32_t getRawCount() const;
+        uint32_t getEtm() const;
+        uint32_t getHtm() const;
+        uint32_t getQtm() const;
+};
+
+static inline bool sameAxis(uint8_t face1, uint8_t face2)
+{
+    return face1 == face2 || (uint8_t)OPPOSITE_FACE[face1] == face2;
+}
+
+MoveCanonicalizer::MoveCanonicalizer()
+{
+    this->reset();
+}
+void MoveCanonicalizer::reset()
+{
+    this->base = 0;
+    this->count = 0;
+    this->rawCount = 0;
+    this->etmCount = 0;
+    this->committedHtm = 0;
+    this->committedQtm = 0;
+    this->windowQtm = 0;
+    this->lastRawFace = 0xFF;
+}
+uint32_t MoveCanonicalizer::push(MOVE move, uint64_t timestamp)
+{
+    if(move >= MOVE::NONE) return this->getEnd();
+    uint8_t face = (uint8_t)move / 3;
+    this->rawCount++;
+    if(face != this->lastRawFace) this->etmCount++;
+    this->lastRawFace = face;
+    uint32_t end = this->getEnd();
+    if(this->count)
+    {
+        Entry &top = this->_at(end - 1);
+        uint8_t topFace = (uint8_t)top.move / 3;
+        if(topFace == face)
+        {
+            MOVE merged = faceMove(face, moveQuarters(top.move) + moveQuarters(move));
+            this->windowQtm -= _qtm(top.move);
+            if(merged == MOVE::NONE) this->count--;
+            else
+            {
+                top.move = merged;
+                top.endTime = timestamp;
+                this->windowQtm += _qtm(merged);
+            }
+            return end - 1;
+        }
+        if(sameAxis(topFace, face))
+        {
+            if(this->count > 1 && (uint8_t)this->_at(end - 2).move / 3 == face)
+            {
+                Entry &second = this->_at(end - 2);
+                MOVE merged = faceMove(face, moveQuarters(second.move) + moveQuarters(move));
+                this->windowQtm -= _qtm(second.move);
+                if(merged == MOVE::NONE)
+                {
+                    second = top;
+                    this->count--;
+                }
+                else
+                {
+                    second.move = merged;
+                    second.endTime = timestamp;
+                    this->windowQtm += _qtm(merged);
+                }
+                return end - 2;
+            }
+            if(face < topFace)
+            {
+                Entry moved = top;
+                this->_pop();
+                this->_push(move, timestamp);
+                this->_push(moved.move, moved.startTime);
+                this->_at(this->getEnd() - 1).endTime = moved.endTime;
+                return this->getEnd() - 2;
+            }
+        }
+    }
+    this->_push(move, timestamp);
+    return this->getEnd() - 1;
+}
+uint32_t MoveCanonicalizer::getBase() const
+{
+    return this->base;
+}
+uint32_t MoveCanonicalizer::getEnd() const
+{
+    return this->base + this->count;
+}
+const MoveCanonicalizer::Entry &MoveCanonicalizer::at(uint32_t position) const
+{
+    return this->entries[position % CANON_WINDOW];
+}
+uint8_t MoveCanonicalizer::getTopBlock() const
+{
+    if(this->count == 0) return 0;
+    uint32_t end = this->getEnd();
+    if(this->count > 1 && sameAxis((uint8_t)this->at(end - 1).move / 3, (uint8_t)this->at(end - 2).move / 3)) return 2;
+    return 1;
+}
+uint32_t MoveCanonicalizer::getRawCount() const
+{
+    return this->rawCount;
+}
+uint32_t MoveCanonicalizer::getEtm() const
+{
+    return this->etmCount;
+}
+uint32_t MoveCanonicalizer::getHtm() const
+{
+    return this->committedHtm + this->count;
+}
+uint32_t MoveCanonicalizer::getQtm() const
+{
+    return this->committedQtm + this->windowQtm;
+}
+void MoveCanonicalizer::_push(MOVE move, uint64_t timestamp)
+{
+    if(this->count == CANON_WINDOW)
+    {
+        // the oldest entry leaves the window for good
+        MOVE oldest = this->_at(this->base).move;
+        this->committedHtm++;
+        this->committedQtm += _qtm(oldest);
+        this->windowQtm -= _qtm(oldest);
+        this->base++;
+        this->count--;
+    }
+    Entry &entry = this->_at(this->getEnd());
+    entry.move = move;
+    entry.startTime = timestamp;
+    entry.endTime = timestamp;
+    this->count++;
+    this->windowQtm += _qtm(move);
+}
+void MoveCanonicalizer::_pop()
+{
+    this->windowQtm -= _qtm(this->_at(this->getEnd() - 1).move);
+    this->count--;
+}
+#endif
@@ -0,0 +1,314 @@
+/**
+ * @author Matrixchung
+ * @brief  MoveEncoder / MoveDecoder compress a timed move stream with an adaptive binary range coder (as in LZMA).
+ *
+ * Moves : the face, as a 3 bit tree of adaptive bits in the context of the previous face, then the turn as
+ *         "half turn?" and "counter-clockwise?" bits in the context of the face, the previous turn and whether the face repeats.
+ *         Small contexts matter more than rich ones here: the model restarts with every solve and has ~60 moves to learn.
+ *         The cube reports quarter turns only, so the half turn bit soon costs next to nothing, and R R' or R U R' U'
+ *         habits show up in the direction bit.
+ * Times : ms since the previous move, Golomb-Rice coded with k adapted to the running mean. The unary part goes
+ *         through adaptive bits, the remainder is stored as is. Quotients from RICE_ESCAPE on (long pauses) escape to
+ *         a 5 bit length and the raw delta. An escaped delta is at least RICE_ESCAPE, so lengths below 5 never occur
+ *         and length 0 stands for 32 bits.
+ *
+ * Both sides update the same model, so a stream is only decodable from its start.
+ * On simulated 50 - 90 move solves (finger trick sequences, 90 - 240 ms between turns) the moves take ~3.8 bits against
+ * log2(18) = 4.17, and the ms times ~9 bits, mostly the jitter itself: ~12.6 bits per move in all, 16 for the varints of SolveLog.
+ *
+ * **/
+#ifndef _MOVE_CODER_HPP
+#define _MOVE_CODER_HPP
+
+#include <cstdint>
+#include "CubeModel.hpp"
+
+#define RC_PROB_BITS  11
+#define RC_ADAPT_BITS 4  // adaptation speed, higher is slower
+#define RC_HALF_TURN_PRIOR 1984 // P(not a half turn) << RC_PROB_BITS, the cube reports quarter turns
+#define RICE_MAX_K    15
+#define RICE_ESCAPE   16 // unary length before escaping to the raw delta
+#define RICE_INITIAL_MEAN 200 // ms
+
+class MoveModel
+{
+    public:
+        uint16_t faceProbs[7][8];     // [previous face or NONE][bit tree node]
+        uint16_t turnProbs[6][4][2][2]; // [face][previous turn or none][face repeats][half turn, counter-clockwise]
+        uint16_t riceProbs[RICE_MAX_K + 1][RICE_ESCAPE];
+        uint8_t previous; // MOVE
+        int32_t mean; // ms << 4
+        void reset();
+        uint8_t riceK() const;
+        void update(MOVE move, uint32_t delta);
+};
+
+class MoveEncoder
+{
+    private:
+        MoveModel model;
+        uint8_t *out;
+        uint16_t capacity, length;
+        bool overflow;
+        bool first; // the first byte of the coder is always 0 and is not written
+        uint64_t low;
+        uint32_t range;
+        uint8_t cache;
+        uint32_t cacheSize;
+        void _shiftLow();
+        void _encodeBit(uint16_t &prob, uint8_t bit);
+        void _encodeDirect(uint32_t value, uint8_t bits);
+    public:
+        MoveEncoder();
+        void begin(uint8_t *out, uint16_t capacity);
+        void encode(MOVE move, uint32_t delta); // delta: ms since the previous move
+        uint16_t finish(); // bytes written, the stream is complete
+        uint16_t size() const; // bytes written so far
+        bool overflowed() const;
+};
+
+class MoveDecoder
+{
+    private:
+        MoveModel model;
+        const uint8_t *in;
+        uint16_t length, position;
+        uint32_t range, code;
+        uint8_t _next();
+        uint8_t _decodeBit(uint16_t &prob);
+        uint32_t _decodeDirect(uint8_t bits);
+    public:
+        MoveDecoder();
+        void begin(const uint8_t *in, uint16_t length);
+        bool decode(MOVE &move, uint32_t &delta); // false if the data is invalid
+};
+
+void MoveModel::reset()
+{
+    for(uint8_t c = 0; c < 7; c++) for(uint8_t i = 0; i < 8; i++) this->faceProbs[c][i] = 1 << (RC_PROB_BITS - 1);
+    for(uint8_t f = 0; f < 6; f++) for(uint8_t t = 0; t < 4; t++) for(uint8_t r = 0; r < 2; r++)
+    {
+        this->turnProbs[f][t][r][0] = RC_HALF_TURN_PRIOR;
+        this->turnProbs[f][t][r][1] = 1 << (RC_PROB_BITS - 1);
+    }
+    for(uint8_t k = 0; k <= RICE_MAX_K; k++) for(uint8_t i = 0; i < RICE_ESCAPE; i++) this->riceProbs[k][i] = 1 << (RC_PROB_BITS - 1);
+    this->previous = (uint8_t)MOVE::NONE;
+    this->mean = RICE_INITIAL_MEAN << 4;
+}
+uint8_t MoveModel::riceK() const
+{
+    uint32_t mean = this->mean >> 4;
+    uint8_t k = 0;
+    while(mean > 1 && k < RICE_MAX_K)
+    {
+        mean >>= 1;
+        k++;
+    }
+    return k;
+}
+void MoveModel::update(MOVE move, uint32_t delta)
+{
+    this->previous = (uint8_t)move;
+    int32_t sample = delta < (1u << 20) ? (int32_t)delta << 4 : 1 << 24;
+    this->mean += (sample - this->mean) >> 3;
+}
+
+MoveEncoder::MoveEncoder()
+{
+    this->begin(nullptr, 0);
+}
+void MoveEncoder::begin(uint8_t *out, uint16_t capacity)
+{
+    this->model.reset();
+    this->out = out;
+    this->capacity = capacity;
+    this->length = 0;
+    this->overflow = false;
+    this->first = true;
+    this->low = 0;
+    this->range = 0xFFFFFFFFu;
+    this->cache = 0;
+    this->cacheSize = 1;
+}
+void MoveEncoder::encode(MOVE move, uint32_t delta)
+{
+    if(move >= MOVE::NONE) return;
+    uint8_t face = (uint8_t)move / 3, turn = (uint8_t)move % 3;
+    uint16_t *probs = this->model.faceProbs[this->model.previous / 3];
+    uint8_t node = 1;
+    for(int8_t b = 2; b >= 0; b--)
+    {
+        uint8_t bit = (face >> b) & 1;
+        this->_encodeBit(probs[node], bit);
+        node = node << 1 | bit;
+    }
+    probs = this->model.turnProbs[face][this->model.previous == (uint8_t)MOVE::NONE ? 3 : this->model.previous % 3][this->model.previous / 3 == face];
+    this->_encodeBit(probs[0], turn == 1);
+    if(turn != 1) this->_encodeBit(probs[1], turn == 2);
+    uint8_t k = this->model.riceK();
+    uint32_t quotient = delta >> k;
+    uint8_t i = 0;
+    for(; i < quotient && i < RICE_ESCAPE; i++) this->_encodeBit(this->model.riceProbs[k][i], 1);
+    if(i < RICE_ESCAPE)
+    {
+        this->_encodeBit(this->model.riceProbs[k][i], 0);
+        this->_encodeDirect(delta, k);
+    }
+    else
+    {
+        uint8_t bits = 0;
+        while(bits < 32 && (delta >> bits)) bits++;
+        this->_encodeDirect(bits & 31, 5);
+        this->_encodeDirect(delta, bits);
+    }
+    this->model.update(move, delta);
+}
+uint16_t MoveEncoder::finish()
+{
+    for(uint8_t i = 0; i < 5; i++) this->_shiftLow();
+    return this->length;
+}
+uint16_t MoveEncoder::size() const
+{
+    return this->length;
+}
+bool MoveEncoder::overflowed() const
+{
+    return this->overflow;
+}
+void MoveEncoder::_shiftLow()
+{
+    if((uint32_t)this->low < 0xFF000000u || (this->low >> 32))
+    {
+        uint8_t carry = this->low >> 32;
+        uint8_t temp = this->cache;
+        do
+        {
+            if(this->first) this->first = false;
+            else if(this->length < this->capacity) this->out[this->length++] = temp + carry;
+            else this->overflow = true;
+            temp = 0xFF;
+        } while(--this->cacheSize);
+        this->cache = (uint8_t)(this->low >> 24);
+    }
+    this->cacheSize++;
+    this->low = (this->low & 0x00FFFFFFu) << 8;
+}
+void MoveEncoder::_encodeBit(uint16_t &prob, uint8_t bit)
+{
+    uint32_t bound = (this->range >> RC_PROB_BITS) * prob;
+    if(!bit)
+    {
+        this->range = bound;
+        prob += ((1 << RC_PROB_BITS) - prob) >> RC_ADAPT_BITS;
+    }
+    else
+    {
+        this->low += bound;
+        this->range -= bound;
+        prob -= prob >> RC_ADAPT_BITS;
+    }
+    while(this->range < (1u << 24))
+    {
+        this->range <<= 8;
+        this->_shiftLow();
+    }
+}
+void MoveEncoder::_encodeDirect(uint32_t value, uint8_t bits)
+{
+    while(bits--)
+    {
+        this->range >>= 1;
+        if((value >> bits) & 1) this->low += this->range;
+        while(this->range < (1u << 24))
+        {
+            this->range <<= 8;
+            this->_shiftLow();
+        }
+    }
+}
+
+MoveDecoder::MoveDecoder()
+{
+    this->begin(nullptr, 0);
+}
+void MoveDecoder::begin(const uint8_t *in, uint16_t length)
+{
+    this->model.reset();
+    this->in = in;
+    this->length = length;
+    this->position = 0;
+    this->range = 0xFFFFFFFFu;
+    this->code = 0;
+    for(uint8_t i = 0; i < 4; i++) this->code = this->code << 8 | this->_next();
+}
+bool MoveDecoder::decode(MOVE &move, uint32_t &delta)
+{
+    uint16_t *probs = this->model.faceProbs[this->model.previous / 3];
+    uint8_t node = 1;
+    for(uint8_t b = 0; b < 3; b++) node = node << 1 | this->_decodeBit(probs[node]);
+    uint8_t face = node - 8;
+    if(face >= 6) return false;
+    probs = this->model.turnProbs[face][this->model.previous == (uint8_t)MOVE::NONE ? 3 : this->model.previous % 3][this->model.previous / 3 == face];
+    uint8_t turn = this->_decodeBit(probs[0]) ? 1 : (this->_decodeBit(probs[1]) ? 2 : 0);
+    move = (MOVE)(face * 3 + turn);
+    uint8_t k = this->model.riceK();
+    uint8_t i = 0;
+    while(i < RICE_ESCAPE && this->_decodeBit(this->model.riceProbs[k][i])) i++;
+    if(i < RICE_ESCAPE) delta = (uint32_t)i << k | this->_decodeDirect(k);
+    else
+    {
+        uint8_t bits = this->_decodeDirect(5);
+        delta = this->_decodeDirect(bits ? bits : 32);
+    }
+    this->model.update(move, delta);
+    return this->position <= this->length + 4;
+}
+uint8_t MoveDecoder::_next()
+{
+    uint8_t byte = this->position < this->length ? this->in[this->position] : 0;
+    this->position++;
+    return byte;
+}
+uint8_t MoveDecoder::_decodeBit(uint16_t &prob)
+{
+    uint32_t bound = (this->range >> RC_PROB_BITS) * prob;
+    uint8_t bit;
+    if(this->code < bound)
+    {
+        this->range = bound;
+        prob += ((1 << RC_PROB_BITS) - prob) >> RC_ADAPT_BITS;
+        bit = 0;
+    }
+    else
+    {
+        this->code -= bound;
+        this->range -= bound;
+        prob -= prob >> RC_ADAPT_BITS;
+        bit = 1;
+    }
+    while(this->range < (1u << 24))
+    {
+        this->range <<= 8;
+        this->code = this->code << 8 | this->_next();
+    }
+    return bit;
+}
+uint32_t MoveDecoder::_decodeDirect(uint8_t bits)
+{
+    uint32_t value = 0;
+    while(bits--)
+    {
+        this->range >>= 1;
+        uint8_t bit = this->code >= this->range;
+        if(bit) this->code -= this->range;
+        value = value << 1 | bit;
+        while(this->range < (1u << 24))
+        {
+            this->range <<= 8;
+            this->code = this->code << 8 | this->_next();
+        }
+    }
+    return value;
+}
+#endif
@@ -0,0 +1,210 @@
+/**
+ * @author Matrixchung
+ * @brief  Host memory for large read-only tables: huge pages, and copies local to each NUMA node. Linux only, host only.
+ *
+ * A 255 MB table on 4 KB pages needs ~65,000 TLB entries, so nearly every random lookup misses the TLB as well as the
+ * cache, and the page walk is another miss. On 2 MB pages it needs ~130 and the walks mostly hit the cache.
+ *  PAGES::NORMAL      : 4 KB pages, with transparent huge pages turned off for the buffer (MADV_NOHUGEPAGE)
+ *  PAGES::TRANSPARENT : 2 MB aligned and MADV_HUGEPAGE, the kernel backs it with huge pages when it has them
+ *                       (/sys/kernel/mm/transparent_hugepage/enabled: always or madvise)
+ *  PAGES::EXPLICIT    : MAP_HUGETLB from the reserved pool (/proc/sys/vm/nr_hugepages), TRANSPARENT if it is too small
+ * getPages() is what the buffer got, and getHugeBytes() how much of it the kernel reports as huge (AnonHugePages).
+ *
+ * Pages are placed on the NUMA node of the thread that first writes them, so a thread pinned with pinToNode() that
+ * allocates and fills a buffer gets a copy on its node. Other targets get plain memory and a single node.
+ *
+ * **/
+#ifndef _PAGE_MEMORY_HPP
+#define _PAGE_MEMORY_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#ifdef __linux__
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+#define HUGE_PAGE_SIZE    (2u << 20)
+#define PAGE_MEMORY_NODES 64 // nodes and CPUs per node looked at
+
+enum class PAGES : uint8_t {NORMAL, TRANSPARENT, EXPLICIT};
+
+class PageBuffer
+{
+    private:
+        uint8_t *data;
+        size_t size, mapped;
+        PAGES pages;
+        PageBuffer(const PageBuffer &);
+        PageBuffer &operator=(const PageBuffer &);
+    public:
+        PageBuffer();
+        ~PageBuffer();
+        bool allocate(size_t size, PAGES pages); // frees the old buffer, false if out of memory
+        void free();
+        uint8_t *raw() { return this->data; }
+        const uint8_t *raw() const { return this->data; }
+        size_t bytes() const { return this->size; }
+        PAGES getPages() const;
+        size_t getHugeBytes() const; // backed by huge pages now, 0 if unknown
+};
+
+const char *pagesName(PAGES pages);
+uint8_t numaNodes(); // online nodes, at least 1
+bool pinToNode(uint8_t node); // the calling thread runs on the node's CPUs only
+
+PageBuffer::PageBuffer()
+{
+    this->data = nullptr;
+    this->size = 0;
+    this->mapped = 0;
+    this->pages = PAGES::NORMAL;
+}
+PageBuffer::~PageBuffer()
+{
+    this->free();
+}
+bool PageBuffer::allocate(size_t size, PAGES pages)
+{
+    this->free();
+    #ifdef __linux__
+    size_t rounded = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    void *memory = MAP_FAILED;
+    if(pages == PAGES::EXPLICIT)
+    {
+        memory = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if(memory != MAP_FAILED) this->mapped = rounded;
+        else pages = PAGES::TRANSPARENT;
+    }
+    if(pages == PAGES::TRANSPARENT)
+    {
+        // one huge page more, to start on a huge page boundary
+        memory = mmap(nullptr, rounded + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(memory == MAP_FAILED) return false;
+        uintptr_t start = ((uintptr_t)memory + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        if(start > (uintptr_t)memory) munmap(memory, start - (uintptr_t)memory);
+        munmap((void *)(start + rounded), (uintptr_t)memory + HUGE_PAGE_SIZE - start);
+        memory = (void *)start;
+        madvise(memory, rounded, MADV_HUGEPAGE);
+        this->mapped = rounded;
+    }
+    if(pages == PAGES::NORMAL)
+    {
+        memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(memory == MAP_FAILED) return false;
+        madvise(memory, size, MADV_NOHUGEPAGE);
+        this->mapped = size;
+    }
+    this->data = (uint8_t *)memory;
+    #else
+    this->data = (uint8_t *)malloc(size ? size : 1);
+    if(!this->data) return false;
+    pages = PAGES::NORMAL;
+    #endif
+    this->size = size;
+    this->pages = pages;
+    return true;
+}
+void PageBuffer::free()
+{
+    if(!this->data) return;
+    #ifdef __linux__
+    munmap(this->data, this->mapped);
+    #else
+    ::free(this->data);
+    #endif
+    this->data = nullptr;
+    this->size = 0;
+    this->mapped = 0;
+}
+PAGES PageBuffer::getPages() const
+{
+    return this->pages;
+}
+// Sums AnonHugePages of the mappings inside the buffer in /proc/self/smaps.
+size_t PageBuffer::getHugeBytes() const
+{
+    size_t huge = 0;
+    #ifdef __linux__
+    if(!this->data) return 0;
+    if(this->pages == PAGES::EXPLICIT) return this->mapped;
+    FILE *file = fopen("/proc/self/smaps", "r");
+    if(!file) return 0;
+    char line[256];
+    bool inside = false;
+    while(fgets(line, sizeof(line), file))
+    {
+        unsigned long long from, to, kb;
+        if(sscanf(line, "%llx-%llx ", &from, &to) == 2)
+        {
+            inside = from >= (uintptr_t)this->data && to <= (uintptr_t)this->data + this->mapped;
+        }
+        else if(inside && sscanf(line, "AnonHugePages: %llu kB", &kb) == 1) huge += kb << 10;
+    }
+    fclose(file);
+    #endif
+    return huge;
+}
+
+const char *pagesName(PAGES pages)
+{
+    static const char *names[3] = {"normal", "transparent", "explicit"};
+    return names[(uint8_t)pages];
+}
+#ifdef __linux__
+// "0-3,8-11" to a mask of at most PAGE_MEMORY_NODES bits per call, from `first` on.
+static uint64_t _parseList(const char *path, uint16_t first)
+{
+    FILE *file = fopen(path, "r");
+    if(!file) return 0;
+    char list[1024];
+    uint64_t mask = 0;
+    if(fgets(list, sizeof(list), file))
+    {
+        for(char *p = list; *p >= '0' && *p <= '9'; )
+        {
+            unsigned long from = strtoul(p, &p, 10), to = from;
+            if(*p == '-') to = strtoul(p + 1, &p, 10);
+            for(unsigned long i = from; i <= to; i++)
+            {
+                if(i >= first && i < first + (unsigned long)PAGE_MEMORY_NODES) mask |= 1ull << (i - first);
+            }
+            if(*p == ',') p++;
+        }
+    }
+    fclose(file);
+    return mask;
+}
+#endif
+uint8_t numaNodes()
+{
+    #ifdef __linux__
+    uint64_t online = _parseList("/sys/devices/system/node/online", 0);
+    if(online) return 64 - __builtin_clzll(online);
+    #endif
+    return 1;
+}
+bool pinToNode(uint8_t node)
+{
+    #ifdef __linux__
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", node);
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for(uint16_t first = 0; first < CPU_SETSIZE; first += PAGE_MEMORY_NODES)
+    {
+        uint64_t mask = _parseList(path, first);
+        for(uint8_t i = 0; i < PAGE_MEMORY_NODES; i++)
+        {
+            if(mask >> i & 1) CPU_SET(first + i, &cpus);
+        }
+    }
+    return CPU_COUNT(&cpus) && sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+    #else
+    return node == 0;
+    #endif
+}
+#endif
@@ -0,0 +1,92 @@
+/**
+ * @author Matrixchung
+ * @brief  PowerStats measures what a power mode costs on the notify path, to choose a mode per deployment.
+ *
+ *  - latency from the BLE callback to the end of decoding, per notify: mean, max and a histogram with log2 buckets
+ *    (bucket i counts [2^i, 2^(i+1)) us), where light sleep shows up as the wake-up and the lower clock after it
+ *  - notifies and time since reset(), so the average power measured outside (a USB power meter, a shunt) gives the
+ *    energy per move: getEnergyPerMove(mW). The cube notifies once per move, and once more on connecting.
+ * The radio side is not included: with modem sleep the controller still wakes for every connection event, so a notify
+ * arrives as late as without it.
+ *
+ * **/
+#ifndef _POWER_STATS_HPP
+#define _POWER_STATS_HPP
+
+#include <cstdint>
+
+#define POWER_STATS_BUCKETS 20 // up to 2^19 us, longer go to the last bucket
+
+class PowerStats
+{
+    private:
+        uint64_t start;
+        uint32_t count;
+        uint64_t latencySum;
+        uint32_t latencyMax;
+        uint32_t histogram[POWER_STATS_BUCKETS];
+    public:
+        PowerStats();
+        void reset(uint64_t now);
+        void onNotify(uint64_t received, uint64_t decoded); // us timestamps
+        uint32_t getCount() const; // notifies
+        uint32_t getLatencyMean() const; // us
+        uint32_t getLatencyMax() const;
+        uint32_t getLatencyPercentile(uint8_t percent) const; // upper end of the bucket it falls in (at most the max), us
+        uint64_t getElapsed(uint64_t now) const; // us since reset()
+        float getEnergyPerMove(uint64_t now, float milliwatts) const; // mJ, 0 without moves
+};
+
+PowerStats::PowerStats()
+{
+    this->reset(0);
+}
+void PowerStats::reset(uint64_t now)
+{
+    this->start = now;
+    this->count = 0;
+    this->latencySum = 0;
+    this->latencyMax = 0;
+    for(uint8_t i = 0; i < POWER_STATS_BUCKETS; i++) this->histogram[i] = 0;
+}
+void PowerStats::onNotify(uint64_t received, uint64_t decoded)
+{
+    uint32_t latency = decoded > received ? (uint32_t)(decoded - received) : 0;
+    uint8_t bucket = 0;
+    for(uint32_t us = latency; us > 1 && bucket < POWER_STATS_BUCKETS - 1; us >>= 1) bucket++;
+    this->histogram[bucket]++;
+    this->latencySum += latency;
+    if(latency > this->latencyMax) this->latencyMax = latency;
+    this->count++;
+}
+uint32_t PowerStats::getCount() const
+{
+    return this->count;
+}
+uint32_t PowerStats::getLatencyMean() const
+{
+    return this->count ? this->latencySum / this->count : 0;
+}
+uint32_t PowerStats::getLatencyMax() const
+{
+    return this->latencyMax;
+}
+uint32_t PowerStats::getLatencyPercentile(uint8_t percent) const
+{
+    uint32_t target = ((uint64_t)this->count * percent + 99) / 100, seen = 0;
+    for(uint8_t i = 0; i < POWER_STATS_BUCKETS - 1; i++)
+    {
+        seen += this->histogram[i];
+        if(seen >= target && seen) return (2u << i) - 1 < this->latencyMax ? (2u << i) - 1 : this->latencyMax;
+    }
+    return this->latencyMax;
+}
+uint64_t PowerStats::getElapsed(uint64_t now) const
+{
+    return now > this->start ? now - this->start : 0;
+}
+float PowerStats::getEnergyPerMove(uint64_t now, float milliwatts) const
+{
+    return this->count ? milliwatts * (this->getElapsed(now) / 1000000.0f) / this->count : 0;
+}
+#endif
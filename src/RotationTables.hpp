@@ -0,0 +1,217 @@
+/**
+ * @author Matrixchung
+ * @brief  Lookup tables of the 24 whole-cube rotations, generated by tools/gen_rotation_tables.py.
+ *
+ * Rotation r = u * 4 + k: the cube is held with the protocol face u up (FACE order), then turned k times by y.
+ * Rotation 0 is the protocol's own orientation, green up and white front.
+ *
+ * ROTATION_FACE[r][f]         : the face where protocol face f is seen
+ * ROTATION_MOVE[r][m]         : protocol move m as seen (MOVE codes, a rotation keeps the turn direction)
+ * ROTATION_CORNER[r][s]       : the slot where corner slot s is seen, ROTATION_EDGE likewise
+ * ROTATION_CORNER_TWIST[r][s] : which sticker of the seen slot its U/D sticker turns into, ROTATION_EDGE_FLIP likewise
+ * ROTATION_INVERSE[r]         : the rotation undoing r
+ * ROTATION_COMPOSE[a][b]      : a, then b as seen after a
+ * ROTATION_OF[up][front]      : the rotation holding these protocol faces up and front, 0xFF if they are not adjacent
+ *
+ * **/
+#ifndef _ROTATION_TABLES_HPP
+#define _ROTATION_TABLES_HPP
+
+#include <cstdint>
+
+#define ROTATION_COUNT 24
+
+constexpr static uint8_t ROTATION_FACE[24][6] = {
+    {0, 1, 2, 3, 4, 5},
+    {0, 4, 1, 2, 3, 5},
+    {0, 3, 4, 1, 2, 5},
+    {0, 2, 3, 4, 1, 5},
+    {3, 0, 2, 5, 4, 1},
+    {2, 0, 1, 5, 3, 4},
+    {1, 0, 4, 5, 2, 3},
+    {4, 0, 3, 5, 1, 2},
+    {4, 1, 0, 3, 5, 2},
+    {3, 4, 0, 2, 5, 1},
+    {2, 3, 0, 1, 5, 4},
+    {1, 2, 0, 4, 5, 3},
+    {1, 5, 2, 0, 4, 3},
+    {4, 5, 1, 0, 3, 2},
+    {3, 5, 4, 0, 2, 1},
+    {2, 5, 3, 0, 1, 4},
+    {2, 1, 5, 3, 0, 4},
+    {1, 4, 5, 2, 0, 3},
+    {4, 3, 5, 1, 0, 2},
+    {3, 2, 5, 4, 0, 1},
+    {5, 1, 4, 3, 2, 0},
+    {5, 4, 3, 2, 1, 0},
+    {5, 3, 2, 1, 4, 0},
+    {5, 2, 1, 4, 3, 0}
+};
+constexpr static uint8_t ROTATION_MOVE[24][18] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17},
+    {0, 1, 2, 12, 13, 14, 3, 4, 5, 6, 7, 8, 9, 10, 11, 15, 16, 17},
+    {0, 1, 2, 9, 10, 11, 12, 13, 14, 3, 4, 5, 6, 7, 8, 15, 16, 17},
+    {0, 1, 2, 6, 7, 8, 9, 10, 11, 12, 13, 14, 3, 4, 5, 15, 16, 17},
+    {9, 10, 11, 0, 1, 2, 6, 7, 8, 15, 16, 17, 12, 13, 14, 3, 4, 5},
+    {6, 7, 8, 0, 1, 2, 3, 4, 5, 15, 16, 17, 9, 10, 11, 12, 13, 14},
+    {3, 4, 5, 0, 1, 2, 12, 13, 14, 15, 16, 17, 6, 7, 8, 9, 10, 11},
+    {12, 13, 14, 0, 1, 2, 9, 10, 11, 15, 16, 17, 3, 4, 5, 6, 7, 8},
+    {12, 13, 14, 3, 4, 5, 0, 1, 2, 9, 10, 11, 15, 16, 17, 6, 7, 8},
+    {9, 10, 11, 12, 13, 14, 0, 1, 2, 6, 7, 8, 15, 16, 17, 3, 4, 5},
+    {6, 7, 8, 9, 10, 11, 0, 1, 2, 3, 4, 5, 15, 16, 17, 12, 13, 14},
+    {3, 4, 5, 6, 7, 8, 0, 1, 2, 12, 13, 14, 15, 16, 17, 9, 10, 11},
+    {3, 4, 5, 15, 16, 17, 6, 7, 8, 0, 1, 2, 12, 13, 14, 9, 10, 11},
+    {12, 13, 14, 15, 16, 17, 3, 4, 5, 0, 1, 2, 9, 10, 11, 6, 7, 8},
+    {9, 10, 11, 15, 16, 17, 12, 13, 14, 0, 1, 2, 6, 7, 8, 3, 4, 5},
+    {6, 7, 8, 15, 16, 17, 9, 10, 11, 0, 1, 2, 3, 4, 5, 12, 13, 14},
+    {6, 7, 8, 3, 4, 5, 15, 16, 17, 9, 10, 11, 0, 1, 2, 12, 13, 14},
+    {3, 4, 5, 12, 13, 14, 15, 16, 17, 6, 7, 8, 0, 1, 2, 9, 10, 11},
+    {12, 13, 14, 9, 10, 11, 15, 16, 17, 3, 4, 5, 0, 1, 2, 6, 7, 8},
+    {9, 10, 11, 6, 7, 8, 15, 16, 17, 12, 13, 14, 0, 1, 2, 3, 4, 5},
+    {15, 16, 17, 3, 4, 5, 12, 13, 14, 9, 10, 11, 6, 7, 8, 0, 1, 2},
+    {15, 16, 17, 12, 13, 14, 9, 10, 11, 6, 7, 8, 3, 4, 5, 0, 1, 2},
+    {15, 16, 17, 9, 10, 11, 6, 7, 8, 3, 4, 5, 12, 13, 14, 0, 1, 2},
+    {15, 16, 17, 6, 7, 8, 3, 4, 5, 12, 13, 14, 9, 10, 11, 0, 1, 2}
+};
+constexpr static uint8_t ROTATION_CORNER[24][8] = {
+    {0, 1, 2, 3, 4, 5, 6, 7},
+    {3, 0, 1, 2, 7, 4, 5, 6},
+    {2, 3, 0, 1, 6, 7, 4, 5},
+    {1, 2, 3, 0, 5, 6, 7, 4},
+    {3, 2, 6, 7, 0, 1, 5, 4},
+    {2, 1, 5, 6, 3, 0, 4, 7},
+    {1, 0, 4, 5, 2, 3, 7, 6},
+    {0, 3, 7, 4, 1, 2, 6, 5},
+    {4, 0, 3, 7, 5, 1, 2, 6},
+    {7, 3, 2, 6, 4, 0, 1, 5},
+    {6, 2, 1, 5, 7, 3, 0, 4},
+    {5, 1, 0, 4, 6, 2, 3, 7},
+    {4, 5, 1, 0, 7, 6, 2, 3},
+    {7, 4, 0, 3, 6, 5, 1, 2},
+    {6, 7, 3, 2, 5, 4, 0, 1},
+    {5, 6, 2, 1, 4, 7, 3, 0},
+    {1, 5, 6, 2, 0, 4, 7, 3},
+    {0, 4, 5, 1, 3, 7, 6, 2},
+    {3, 7, 4, 0, 2, 6, 5, 1},
+    {2, 6, 7, 3, 1, 5, 4, 0},
+    {5, 4, 7, 6, 1, 0, 3, 2},
+    {4, 7, 6, 5, 0, 3, 2, 1},
+    {7, 6, 5, 4, 3, 2, 1, 0},
+    {6, 5, 4, 7, 2, 1, 0, 3}
+};
+constexpr static uint8_t ROTATION_CORNER_TWIST[24][8] = {
+    {0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 0, 0, 0, 0},
+    {2, 1, 2, 1, 1, 2, 1, 2},
+    {2, 1, 2, 1, 1, 2, 1, 2},
+    {2, 1, 2, 1, 1, 2, 1, 2},
+    {2, 1, 2, 1, 1, 2, 1, 2},
+    {1, 2, 1, 2, 2, 1, 2, 1},
+    {1, 2, 1, 2, 2, 1, 2, 1},
+    {1, 2, 1, 2, 2, 1, 2, 1},
+    {1, 2, 1, 2, 2, 1, 2, 1},
+    {2, 1, 2, 1, 1, 2, 1, 2},
+    {2, 1, 2, 1, 1, 2, 1, 2},
+    {2, 1, 2, 1, 1, 2, 1, 2},
+    {2, 1, 2, 1, 1, 2, 1, 2},
+    {1, 2, 1, 2, 2, 1, 2, 1},
+    {1, 2, 1, 2, 2, 1, 2, 1},
+    {1, 2, 1, 2, 2, 1, 2, 1},
+    {1, 2, 1, 2, 2, 1, 2, 1},
+    {0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 0, 0, 0, 0}
+};
+constexpr static uint8_t ROTATION_EDGE[24][12] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11},
+    {3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10},
+    {2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9},
+    {1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8},
+    {7, 3, 6, 11, 0, 2, 10, 8, 4, 1, 5, 9},
+    {6, 2, 5, 10, 3, 1, 9, 11, 7, 0, 4, 8},
+    {5, 1, 4, 9, 2, 0, 8, 10, 6, 3, 7, 11},
+    {4, 0, 7, 8, 1, 3, 11, 9, 5, 2, 6, 10},
+    {8, 4, 0, 7, 9, 1, 3, 11, 10, 5, 2, 6},
+    {11, 7, 3, 6, 8, 0, 2, 10, 9, 4, 1, 5},
+    {10, 6, 2, 5, 11, 3, 1, 9, 8, 7, 0, 4},
+    {9, 5, 1, 4, 10, 2, 0, 8, 11, 6, 3, 7},
+    {4, 9, 5, 1, 8, 10, 2, 0, 7, 11, 6, 3},
+    {7, 8, 4, 0, 11, 9, 1, 3, 6, 10, 5, 2},
+    {6, 11, 7, 3, 10, 8, 0, 2, 5, 9, 4, 1},
+    {5, 10, 6, 2, 9, 11, 3, 1, 4, 8, 7, 0},
+    {2, 5, 10, 6, 1, 9, 11, 3, 0, 4, 8, 7},
+    {1, 4, 9, 5, 0, 8, 10, 2, 3, 7, 11, 6},
+    {0, 7, 8, 4, 3, 11, 9, 1, 2, 6, 10, 5},
+    {3, 6, 11, 7, 2, 10, 8, 0, 1, 5, 9, 4},
+    {10, 9, 8, 11, 5, 4, 7, 6, 2, 1, 0, 3},
+    {9, 8, 11, 10, 4, 7, 6, 5, 1, 0, 3, 2},
+    {8, 11, 10, 9, 7, 6, 5, 4, 0, 3, 2, 1},
+    {11, 10, 9, 8, 6, 5, 4, 7, 3, 2, 1, 0}
+};
+constexpr static uint8_t ROTATION_EDGE_FLIP[24][12] = {
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0},
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0},
+    {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
+    {0, 1, 0, 1, 1, 1, 1, 1, 0, 1, 0, 1},
+    {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
+    {0, 1, 0, 1, 1, 1, 1, 1, 0, 1, 0, 1},
+    {1, 0, 1, 0, 0, 0, 0, 0, 1, 0, 1, 0},
+    {1, 1, 1, 1, 0, 0, 0, 0, 1, 1, 1, 1},
+    {1, 0, 1, 0, 0, 0, 0, 0, 1, 0, 1, 0},
+    {1, 1, 1, 1, 0, 0, 0, 0, 1, 1, 1, 1},
+    {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
+    {0, 1, 0, 1, 1, 1, 1, 1, 0, 1, 0, 1},
+    {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
+    {0, 1, 0, 1, 1, 1, 1, 1, 0, 1, 0, 1},
+    {1, 0, 1, 0, 0, 0, 0, 0, 1, 0, 1, 0},
+    {1, 1, 1, 1, 0, 0, 0, 0, 1, 1, 1, 1},
+    {1, 0, 1, 0, 0, 0, 0, 0, 1, 0, 1, 0},
+    {1, 1, 1, 1, 0, 0, 0, 0, 1, 1, 1, 1},
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0},
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0}
+};
+constexpr static uint8_t ROTATION_INVERSE[24] = {
+    0, 3, 2, 1, 12, 11, 6, 17, 16, 15, 10, 5, 4, 19, 14, 9, 8, 7, 18, 13, 20, 21, 22, 23
+};
+constexpr static uint8_t ROTATION_COMPOSE[24][24] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23},
+    {1, 2, 3, 0, 9, 10, 11, 8, 13, 14, 15, 12, 17, 18, 19, 16, 5, 6, 7, 4, 23, 20, 21, 22},
+    {2, 3, 0, 1, 14, 15, 12, 13, 18, 19, 16, 17, 6, 7, 4, 5, 10, 11, 8, 9, 22, 23, 20, 21},
+    {3, 0, 1, 2, 19, 16, 17, 18, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14, 21, 22, 23, 20},
+    {4, 5, 6, 7, 22, 23, 20, 21, 9, 10, 11, 8, 0, 1, 2, 3, 19, 16, 17, 18, 14, 15, 12, 13},
+    {5, 6, 7, 4, 10, 11, 8, 9, 1, 2, 3, 0, 16, 17, 18, 19, 23, 20, 21, 22, 13, 14, 15, 12},
+    {6, 7, 4, 5, 2, 3, 0, 1, 17, 18, 19, 16, 20, 21, 22, 23, 11, 8, 9, 10, 12, 13, 14, 15},
+    {7, 4, 5, 6, 18, 19, 16, 17, 21, 22, 23, 20, 8, 9, 10, 11, 3, 0, 1, 2, 15, 12, 13, 14},
+    {8, 9, 10, 11, 7, 4, 5, 6, 20, 21, 22, 23, 13, 14, 15, 12, 0, 1, 2, 3, 16, 17, 18, 19},
+    {9, 10, 11, 8, 21, 22, 23, 20, 14, 15, 12, 13, 1, 2, 3, 0, 4, 5, 6, 7, 19, 16, 17, 18},
+    {10, 11, 8, 9, 15, 12, 13, 14, 2, 3, 0, 1, 5, 6, 7, 4, 22, 23, 20, 21, 18, 19, 16, 17},
+    {11, 8, 9, 10, 3, 0, 1, 2, 6, 7, 4, 5, 23, 20, 21, 22, 12, 13, 14, 15, 17, 18, 19, 16},
+    {12, 13, 14, 15, 0, 1, 2, 3, 11, 8, 9, 10, 22, 23, 20, 21, 17, 18, 19, 16, 6, 7, 4, 5},
+    {13, 14, 15, 12, 8, 9, 10, 11, 23, 20, 21, 22, 18, 19, 16, 17, 1, 2, 3, 0, 5, 6, 7, 4},
+    {14, 15, 12, 13, 20, 21, 22, 23, 19, 16, 17, 18, 2, 3, 0, 1, 9, 10, 11, 8, 4, 5, 6, 7},
+    {15, 12, 13, 14, 16, 17, 18, 19, 3, 0, 1, 2, 10, 11, 8, 9, 21, 22, 23, 20, 7, 4, 5, 6},
+    {16, 17, 18, 19, 5, 6, 7, 4, 0, 1, 2, 3, 15, 12, 13, 14, 20, 21, 22, 23, 8, 9, 10, 11},
+    {17, 18, 19, 16, 1, 2, 3, 0, 12, 13, 14, 15, 21, 22, 23, 20, 6, 7, 4, 5, 11, 8, 9, 10},
+    {18, 19, 16, 17, 13, 14, 15, 12, 22, 23, 20, 21, 7, 4, 5, 6, 2, 3, 0, 1, 10, 11, 8, 9},
+    {19, 16, 17, 18, 23, 20, 21, 22, 4, 5, 6, 7, 3, 0, 1, 2, 14, 15, 12, 13, 9, 10, 11, 8},
+    {20, 21, 22, 23, 6, 7, 4, 5, 16, 17, 18, 19, 14, 15, 12, 13, 8, 9, 10, 11, 0, 1, 2, 3},
+    {21, 22, 23, 20, 17, 18, 19, 16, 15, 12, 13, 14, 9, 10, 11, 8, 7, 4, 5, 6, 3, 0, 1, 2},
+    {22, 23, 20, 21, 12, 13, 14, 15, 10, 11, 8, 9, 4, 5, 6, 7, 18, 19, 16, 17, 2, 3, 0, 1},
+    {23, 20, 21, 22, 11, 8, 9, 10, 5, 6, 7, 4, 19, 16, 17, 18, 13, 14, 15, 12, 1, 2, 3, 0}
+};
+constexpr static uint8_t ROTATION_OF[6][6] = {
+    {0xFF, 3, 0, 1, 2, 0xFF},
+    {5, 0xFF, 4, 0xFF, 6, 7},
+    {10, 11, 0xFF, 9, 0xFF, 8},
+    {15, 0xFF, 12, 0xFF, 14, 13},
+    {16, 19, 0xFF, 17, 0xFF, 18},
+    {0xFF, 23, 22, 21, 20, 0xFF}
+};
+#endif
@@ -0,0 +1,107 @@
+/**
+ * @author Matrixchung
+ * @brief  A ScrambleGenerator makes random-state scrambles (as the WCA requires), using a TwoPhaseSolver.
+ *
+ * A state is drawn uniformly from all 4.3 * 10^19 solvable states (random permutations with equal parity, random
+ * orientations with the last corner / edge fixing the sums), solved, and the inverse of the solution is the scramble.
+ * If no solution of maxLength moves turns up within the node budget, the limit is raised by 2 and the same state is
+ * solved again, never a new state, which would bias the distribution towards easy ones. At TWO_PHASE_MAX_LENGTH the
+ * budget is lifted: phase 1 takes at most 12 moves and phase 2 at most 18, so that search always ends with a solution.
+ *
+ * **/
+#ifndef _SCRAMBLE_GENERATOR_HPP
+#define _SCRAMBLE_GENERATOR_HPP
+
+#include <cstdint>
+#include "CubeModel.hpp"
+#include "CubieCube.hpp"
+#include "TwoPhaseSolver.hpp"
+
+#define SCRAMBLE_GEN_MAX_LENGTH 24 // cheapest with the small tables (22 takes ~2x the nodes). The host tool uses 22, ~17 ms per scramble with TWO_PHASE_FULL_TABLES
+
+struct Scramble
+{
+    MOVE moves[TWO_PHASE_MAX_LENGTH];
+    uint8_t length;
+    CubieCube state; // from solved
+    string toString() const;
+};
+
+class ScrambleGenerator
+{
+    public:
+        typedef uint32_t (*Random)();
+    private:
+        TwoPhaseSolver solver;
+        Random random;
+        uint8_t maxLength;
+        uint32_t _below(uint32_t n);
+    public:
+        ScrambleGenerator(const TwoPhaseTables &tables, Random random, uint8_t maxLength = SCRAMBLE_GEN_MAX_LENGTH);
+        CubieCube randomState();
+        bool generate(Scramble &scramble); // false only if the tables are not built
+};
+
+string Scramble::toString() const
+{
+    string result;
+    for(uint8_t i = 0; i < this->length; i++)
+    {
+        if(i) result += ' ';
+        result += moveToString(this->moves[i]);
+    }
+    return result;
+}
+
+ScrambleGenerator::ScrambleGenerator(const TwoPhaseTables &tables, Random random, uint8_t maxLength) : solver(tables)
+{
+    this->random = random;
+    this->maxLength = maxLength;
+}
+// Unbiased, by rejection
+uint32_t ScrambleGenerator::_below(uint32_t n)
+{
+    uint32_t limit = 0xFFFFFFFFu - 0xFFFFFFFFu % n;
+    uint32_t value;
+    do value = this->random(); while(value >= limit);
+    return value % n;
+}
+CubieCube ScrambleGenerator::randomState()
+{
+    CubieCube cube;
+    for(uint8_t i = 7; i > 0; i--)
+    {
+        uint8_t j = this->_below(i + 1);
+        uint8_t temp = cube.cp[i]; cube.cp[i] = cube.cp[j]; cube.cp[j] = temp;
+    }
+    for(uint8_t i = 11; i > 0; i--)
+    {
+        uint8_t j = this->_below(i + 1);
+        uint8_t temp = cube.ep[i]; cube.ep[i] = cube.ep[j]; cube.ep[j] = temp;
+    }
+    // swapping two edges flips the parity, and is a bijection between the halves
+    if(cube.cornerParity() != cube.edgeParity())
+    {
+        uint8_t temp = cube.ep[0]; cube.ep[0] = cube.ep[1]; cube.ep[1] = temp;
+    }
+    cube.setTwist(this->_below(TWIST_COUNT));
+    cube.setFlip(this->_below(FLIP_COUNT));
+    return cube;
+}
+bool ScrambleGenerator::generate(Scramble &scramble)
+{
+    CubieCube state = this->randomState();
+    MOVE solution[TWO_PHASE_MAX_LENGTH];
+    int8_t length = -1;
+    for(uint8_t limit = this->maxLength; length < 0 && limit < TWO_PHASE_MAX_LENGTH; limit += 2)
+    {
+        length = this->solver.solve(state, solution, limit);
+    }
+    if(length < 0) length = this->solver.solve(state, solution, TWO_PHASE_MAX_LENGTH, 0xFFFFFFFFu);
+    if(length < 0) return false;
+    scramble.length = length;
+    for(uint8_t i = 0; i < length; i++) scramble.moves[i] = invertMove(solution[length - 1 - i]);
+    scramble.state = state;
+    return true;
+}
+#endif
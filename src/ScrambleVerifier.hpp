@@ -0,0 +1,235 @@
+/**
+ * @author Matrixchung
+ * @brief  A ScrambleVerifier follows a competitor scrambling the cube and checks each move against the target scramble.
+ *
+ * begin() takes the current cube and the scramble, and precomputes every state along the path (and the halfway states
+ * of half turns, which the cube reports as two quarter turns in either direction). Each move is then one hash lookup:
+ *  ON_PATH   : the cube is in the state after getIndex() scramble moves
+ *  HALF_TURN : halfway through the next move, a half turn
+ *  OFF_PATH  : a wrong move. The shortest correction back to any path state is searched by IDDFS up to
+ *              SCRAMBLE_CORRECTION_DEPTH moves (~4k nodes at depth 3), preferring the state furthest along,
+ *              so "D U" for "U D" is corrected by just "U". Deeper mistakes fall back to undoing the moves since the path.
+ *  DONE      : the cube matches the target state
+ *
+ * **/
+#ifndef _SCRAMBLE_VERIFIER_HPP
+#define _SCRAMBLE_VERIFIER_HPP
+
+#include <cstdint>
+#include "CubeModel.hpp"
+
+#define SCRAMBLE_MAX_MOVES        32
+#define SCRAMBLE_CORRECTION_DEPTH 3
+#define SCRAMBLE_MAX_CORRECTION   16 // longest undo fallback
+
+enum class SCRAMBLE_STATE : uint8_t {IDLE, ON_PATH, HALF_TURN, OFF_PATH, DONE};
+
+class ScrambleVerifier
+{
+    private:
+        MOVE scramble[SCRAMBLE_MAX_MOVES];
+        uint8_t length;
+        uint32_t pathHash[SCRAMBLE_MAX_MOVES + 1]; // state after i moves
+        uint32_t halfHash[SCRAMBLE_MAX_MOVES][2];  // halfway through move i, if it is a half turn
+        CubeModel cube, target;
+        SCRAMBLE_STATE state;
+        uint8_t index;
+        MOVE deviation[SCRAMBLE_MAX_CORRECTION]; // moves since leaving the path, merged per face
+        uint8_t deviationLength;                 // 0xFF - too many to undo
+        MOVE correction[SCRAMBLE_MAX_CORRECTION];
+        uint8_t correctionLength;
+        bool _locate(uint32_t hash, uint8_t &index, SCRAMBLE_STATE &state) const;
+        void _search();
+        void _dfs(const CubeModel &cube, uint8_t depth, uint8_t maxDepth, uint8_t lastFace, MOVE *path, int16_t &bestIndex);
+    public:
+        ScrambleVerifier();
+        bool begin(const CubeModel &start, const char *notation); // false if the scramble is invalid or too long
+        void end();
+        SCRAMBLE_STATE onMove(MOVE move);
+        SCRAMBLE_STATE getState() const;
+        uint8_t getIndex() const;  // scramble moves done
+        uint8_t getLength() const;
+        MOVE getMove(uint8_t index) const;
+        MOVE getNextMove() const;  // MOVE::NONE when done
+        uint8_t getCorrectionLength() const; // 0 if OFF_PATH and lost
+        MOVE getCorrection(uint8_t index) const;
+        const CubeModel &getTarget() const;
+};
+
+ScrambleVerifier::ScrambleVerifier()
+{
+    this->end();
+}
+bool ScrambleVerifier::begin(const CubeModel &start, const char *notation)
+{
+    int16_t count = parseMoves(notation, this->scramble, SCRAMBLE_MAX_MOVES);
+    if(count < 0)
+    {
+        this->end();
+        return false;
+    }
+    this->length = count;
+    this->cube = start;
+    CubeModel path = start;
+    this->pathHash[0] = path.hash();
+    for(uint8_t i = 0; i < this->length; i++)
+    {
+        if(moveQuarters(this->scramble[i]) == 2)
+        {
+            uint8_t face = (uint8_t)this->scramble[i] / 3;
+            for(uint8_t d = 0; d < 2; d++)
+            {
+                CubeModel half = path;
+                half.applyMove(faceMove(face, d ? 3 : 1));
+                this->halfHash[i][d] = half.hash();
+            }
+        }
+        path.applyMove(this->scramble[i]);
+        this->pathHash[i + 1] = path.hash();
+    }
+    this->target = path;
+    this->index = 0;
+    this->state = this->length ? SCRAMBLE_STATE::ON_PATH : SCRAMBLE_STATE::DONE;
+    this->deviationLength = 0;
+    this->correctionLength = 0;
+    return true;
+}
+void ScrambleVerifier::end()
+{
+    this->state = SCRAMBLE_STATE::IDLE;
+    this->length = 0;
+    this->index = 0;
+    this->deviationLength = 0;
+    this->correctionLength = 0;
+}
+SCRAMBLE_STATE ScrambleVerifier::onMove(MOVE move)
+{
+    if(this->state == SCRAMBLE_STATE::IDLE || move >= MOVE::NONE) return this->state;
+    this->cube.applyMove(move);
+    uint8_t index;
+    SCRAMBLE_STATE state;
+    if(this->_locate(this->cube.hash(), index, state))
+    {
+        this->index = index;
+        this->state = state;
+        this->deviationLength = 0;
+        this->correctionLength = 0;
+        return this->state;
+    }
+    // off the path: remember how to get back
+    if(this->deviationLength != 0xFF)
+    {
+        uint8_t face = (uint8_t)move / 3;
+        if(this->deviationLength && (uint8_t)this->deviation[this->deviationLength - 1] / 3 == face)
+        {
+            MOVE merged = faceMove(face, moveQuarters(this->deviation[this->deviationLength - 1]) + moveQuarters(move));
+            if(merged == MOVE::NONE) this->deviationLength--;
+            else this->deviation[this->deviationLength - 1] = merged;
+        }
+        else if(this->deviationLength < SCRAMBLE_MAX_CORRECTION) this->deviation[this->deviationLength++] = move;
+        else this->deviationLength = 0xFF;
+    }
+    this->state = SCRAMBLE_STATE::OFF_PATH;
+    this->_search();
+    return this->state;
+}
+SCRAMBLE_STATE ScrambleVerifier::getState() const
+{
+    return this->state;
+}
+uint8_t ScrambleVerifier::getIndex() const
+{
+    return this->index;
+}
+uint8_t ScrambleVerifier::getLength() const
+{
+    return this->length;
+}
+MOVE ScrambleVerifier::getMove(uint8_t index) const
+{
+    return index < this->length ? this->scramble[index] : MOVE::NONE;
+}
+MOVE ScrambleVerifier::getNextMove() const
+{
+    return this->getMove(this->index);
+}
+uint8_t ScrambleVerifier::getCorrectionLength() const
+{
+    return this->correctionLength;
+}
+MOVE ScrambleVerifier::getCorrection(uint8_t index) const
+{
+    return index < this->correctionLength ? this->correction[index] : MOVE::NONE;
+}
+const CubeModel &ScrambleVerifier::getTarget() const
+{
+    return this->target;
+}
+// The furthest path state with this hash.
+bool ScrambleVerifier::_locate(uint32_t hash, uint8_t &index, SCRAMBLE_STATE &state) const
+{
+    for(int16_t i = this->length; i >= 0; i--)
+    {
+        if(this->pathHash[i] == hash)
+        {
+            index = i;
+            state = i == this->length ? SCRAMBLE_STATE::DONE : SCRAMBLE_STATE::ON_PATH;
+            return true;
+        }
+        if(i < this->length && moveQuarters(this->scramble[i]) == 2 && (this->halfHash[i][0] == hash || this->halfHash[i][1] == hash))
+        {
+            index = i;
+            state = SCRAMBLE_STATE::HALF_TURN;
+            return true;
+        }
+    }
+    return false;
+}
+void ScrambleVerifier::_search()
+{
+    MOVE path[SCRAMBLE_CORRECTION_DEPTH];
+    int16_t bestIndex = -1;
+    for(uint8_t depth = 1; depth <= SCRAMBLE_CORRECTION_DEPTH && bestIndex < 0; depth++)
+    {
+        this->correctionLength = depth;
+        this->_dfs(this->cube, 0, depth, (uint8_t)FACE::NONE, path, bestIndex);
+    }
+    if(bestIndex >= 0) return;
+    // undo
+    if(this->deviationLength == 0xFF)
+    {
+        this->correctionLength = 0;
+        return;
+    }
+    this->correctionLength = this->deviationLength;
+    for(uint8_t i = 0; i < this->deviationLength; i++) this->correction[i] = invertMove(this->deviation[this->deviationLength - 1 - i]);
+}
+// Keeps in correction[] the first sequence of maxDepth moves reaching the furthest path state.
+void ScrambleVerifier::_dfs(const CubeModel &cube, uint8_t depth, uint8_t maxDepth, uint8_t lastFace, MOVE *path, int16_t &bestIndex)
+{
+    for(uint8_t face = 0; face < 6; face++)
+    {
+        if(face == lastFace) continue;
+        if(lastFace < 6 && (uint8_t)OPPOSITE_FACE[lastFace] == face && face < lastFace) continue; // opposite faces in one order only
+        for(uint8_t turn = 0; turn < 3; turn++)
+        {
+            MOVE move = (MOVE)(face * 3 + turn);
+            CubeModel next = cube;
+            next.applyMove(move);
+            path[depth] = move;
+            if(depth + 1 < maxDepth)
+            {
+                this->_dfs(next, depth + 1, maxDepth, face, path, bestIndex);
+                continue;
+            }
+            uint8_t index;
+            SCRAMBLE_STATE state;
+            if(this->_locate(next.hash(), index, state) && state != SCRAMBLE_STATE::HALF_TURN && (int16_t)index > bestIndex)
+            {
+                bestIndex = index;
+                for(uint8_t i = 0; i < maxDepth; i++) this->correction[i] = path[i];
+            }
+        }
+    }
+}
+#endif
@@ -0,0 +1,259 @@
+/**
+ * @author Matrixchung
+ * @brief  Rolling session averages (ao5 / ao12 / ao50 / ao100 / ao1000) and mean, updated in O(log n) per solve.
+ *
+ * An average of N drops the fastest and the slowest ceil(N * 5%) solves and takes the mean of the rest (as cstimer):
+ * ao5 and ao12 drop 1 each side, ao50 3, ao100 5, ao1000 50. If more DNFs than the dropped slowest are in the window,
+ * the average is a DNF.
+ *
+ * Each TrimmedAverage<N> keeps the last N times in a ring buffer and in a treap (order statistic tree) over a fixed
+ * pool of N nodes, with subtree sizes and sums. Adding a solve is one erase and one insert, and the sum of the k
+ * fastest is one descent, all O(log N). Memory is about 30 bytes per slot, ~35 KB for all the averages of SessionStats.
+ *
+ * Times are in us, with the +2 already added. DNF is SOLVE_TIME_DNF.
+ *
+ * **/
+#ifndef _SESSION_STATS_HPP
+#define _SESSION_STATS_HPP
+
+#include <cstdint>
+
+#define SOLVE_TIME_DNF 0xFFFFFFFFu
+#define AVERAGE_NONE 0 // not enough solves yet
+
+template<uint16_t N>
+class TrimmedAverage
+{
+    private:
+        struct Node
+        {
+            uint32_t value;
+            uint32_t priority;
+            uint16_t left, right; // 0 - none
+            uint16_t size;
+            uint64_t sum;
+        };
+        Node nodes[N + 1]; // nodes[0] is the empty tree
+        uint16_t freeNodes[N];
+        uint16_t freeCount;
+        uint16_t root;
+        uint32_t window[N]; // ring buffer of the last N values
+        uint32_t count;
+        uint16_t dnfCount;
+        uint32_t seed;
+        uint32_t best;
+        void _update(uint16_t t);
+        void _split(uint16_t t, uint32_t value, bool orEqual, uint16_t &left, uint16_t &right); // left: < value (<= if orEqual)
+        uint16_t _merge(uint16_t left, uint16_t right);
+        uint64_t _sumSmallest(uint16_t k) const;
+    public:
+        static const uint16_t TRIM = (N * 5 + 99) / 100;
+        TrimmedAverage();
+        void reset();
+        void add(uint32_t time);
+        uint32_t get() const; // us, AVERAGE_NONE before N solves, SOLVE_TIME_DNF if DNF
+        uint32_t getBest() const; // best average seen since reset, AVERAGE_NONE if none
+        uint32_t getCount() const;
+};
+
+template<uint16_t N>
+TrimmedAverage<N>::TrimmedAverage()
+{
+    this->reset();
+}
+template<uint16_t N>
+void TrimmedAverage<N>::reset()
+{
+    this->nodes[0].size = 0;
+    this->nodes[0].sum = 0;
+    this->nodes[0].left = this->nodes[0].right = 0;
+    for(uint16_t i = 0; i < N; i++) this->freeNodes[i] = N - i;
+    this->freeCount = N;
+    this->root = 0;
+    this->count = 0;
+    this->dnfCount = 0;
+    this->seed = 0x9E3779B9u;
+    this->best = AVERAGE_NONE;
+}
+template<uint16_t N>
+void TrimmedAverage<N>::add(uint32_t time)
+{
+    uint16_t left, middle, right;
+    if(this->count >= N)
+    {
+        // erase one node holding the oldest value
+        uint32_t oldest = this->window[this->count % N];
+        if(oldest == SOLVE_TIME_DNF) this->dnfCount--;
+        this->_split(this->root, oldest, false, left, right);
+        this->_split(right, oldest, true, middle, right);
+        this->freeNodes[this->freeCount++] = middle;
+        middle = this->_merge(this->nodes[middle].left, this->nodes[middle].right);
+        this->root = this->_merge(this->_merge(left, middle), right);
+    }
+    this->window[this->count % N] = time;
+    this->count++;
+    if(time == SOLVE_TIME_DNF) this->dnfCount++;
+    uint16_t node = this->freeNodes[--this->freeCount];
+    this->seed ^= this->seed << 13;
+    this->seed ^= this->seed >> 17;
+    this->seed ^= this->seed << 5;
+    this->nodes[node].value = time;
+    this->nodes[node].priority = this->seed;
+    this->nodes[node].left = this->nodes[node].right = 0;
+    this->_update(node);
+    this->_split(this->root, time, false, left, right);
+    this->root = this->_merge(this->_merge(left, node), right);
+    uint32_t average = this->get();
+    if(average != AVERAGE_NONE && (this->best == AVERAGE_NONE || average < this->best)) this->best = average;
+}
+template<uint16_t N>
+uint32_t TrimmedAverage<N>::get() const
+{
+    if(this->count < N) return AVERAGE_NONE;
+    if(this->dnfCount > TRIM) return SOLVE_TIME_DNF;
+    uint64_t middle = this->_sumSmallest(N - TRIM) - this->_sumSmallest(TRIM);
+    return (uint32_t)((middle + (N - 2 * TRIM) / 2) / (N - 2 * TRIM));
+}
+template<uint16_t N>
+uint32_t TrimmedAverage<N>::getBest() const
+{
+    return this->best;
+}
+template<uint16_t N>
+uint32_t TrimmedAverage<N>::getCount() const
+{
+    return this->count;
+}
+template<uint16_t N>
+void TrimmedAverage<N>::_update(uint16_t t)
+{
+    Node &node = this->nodes[t];
+    node.size = 1 + this->nodes[node.left].size + this->nodes[node.right].size;
+    node.sum = node.value + this->nodes[node.left].sum + this->nodes[node.right].sum;
+}
+template<uint16_t N>
+void TrimmedAverage<N>::_split(uint16_t t, uint32_t value, bool orEqual, uint16_t &left, uint16_t &right)
+{
+    if(!t)
+    {
+        left = right = 0;
+        return;
+    }
+    Node &node = this->nodes[t];
+    if(node.value < value || (orEqual && node.value == value))
+    {
+        this->_split(node.right, value, orEqual, node.right, right);
+        left = t;
+    }
+    else
+    {
+        this->_split(node.left, value, orEqual, left, node.left);
+        right = t;
+    }
+    this->_update(t);
+}
+template<uint16_t N>
+uint16_t TrimmedAverage<N>::_merge(uint16_t left, uint16_t right)
+{
+    if(!left || !right) return left ? left : right;
+    if(this->nodes[left].priority > this->nodes[right].priority)
+    {
+        this->nodes[left].right = this->_merge(this->nodes[left].right, right);
+        this->_update(left);
+        return left;
+    }
+    this->nodes[right].left = this->_merge(left, this->nodes[right].left);
+    this->_update(right);
+    return right;
+}
+template<uint16_t N>
+uint64_t TrimmedAverage<N>::_sumSmallest(uint16_t k) const
+{
+    uint64_t sum = 0;
+    uint16_t t = this->root;
+    while(t && k)
+    {
+        const Node &node = this->nodes[t];
+        uint16_t leftSize = this->nodes[node.left].size;
+        if(k <= leftSize) t = node.left;
+        else
+        {
+            sum += this->nodes[node.left].sum + node.value;
+            k -= leftSize + 1;
+            t = node.right;
+        }
+    }
+    return sum;
+}
+
+class SessionStats
+{
+    private:
+        uint32_t solves;
+        uint32_t dnfs;
+        uint64_t total; // of the non-DNF solves
+        uint32_t best;
+    public:
+        TrimmedAverage<5> ao5;
+        TrimmedAverage<12> ao12;
+        TrimmedAverage<50> ao50;
+        TrimmedAverage<100> ao100;
+        TrimmedAverage<1000> ao1000;
+        SessionStats();
+        void reset();
+        void add(uint32_t time); // us with penalty, SOLVE_TIME_DNF for DNF
+        uint32_t getMean() const; // of the non-DNF solves, AVERAGE_NONE if none
+        uint32_t getBest() const;
+        uint32_t getSolves() const;
+        uint32_t getDnfs() const;
+};
+
+SessionStats::SessionStats()
+{
+    this->reset();
+}
+void SessionStats::reset()
+{
+    this->solves = 0;
+    this->dnfs = 0;
+    this->total = 0;
+    this->best = AVERAGE_NONE;
+    this->ao5.reset();
+    this->ao12.reset();
+    this->ao50.reset();
+    this->ao100.reset();
+    this->ao1000.reset();
+}
+void SessionStats::add(uint32_t time)
+{
+    this->solves++;
+    if(time == SOLVE_TIME_DNF) this->dnfs++;
+    else
+    {
+        this->total += time;
+        if(this->best == AVERAGE_NONE || time < this->best) this->best = time;
+    }
+    this->ao5.add(time);
+    this->ao12.add(time);
+    this->ao50.add(time);
+    this->ao100.add(time);
+    this->ao1000.add(time);
+}
+uint32_t SessionStats::getMean() const
+{
+    if(this->solves == this->dnfs) return AVERAGE_NONE;
+    return (uint32_t)(this->total / (this->solves - this->dnfs));
+}
+uint32_t SessionStats::getBest() const
+{
+    return this->best;
+}
+uint32_t SessionStats::getSolves() const
+{
+    return this->solves;
+}
+uint32_t SessionStats::getDnfs() const
+{
+    return this->dnfs;
+}
+#endif
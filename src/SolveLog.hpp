@@ -0,0 +1,526 @@
+/**
+ * @author Matrixchung
+ * @brief  A SolveLog keeps the solve history in flash, in two append-only files on LittleFS.
+ *
+ * solves.log : fixed-size LogRecords, one per solve, so record i is at i * sizeof(LogRecord).
+ * moves.log  : the moves of each solve with their times, range coded by MoveEncoder (~1.6 bytes per move, most of it
+ *              for the ms timing). Logs written before hold varints of (ms since the previous move << 5 | MOVE), ~2 bytes per move.
+ *              It starts with a header holding the logical offset of its first byte, records point at logical offsets.
+ *
+ * Crash safety:
+ *  - each record ends with a CRC-32 of itself, which works as its commit marker: a torn or partial record never verifies
+ *  - moves are written and closed before the records pointing at them
+ *  - begin() drops the invalid tail of solves.log, and the moves after the last valid record
+ *  - compaction writes the kept tail to .tmp files and renames them over the logs, solves first. Offsets are logical,
+ *    so whichever rename a reset interrupts, the records still find their moves.
+ *
+ * Flash writes are batched: records and their moves wait in RAM until SOLVE_LOG_BATCH solves are pending or
+ * no solve came for SOLVE_LOG_FLUSH_US, so nothing is written while solving. Compaction starts above SOLVE_LOG_MAX_RECORDS
+ * and copies SOLVE_LOG_COMPACT_STEP records per maintain() call, so it runs in the background of the idle loop.
+ * The last SOLVE_LOG_INDEX records are also kept in RAM; older ones are one seek away.
+ *
+ * Paths are plain stdio paths under the mount point (LittleFS.begin() mounts at "/littlefs").
+ *
+ * **/
+#ifndef _SOLVE_LOG_HPP
+#define _SOLVE_LOG_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <vector>
+using std::vector;
+#include "CubeModel.hpp"
+#include "SolveTimer.hpp"
+#include "MoveCoder.hpp"
+
+#define SOLVE_LOG_MAGIC        0x474F4C53u // "SLOG"
+#define SOLVE_LOG_MOVES_MAGIC  0x564F4D53u // "SMOV"
+#define SOLVE_LOG_MAX_MOVES    512         // moves kept per solve, more are dropped
+#define SOLVE_LOG_BATCH        8           // solves kept in RAM before a flash write
+#define SOLVE_LOG_BATCH_BYTES  4096        // encoded moves kept in RAM before a flash write
+#define SOLVE_LOG_FLUSH_US     10000000ull // pending solves are written after this long without a new one
+#define SOLVE_LOG_INDEX        16          // most recent records kept in RAM
+#define SOLVE_LOG_MAX_RECORDS  4000        // compaction starts above this
+#define SOLVE_LOG_KEEP_RECORDS 2000        // and keeps the last this many
+#define SOLVE_LOG_COMPACT_STEP 32          // records copied per maintain() call
+
+// LogRecord::moveFormat
+#define SOLVE_LOG_MOVES_VARINT 0 // read only
+#define SOLVE_LOG_MOVES_RANGE  1
+
+struct __attribute__((packed)) LogRecord
+{
+    uint32_t magic;      // SOLVE_LOG_MAGIC
+    uint32_t index;      // solve number since the log was created
+    SolveRecord solve;
+    uint32_t moveOffset; // logical offset of the moves in moves.log
+    uint16_t moveBytes;
+    uint16_t moveCount;  // moves stored, at most SOLVE_LOG_MAX_MOVES
+    uint8_t  moveFormat;
+    uint8_t  reserved[3];
+    uint32_t crc;        // CRC-32 of all the above, written last
+};
+
+struct __attribute__((packed)) MovesHeader
+{
+    uint32_t magic; // SOLVE_LOG_MOVES_MAGIC
+    uint32_t base;  // logical offset of the first byte after the header
+};
+
+static uint32_t crc32Update(const uint8_t *data, size_t length, uint32_t crc = 0)
+{
+    crc = ~crc;
+    for(size_t i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+        for(uint8_t bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320u & (0 - (crc & 1)));
+    }
+    return ~crc;
+}
+
+class SolveLog
+{
+    public:
+        typedef void (*RecordCallback)(const LogRecord &record);
+    private:
+        char solvesPath[48], movesPath[48], solvesTmpPath[48], movesTmpPath[48];
+        bool ready;
+        uint32_t count;     // records in solves.log
+        uint32_t dropped;   // records removed by compaction since begin(), keeps recent[] aligned
+        uint32_t nextIndex;
+        uint32_t moveBase;  // logical offset of the first byte of moves.log
+        uint32_t moveEnd;   // logical end of the moves, pending ones included
+        // solve in progress
+        MOVE moves[SOLVE_LOG_MAX_MOVES];
+        uint32_t moveDeltas[SOLVE_LOG_MAX_MOVES]; // ms since the previous move
+        uint16_t moveCount;
+        uint64_t lastMoveTime;
+        // batch waiting for flash
+        LogRecord pending[SOLVE_LOG_BATCH];
+        uint8_t pendingCount;
+        uint8_t pendingMoves[SOLVE_LOG_BATCH_BYTES];
+        uint16_t pendingMoveBytes;
+        uint64_t lastAppend;
+        LogRecord recent[SOLVE_LOG_INDEX]; // ring, by position in the log
+        // compaction in progress
+        FILE *compactSolves, *compactMoves;
+        uint32_t compactFrom, compactNext; // record positions
+        uint32_t compactWritten;
+        uint32_t compactMoveNext;          // logical offset of the next move byte to copy
+        static bool _isValid(const LogRecord &record);
+        uint16_t _encodeMoves(uint8_t *out, uint16_t capacity) const; // 0 if it does not fit
+        static int16_t _decodeVarint(const uint8_t *data, uint16_t length, MOVE *moves, uint32_t *times, uint16_t max);
+        LogRecord &_recentAt(uint32_t position) { return this->recent[(this->dropped + position) % SOLVE_LOG_INDEX]; }
+        const LogRecord &_recentAt(uint32_t position) const { return this->recent[(this->dropped + position) % SOLVE_LOG_INDEX]; }
+        static long _fileSize(FILE *file);
+        bool _readRecord(FILE *file, uint32_t position, LogRecord &record) const;
+        bool _startCompaction();
+        bool _compactStep();
+        void _abortCompaction();
+    public:
+        SolveLog();
+        bool begin(const char *root = "/littlefs"); // recovers the logs, creates them if missing
+        bool isReady() const;
+        void startSolve(); // call at the start of inspection
+        void onMove(MOVE move, uint64_t timestamp);
+        bool append(const SolveRecord &solve, uint64_t timestamp); // queues the solve with its moves
+        bool flush(); // writes the pending solves now
+        void maintain(uint64_t timestamp); // call when idle: timed flush and compaction steps
+        bool hasWork() const; // maintain() still has a flush or a compaction to do
+        uint32_t size() const; // records in the log, pending ones included
+        bool getRecent(uint32_t back, LogRecord &record) const; // 0 - the last solve
+        uint32_t replay(uint32_t last, RecordCallback callback) const; // calls back the last records, oldest first
+        int16_t readMoves(const LogRecord &record, MOVE *moves, uint32_t *times, uint16_t max) const; // times: ms since the first move, -1 if unavailable
+        bool readMoveData(const LogRecord &record, uint8_t *data) const; // the moveBytes encoded bytes, as stored
+        bool isCompacting() const;
+};
+
+SolveLog::SolveLog()
+{
+    this->ready = false;
+    this->count = 0;
+    this->dropped = 0;
+    this->nextIndex = 0;
+    this->moveBase = 0;
+    this->moveEnd = 0;
+    this->moveCount = 0;
+    this->lastMoveTime = 0;
+    this->pendingCount = 0;
+    this->pendingMoveBytes = 0;
+    this->lastAppend = 0;
+    this->compactSolves = nullptr;
+    this->compactMoves = nullptr;
+}
+bool SolveLog::begin(const char *root)
+{
+    snprintf(this->solvesPath, sizeof(this->solvesPath), "%s/solves.log", root);
+    snprintf(this->movesPath, sizeof(this->movesPath), "%s/moves.log", root);
+    snprintf(this->solvesTmpPath, sizeof(this->solvesTmpPath), "%s/solves.tmp", root);
+    snprintf(this->movesTmpPath, sizeof(this->movesTmpPath), "%s/moves.tmp", root);
+    this->ready = false;
+    this->count = 0;
+    this->pendingCount = 0;
+    this->pendingMoveBytes = 0;
+    // an unfinished compaction is dropped, the logs are still complete
+    remove(this->solvesTmpPath);
+    remove(this->movesTmpPath);
+    LogRecord last;
+    FILE *file = fopen(this->solvesPath, "rb");
+    if(file)
+    {
+        long fileSize = _fileSize(file);
+        uint32_t valid = fileSize / sizeof(LogRecord);
+        while(valid && !this->_readRecord(file, valid - 1, last)) valid--;
+        fclose(file);
+        if(fileSize != (long)(valid * sizeof(LogRecord)) && truncate(this->solvesPath, valid * sizeof(LogRecord)) != 0) return false;
+        this->count = valid;
+    }
+    else
+    {
+        file = fopen(this->solvesPath, "wb");
+        if(!file) return false;
+        fclose(file);
+    }
+    this->nextIndex = this->count ? last.index + 1 : 0;
+    uint32_t recordEnd = this->count ? last.moveOffset + last.moveBytes : 0;
+    MovesHeader header;
+    long moveFileSize = 0;
+    file = fopen(this->movesPath, "rb");
+    if(file)
+    {
+        if(fread(&header, sizeof(header), 1, file) == 1 && header.magic == SOLVE_LOG_MOVES_MAGIC) moveFileSize = _fileSize(file);
+        fclose(file);
+    }
+    if(moveFileSize < (long)sizeof(header))
+    {
+        // missing or broken: a new moves file starts after the last record, older records lose their moves
+        header.magic = SOLVE_LOG_MOVES_MAGIC;
+        header.base = recordEnd;
+        file = fopen(this->movesPath, "wb");
+        if(!file) return false;
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+        ok = (fclose(file) == 0) && ok;
+        if(!ok) return false;
+        moveFileSize = sizeof(header);
+    }
+    this->moveBase = header.base;
+    this->moveEnd = this->moveBase + moveFileSize - sizeof(header);
+    if(this->count && recordEnd >= this->moveBase && recordEnd < this->moveEnd)
+    {
+        // moves of a solve whose record never made it
+        if(truncate(this->movesPath, recordEnd - this->moveBase + sizeof(header)) != 0) return false;
+        this->moveEnd = recordEnd;
+    }
+    // fill the recent index
+    uint32_t first = this->count > SOLVE_LOG_INDEX ? this->count - SOLVE_LOG_INDEX : 0;
+    file = fopen(this->solvesPath, "rb");
+    if(!file) return false;
+    for(uint32_t p = first; p < this->count; p++)
+    {
+        if(!this->_readRecord(file, p, this->_recentAt(p))) memset(&this->_recentAt(p), 0, sizeof(LogRecord));
+    }
+    fclose(file);
+    this->ready = true;
+    return true;
+}
+bool SolveLog::isReady() const
+{
+    return this->ready;
+}
+void SolveLog::startSolve()
+{
+    this->moveCount = 0;
+}
+void SolveLog::onMove(MOVE move, uint64_t timestamp)
+{
+    if(move >= MOVE::NONE || this->moveCount >= SOLVE_LOG_MAX_MOVES) return;
+    this->moves[this->moveCount] = move;
+    this->moveDeltas[this->moveCount] = this->moveCount && timestamp > this->lastMoveTime ? (uint32_t)((timestamp - this->lastMoveTime) / 1000) : 0;
+    this->lastMoveTime = timestamp;
+    this->moveCount++;
+}
+bool SolveLog::append(const SolveRecord &solve, uint64_t timestamp)
+{
+    if(!this->ready) return false;
+    if(this->pendingCount == SOLVE_LOG_BATCH && !this->flush()) return false;
+    uint16_t bytes = this->_encodeMoves(this->pendingMoves + this->pendingMoveBytes, SOLVE_LOG_BATCH_BYTES - this->pendingMoveBytes);
+    if(!bytes && this->moveCount && this->pendingMoveBytes)
+    {
+        // does not fit behind the batch, try again in an empty buffer
+        if(!this->flush()) return false;
+        bytes = this->_encodeMoves(this->pendingMoves, SOLVE_LOG_BATCH_BYTES);
+    }
+    if(!bytes) this->moveCount = 0; // the record is kept without its moves
+    LogRecord &record = this->pending[this->pendingCount];
+    memset(&record, 0, sizeof(record));
+    record.magic = SOLVE_LOG_MAGIC;
+    record.index = this->nextIndex++;
+    record.solve = solve;
+    record.moveOffset = this->moveEnd;
+    record.moveBytes = bytes;
+    record.moveCount = this->moveCount;
+    record.moveFormat = SOLVE_LOG_MOVES_RANGE;
+    record.crc = crc32Update((const uint8_t *)&record, offsetof(LogRecord, crc));
+    this->pendingMoveBytes += bytes;
+    this->moveEnd += bytes;
+    this->_recentAt(this->count + this->pendingCount) = record;
+    this->pendingCount++;
+    this->lastAppend = timestamp;
+    this->moveCount = 0;
+    if(this->pendingCount == SOLVE_LOG_BATCH) this->flush();
+    return true;
+}
+bool SolveLog::flush()
+{
+    if(!this->ready) return false;
+    if(!this->pendingCount) return true;
+    uint32_t moveFileSize = this->moveEnd - this->pendingMoveBytes - this->moveBase + sizeof(MovesHeader);
+    FILE *file = fopen(this->movesPath, "ab");
+    bool ok = file != nullptr;
+    if(file)
+    {
+        ok = !this->pendingMoveBytes || fwrite(this->pendingMoves, this->pendingMoveBytes, 1, file) == 1;
+        ok = (fclose(file) == 0) && ok;
+    }
+    if(ok)
+    {
+        file = fopen(this->solvesPath, "ab");
+        ok = file != nullptr;
+        if(file)
+        {
+            ok = fwrite(this->pending, sizeof(LogRecord), this->pendingCount, file) == this->pendingCount;
+            ok = (fclose(file) == 0) && ok;
+        }
+    }
+    if(!ok)
+    {
+        // back to the last good state, the batch stays pending
+        truncate(this->movesPath, moveFileSize);
+        truncate(this->solvesPath, this->count * sizeof(LogRecord));
+        return false;
+    }
+    this->count += this->pendingCount;
+    this->pendingCount = 0;
+    this->pendingMoveBytes = 0;
+    return true;
+}
+void SolveLog::maintain(uint64_t timestamp)
+{
+    if(!this->ready) return;
+    if(this->pendingCount && timestamp - this->lastAppend >= SOLVE_LOG_FLUSH_US) this->flush();
+    if(this->compactSolves) this->_compactStep();
+    else if(this->count > SOLVE_LOG_MAX_RECORDS) this->_startCompaction();
+}
+bool SolveLog::hasWork() const
+{
+    return this->ready && (this->pendingCount || this->compactSolves || this->count > SOLVE_LOG_MAX_RECORDS);
+}
+uint32_t SolveLog::size() const
+{
+    return this->count + this->pendingCount;
+}
+bool SolveLog::getRecent(uint32_t back, LogRecord &record) const
+{
+    uint32_t total = this->size();
+    if(back >= total) return false;
+    uint32_t position = total - 1 - back;
+    if(back < SOLVE_LOG_INDEX)
+    {
+        record = this->_recentAt(position);
+        return _isValid(record);
+    }
+    FILE *file = fopen(this->solvesPath, "rb");
+    if(!file) return false;
+    bool ok = this->_readRecord(file, position, record);
+    fclose(file);
+    return ok;
+}
+uint32_t SolveLog::replay(uint32_t last, RecordCallback callback) const
+{
+    uint32_t total = this->size();
+    if(last > total) last = total;
+    uint32_t replayed = 0;
+    LogRecord record;
+    FILE *file = fopen(this->solvesPath, "rb");
+    for(uint32_t p = total - last; p < total; p++)
+    {
+        bool ok;
+        if(p >= this->count) record = this->pending[p - this->count], ok = true;
+        else ok = file && this->_readRecord(file, p, record);
+        if(!ok) continue;
+        callback(record);
+        replayed++;
+    }
+    if(file) fclose(file);
+    return replayed;
+}
+int16_t SolveLog::readMoves(const LogRecord &record, MOVE *moves, uint32_t *times, uint16_t max) const
+{
+    vector<uint8_t> data(record.moveBytes);
+    if(!this->readMoveData(record, data.data())) return -1;
+    if(record.moveFormat == SOLVE_LOG_MOVES_VARINT) return _decodeVarint(data.data(), record.moveBytes, moves, times, max);
+    if(record.moveFormat != SOLVE_LOG_MOVES_RANGE) return -1;
+    MoveDecoder decoder;
+    decoder.begin(data.data(), record.moveBytes);
+    uint16_t count = record.moveCount < max ? record.moveCount : max;
+    uint32_t time = 0, delta;
+    for(uint16_t i = 0; i < count; i++)
+    {
+        if(!decoder.decode(moves[i], delta)) return -1;
+        time += delta;
+        if(times) times[i] = time;
+    }
+    return count;
+}
+bool SolveLog::readMoveData(const LogRecord &record, uint8_t *data) const
+{
+    if(record.moveOffset < this->moveBase || record.moveOffset + record.moveBytes > this->moveEnd) return false;
+    uint32_t flushedEnd = this->moveEnd - this->pendingMoveBytes;
+    if(record.moveOffset >= flushedEnd)
+    {
+        memcpy(data, this->pendingMoves + (record.moveOffset - flushedEnd), record.moveBytes);
+        return true;
+    }
+    FILE *file = fopen(this->movesPath, "rb");
+    if(!file) return false;
+    bool ok = fseek(file, record.moveOffset - this->moveBase + sizeof(MovesHeader), SEEK_SET) == 0 && fread(data, 1, record.moveBytes, file) == record.moveBytes;
+    fclose(file);
+    return ok;
+}
+bool SolveLog::isCompacting() const
+{
+    return this->compactSolves != nullptr;
+}
+bool SolveLog::_isValid(const LogRecord &record)
+{
+    return record.magic == SOLVE_LOG_MAGIC && record.crc == crc32Update((const uint8_t *)&record, offsetof(LogRecord, crc));
+}
+uint16_t SolveLog::_encodeMoves(uint8_t *out, uint16_t capacity) const
+{
+    MoveEncoder encoder;
+    encoder.begin(out, capacity);
+    for(uint16_t i = 0; i < this->moveCount; i++) encoder.encode(this->moves[i], this->moveDeltas[i]);
+    uint16_t bytes = encoder.finish();
+    return encoder.overflowed() ? 0 : bytes;
+}
+int16_t SolveLog::_decodeVarint(const uint8_t *data, uint16_t length, MOVE *moves, uint32_t *times, uint16_t max)
+{
+    uint16_t count = 0;
+    uint32_t time = 0, value = 0;
+    uint8_t shift = 0;
+    for(uint16_t i = 0; i < length && count < max; i++)
+    {
+        value |= (uint32_t)(data[i] & 0x7F) << shift;
+        shift += 7;
+        if(data[i] & 0x80) continue;
+        if((value & 0x1F) >= (uint8_t)MOVE::NONE) return -1;
+        time += value >> 5;
+        moves[count] = (MOVE)(value & 0x1F);
+        if(times) times[count] = time;
+        count++;
+        value = 0;
+        shift = 0;
+    }
+    return count;
+}
+long SolveLog::_fileSize(FILE *file)
+{
+    if(fseek(file, 0, SEEK_END) != 0) return 0;
+    return ftell(file);
+}
+bool SolveLog::_readRecord(FILE *file, uint32_t position, LogRecord &record) const
+{
+    if(fseek(file, (long)position * sizeof(LogRecord), SEEK_SET) != 0) return false;
+    if(fread(&record, sizeof(LogRecord), 1, file) != 1) return false;
+    return _isValid(record);
+}
+bool SolveLog::_startCompaction()
+{
+    this->compactFrom = this->count - SOLVE_LOG_KEEP_RECORDS;
+    LogRecord first;
+    FILE *file = fopen(this->solvesPath, "rb");
+    if(!file) return false;
+    bool ok = this->_readRecord(file, this->compactFrom, first);
+    fclose(file);
+    if(!ok) return false;
+    this->compactSolves = fopen(this->solvesTmpPath, "wb");
+    this->compactMoves = fopen(this->movesTmpPath, "wb");
+    MovesHeader header = {SOLVE_LOG_MOVES_MAGIC, first.moveOffset < this->moveBase ? this->moveBase : first.moveOffset};
+    if(!this->compactSolves || !this->compactMoves || fwrite(&header, sizeof(header), 1, this->compactMoves) != 1)
+    {
+        this->_abortCompaction();
+        return false;
+    }
+    this->compactNext = this->compactFrom;
+    this->compactWritten = 0;
+    this->compactMoveNext = header.base;
+    return true;
+}
+bool SolveLog::_compactStep()
+{
+    FILE *solves = fopen(this->solvesPath, "rb");
+    FILE *moves = fopen(this->movesPath, "rb");
+    bool ok = solves && moves;
+    LogRecord record;
+    uint32_t moveTo = this->compactMoveNext;
+    // records, as they are
+    for(uint8_t i = 0; ok && i < SOLVE_LOG_COMPACT_STEP && this->compactNext < this->count; i++, this->compactNext++)
+    {
+        if(!this->_readRecord(solves, this->compactNext, record)) continue; // a damaged record is dropped
+        ok = fwrite(&record, sizeof(record), 1, this->compactSolves) == 1;
+        this->compactWritten++;
+        if(record.moveOffset + record.moveBytes > moveTo) moveTo = record.moveOffset + record.moveBytes;
+    }
+    // and the moves they point at
+    uint8_t buffer[256];
+    if(ok) ok = fseek(moves, this->compactMoveNext - this->moveBase + sizeof(MovesHeader), SEEK_SET) == 0;
+    while(ok && this->compactMoveNext < moveTo)
+    {
+        size_t length = moveTo - this->compactMoveNext < sizeof(buffer) ? moveTo - this->compactMoveNext : sizeof(buffer);
+        ok = fread(buffer, 1, length, moves) == length && fwrite(buffer, 1, length, this->compactMoves) == length;
+        this->compactMoveNext += length;
+    }
+    if(solves) fclose(solves);
+    if(moves) fclose(moves);
+    if(!ok)
+    {
+        this->_abortCompaction();
+        return false;
+    }
+    if(this->compactNext < this->count) return true;
+    // done: solves first, see the header
+    ok = fclose(this->compactSolves) == 0;
+    ok = (fclose(this->compactMoves) == 0) && ok;
+    this->compactSolves = nullptr;
+    this->compactMoves = nullptr;
+    if(!ok || rename(this->solvesTmpPath, this->solvesPath) != 0)
+    {
+        remove(this->solvesTmpPath);
+        remove(this->movesTmpPath);
+        return false;
+    }
+    if(rename(this->movesTmpPath, this->movesPath) == 0)
+    {
+        FILE *file = fopen(this->movesPath, "rb");
+        MovesHeader header;
+        if(file && fread(&header, sizeof(header), 1, file) == 1) this->moveBase = header.base;
+        if(file) fclose(file);
+    }
+    else remove(this->movesTmpPath);
+    this->dropped += this->count - this->compactWritten;
+    this->count = this->compactWritten;
+    return true;
+}
+void SolveLog::_abortCompaction()
+{
+    if(this->compactSolves) fclose(this->compactSolves);
+    if(this->compactMoves) fclose(this->compactMoves);
+    this->compactSolves = nullptr;
+    this->compactMoves = nullptr;
+    remove(this->solvesTmpPath);
+    remove(this->movesTmpPath);
+}
+#endif
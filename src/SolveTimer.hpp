@@ -0,0 +1,226 @@
+/**
+ * @author Matrixchung
+ * @brief  A SolveTimer turns the decoded move stream into timed solves.
+ *
+ * States: SCRAMBLED -> INSPECTION -> SOLVING (first move) -> SOLVED
+ *
+ * SOLVED     : any move starts a new scramble.
+ * SCRAMBLED  : inspection starts by startInspection() or, if inspectionDelay is set, after the cube stays still that long.
+ *              Undoing the scramble back to solved returns to SOLVED without a record.
+ * INSPECTION : the first move starts the solve. WCA rules: over 15s is +2, over 17s is DNF.
+ * SOLVING    : the move which solves the cube stops the timer and emits one SolveRecord.
+ *
+ * While solving, a MoveCanonicalizer counts the solution in ETM / HTM / QTM and a MethodTracker records the splits of the selected
+ * method (setMethod(), CFOP by default: cross, 4 F2L pairs, OLL, PLL) into the record.
+ *
+ * All timestamps are microseconds, taken when the notify arrives (esp_timer_get_time() on ESP32).
+ * The solved check costs O(1) per move, as CubeModel::applyMove() only refreshes the 8 slots of the turned face.
+ *
+ * **/
+#ifndef _SOLVE_TIMER_HPP
+#define _SOLVE_TIMER_HPP
+
+#include <cstdint>
+#include "CubeModel.hpp"
+#include "MethodTracker.hpp"
+#include "MoveCanonicalizer.hpp"
+
+#define INSPECTION_PLUS_TWO_US 15000000ull
+#define INSPECTION_DNF_US      17000000ull
+
+enum class TIMER_STATE : uint8_t {SCRAMBLED, INSPECTION, SOLVING, SOLVED};
+
+// Flags of a SolveRecord
+#define SOLVE_FLAG_PLUS_TWO     0x01
+#define SOLVE_FLAG_DNF          0x02
+#define SOLVE_FLAG_METHOD_MASK  0x0C // the METHOD of the splits, 0 (CFOP) in older logs
+#define SOLVE_FLAG_METHOD_SHIFT 2
+
+#define SOLVE_SPLITS METHOD_MAX_STEPS
+
+struct __attribute__((packed)) SolveRecord
+{
+    uint32_t solveTime;      // us, from the first move to the solving move (without penalty)
+    uint32_t inspectionTime; // us, from the start of inspection to the first move
+    uint16_t moveCount;      // quarter turns as reported by the cube
+    uint16_t etm;            // moves as executed, see MoveCanonicalizer
+    uint16_t htm;            // canonical solution length, half turn metric
+    uint16_t qtm;            // canonical solution length, quarter turn metric
+    uint8_t  flags;
+    uint8_t  crossFace;      // FACE of the detected cross, or of the solver's D for other methods
+    uint8_t  ollCase;        // OLL case faced (0 - skip), see LastLayer.hpp, LL_UNKNOWN if not CFOP
+    uint8_t  pllCase;        // PLL case faced, index of PLL_NAMES, LL_UNKNOWN if not CFOP
+    uint32_t splits[SOLVE_SPLITS]; // us since the first move at the end of each step of the method, see METHOD_PROFILES
+    uint32_t scrambleHash;   // CubeModel::hash() of the scrambled cube
+};
+
+class SolveTimer
+{
+    public:
+        typedef void (*SolveCallback)(const SolveRecord &record);
+    private:
+        CubeModel cube;
+        TIMER_STATE state;
+        uint64_t lastMoveTime;
+        uint64_t inspectionStart;
+        uint64_t solveStart;
+        uint32_t scrambleHash;
+        uint16_t moveCount;
+        uint32_t inspectionDelay;
+        bool synced;
+        SolveCallback callback;
+        MethodTracker method;
+        MoveCanonicalizer canon;
+        void _finishSolve(uint64_t timestamp);
+    public:
+        SolveTimer();
+        void sync(const CubeModel &cube, uint64_t timestamp); // Take over a full decoded state, e.g. the first packet after connecting. Drops a solve in progress.
+        bool isSynced() const;
+        void onMove(MOVE move, uint64_t timestamp);
+        void startInspection(uint64_t timestamp);
+        void update(uint64_t timestamp); // Call periodically to start inspection after inspectionDelay of stillness.
+        uint64_t getInspectionDeadline() const; // when update() would start inspection, 0 if it will not
+        void setInspectionDelay(uint32_t delay); // us, 0 - only startInspection() starts inspection
+        void setCallback(SolveCallback callback);
+        void setMethod(METHOD method); // for the splits, from the next solve on
+        TIMER_STATE getState() const;
+        const CubeModel &getCube() const;
+        const MethodTracker &getMethodTracker() const;
+        const CfopTracker &getCfop() const;
+        const MoveCanonicalizer &getCanonicalizer() const;
+        uint32_t getElapsed(uint64_t timestamp) const; // us of the running solve, 0 if not solving
+};
+
+SolveTimer::SolveTimer()
+{
+    this->state = TIMER_STATE::SOLVED;
+    this->lastMoveTime = 0;
+    this->inspectionStart = 0;
+    this->solveStart = 0;
+    this->scrambleHash = 0;
+    this->moveCount = 0;
+    this->inspectionDelay = 0;
+    this->synced = false;
+    this->callback = nullptr;
+}
+void SolveTimer::sync(const CubeModel &cube, uint64_t timestamp)
+{
+    this->cube = cube;
+    this->lastMoveTime = timestamp; // the automatic inspection waits from here, not from boot
+    this->state = cube.isSolved() ? TIMER_STATE::SOLVED : TIMER_STATE::SCRAMBLED;
+    this->moveCount = 0;
+    this->synced = true;
+}
+bool SolveTimer::isSynced() const
+{
+    return this->synced;
+}
+void SolveTimer::onMove(MOVE move, uint64_t timestamp)
+{
+    if(move >= MOVE::NONE) return;
+    this->cube.applyMove(move);
+    this->lastMoveTime = timestamp;
+    switch(this->state)
+    {
+        case TIMER_STATE::SOLVED:
+            this->state = TIMER_STATE::SCRAMBLED;
+            break;
+        case TIMER_STATE::SCRAMBLED:
+            if(this->cube.isSolved()) this->state = TIMER_STATE::SOLVED;
+            break;
+        case TIMER_STATE::INSPECTION:
+            this->state = TIMER_STATE::SOLVING;
+            this->solveStart = timestamp;
+            this->moveCount = 1;
+            this->method.start(this->cube);
+            this->canon.reset();
+            this->canon.push(move, timestamp);
+            if(this->cube.isSolved()) this->_finishSolve(timestamp);
+            break;
+        case TIMER_STATE::SOLVING:
+            if(this->moveCount < UINT16_MAX) this->moveCount++;
+            this->method.onMove(this->cube, move, (uint32_t)(timestamp - this->solveStart));
+            this->canon.push(move, timestamp);
+            if(this->cube.isSolved()) this->_finishSolve(timestamp);
+            break;
+    }
+}
+void SolveTimer::startInspection(uint64_t timestamp)
+{
+    if(this->state != TIMER_STATE::SCRAMBLED) return;
+    this->state = TIMER_STATE::INSPECTION;
+    this->inspectionStart = timestamp;
+    this->scrambleHash = this->cube.hash();
+}
+void SolveTimer::update(uint64_t timestamp)
+{
+    if(this->inspectionDelay && this->state == TIMER_STATE::SCRAMBLED && timestamp - this->lastMoveTime >= this->inspectionDelay)
+    {
+        this->startInspection(this->lastMoveTime + this->inspectionDelay);
+    }
+}
+uint64_t SolveTimer::getInspectionDeadline() const
+{
+    if(!this->inspectionDelay || this->state != TIMER_STATE::SCRAMBLED) return 0;
+    return this->lastMoveTime + this->inspectionDelay;
+}
+void SolveTimer::setInspectionDelay(uint32_t delay)
+{
+    this->inspectionDelay = delay;
+}
+void SolveTimer::setCallback(SolveCallback callback)
+{
+    this->callback = callback;
+}
+TIMER_STATE SolveTimer::getState() const
+{
+    return this->state;
+}
+const CubeModel &SolveTimer::getCube() const
+{
+    return this->cube;
+}
+void SolveTimer::setMethod(METHOD method)
+{
+    this->method.setMethod(method);
+}
+const MethodTracker &SolveTimer::getMethodTracker() const
+{
+    return this->method;
+}
+const CfopTracker &SolveTimer::getCfop() const
+{
+    return this->method.getCfop();
+}
+const MoveCanonicalizer &SolveTimer::getCanonicalizer() const
+{
+    return this->canon;
+}
+uint32_t SolveTimer::getElapsed(uint64_t timestamp) const
+{
+    if(this->state != TIMER_STATE::SOLVING) return 0;
+    return (uint32_t)(timestamp - this->solveStart);
+}
+void SolveTimer::_finishSolve(uint64_t timestamp)
+{
+    this->state = TIMER_STATE::SOLVED;
+    SolveRecord record;
+    record.solveTime = (uint32_t)(timestamp - this->solveStart);
+    record.inspectionTime = (uint32_t)(this->solveStart - this->inspectionStart);
+    record.moveCount = this->moveCount;
+    record.etm = this->canon.getEtm() < UINT16_MAX ? this->canon.getEtm() : UINT16_MAX;
+    record.htm = this->canon.getHtm() < UINT16_MAX ? this->canon.getHtm() : UINT16_MAX;
+    record.qtm = this->canon.getQtm() < UINT16_MAX ? this->canon.getQtm() : UINT16_MAX;
+    record.flags = 0;
+    if(record.inspectionTime > INSPECTION_DNF_US) record.flags |= SOLVE_FLAG_DNF;
+    else if(record.inspectionTime > INSPECTION_PLUS_TWO_US) record.flags |= SOLVE_FLAG_PLUS_TWO;
+    record.flags |= (uint8_t)this->method.getMethod() << SOLVE_FLAG_METHOD_SHIFT;
+    bool cfop = this->method.getMethod() == METHOD::CFOP;
+    record.crossFace = (uint8_t)this->method.getBottomFace();
+    record.ollCase = cfop ? this->method.getCfop().getOllCase() : LL_UNKNOWN;
+    record.pllCase = cfop ? this->method.getCfop().getPllCase() : LL_UNKNOWN;
+    for(uint8_t i = 0; i < SOLVE_SPLITS; i++) record.splits[i] = this->method.getSplit(i);
+    record.scrambleHash = this->scrambleHash;
+    if(this->callback) this->callback(record);
+}
+#endif
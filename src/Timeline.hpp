@@ -0,0 +1,140 @@
+/**
+ * @author Matrixchung
+ * @brief  Timeline keeps every move of a session and gives the cube after any of them.
+ *
+ * Moves are stored one byte each, with a packed checkpoint of the cube every `interval` moves. seek() starts from
+ * the nearest checkpoint (or the current cube) and replays the moves after it, or undoes the moves before it, so any
+ * state costs at most interval / 2 applyMove() calls. Memory is 1 + 13 / interval bytes per move:
+ *  interval   16: 1.81 bytes per move, <= 8 moves per seek
+ *  interval   64: 1.20 bytes per move, <= 32 moves per seek (TIMELINE_INTERVAL)
+ *  interval  256: 1.05 bytes per move, <= 128 moves per seek
+ * See tools/timeline_bench.cpp for seek times.
+ *
+ * A checkpoint packs each cubie as slot * 3 + twist or slot * 2 + flip in 5 bits: 40 bits of corners, 60 of edges.
+ *
+ * **/
+#ifndef _TIMELINE_HPP
+#define _TIMELINE_HPP
+
+#include <cstdint>
+#include <vector>
+using std::vector;
+#include "CubeModel.hpp"
+#include "CubieCube.hpp"
+
+#define TIMELINE_INTERVAL 64 // moves between checkpoints
+
+struct TimelineCheckpoint
+{
+    uint64_t edges;
+    uint8_t corners[5];
+    void pack(const CubieCube &cube);
+    void unpack(CubieCube &cube) const;
+} __attribute__((packed));
+
+class Timeline
+{
+    private:
+        vector<uint8_t> moves; // MOVE
+        vector<TimelineCheckpoint> checkpoints; // the cube after checkpoint * interval moves
+        CubieCube current; // after all of them
+        uint16_t interval;
+    public:
+        Timeline(uint16_t interval = TIMELINE_INTERVAL);
+        void begin(const CubieCube &start); // drops the moves so far
+        void begin(const CubeModel &start);
+        void append(MOVE move);
+        uint32_t size() const; // moves
+        MOVE getMove(uint32_t index) const; // MOVE::NONE past the end
+        bool seek(uint32_t index, CubieCube &cube) const; // the cube after the first index moves, false past the end
+        uint16_t getInterval() const;
+        size_t bytes() const;
+};
+
+void TimelineCheckpoint::pack(const CubieCube &cube)
+{
+    uint64_t corners = 0;
+    this->edges = 0;
+    for(uint8_t i = 0; i < 8; i++) corners |= (uint64_t)(cube.cp[i] * 3 + cube.co[i]) << (i * 5);
+    for(uint8_t i = 0; i < 12; i++) this->edges |= (uint64_t)(cube.ep[i] * 2 + cube.eo[i]) << (i * 5);
+    for(uint8_t i = 0; i < 5; i++) this->corners[i] = corners >> (i * 8);
+}
+void TimelineCheckpoint::unpack(CubieCube &cube) const
+{
+    uint64_t corners = 0;
+    for(uint8_t i = 0; i < 5; i++) corners |= (uint64_t)this->corners[i] << (i * 8);
+    for(uint8_t i = 0; i < 8; i++)
+    {
+        uint8_t state = corners >> (i * 5) & 31;
+        cube.cp[i] = state / 3;
+        cube.co[i] = state % 3;
+    }
+    for(uint8_t i = 0; i < 12; i++)
+    {
+        uint8_t state = this->edges >> (i * 5) & 31;
+        cube.ep[i] = state >> 1;
+        cube.eo[i] = state & 1;
+    }
+}
+
+Timeline::Timeline(uint16_t interval)
+{
+    this->interval = interval ? interval : 1;
+    this->begin(CubieCube());
+}
+void Timeline::begin(const CubieCube &start)
+{
+    this->moves.clear();
+    this->checkpoints.resize(1);
+    this->checkpoints[0].pack(start);
+    this->current = start;
+}
+void Timeline::begin(const CubeModel &start)
+{
+    this->begin(CubieCube(start));
+}
+void Timeline::append(MOVE move)
+{
+    if(move >= MOVE::NONE) return;
+    this->moves.push_back((uint8_t)move);
+    this->current.applyMove(move);
+    if(this->moves.size() % this->interval) return;
+    this->checkpoints.push_back(TimelineCheckpoint());
+    this->checkpoints.back().pack(this->current);
+}
+uint32_t Timeline::size() const
+{
+    return this->moves.size();
+}
+MOVE Timeline::getMove(uint32_t index) const
+{
+    return index < this->moves.size() ? (MOVE)this->moves[index] : MOVE::NONE;
+}
+bool Timeline::seek(uint32_t index, CubieCube &cube) const
+{
+    if(index > this->moves.size()) return false;
+    uint32_t checkpoint = (index + this->interval / 2) / this->interval, position;
+    if(checkpoint < this->checkpoints.size())
+    {
+        this->checkpoints[checkpoint].unpack(cube);
+        position = checkpoint * this->interval;
+    }
+    else
+    {
+        // nearer the end than the last checkpoint
+        cube = this->current;
+        position = this->moves.size();
+    }
+    for(; position < index; position++) cube.applyMove((MOVE)this->moves[position]);
+    for(; position > index; position--) cube.applyMove(invertMove((MOVE)this->moves[position - 1]));
+    return true;
+}
+uint16_t Timeline::getInterval() const
+{
+    return this->interval;
+}
+size_t Timeline::bytes() const
+{
+    return this->moves.size() + this->checkpoints.size() * sizeof(TimelineCheckpoint);
+}
+#endif
@@ -0,0 +1,134 @@
+/**
+ * @author Matrixchung
+ * @brief  TurnStats keeps live turning statistics of the move stream in fixed memory.
+ *
+ *  - rolling TPS over the last 1 s and 5 s, from a ring of the last TURN_STATS_HISTORY timestamps
+ *  - turns per face and per direction
+ *  - a histogram of the time between moves, with log2 buckets: bucket i counts gaps in [2^i, 2^(i+1)) ms (bucket 0 from 0),
+ *    so short bursts (< 128 ms), regrips (~ 128 - 512 ms) and pauses (> 1 s) can be told apart
+ *  - the longest pause
+ * onMove() is O(1); getTps1s() / getTps5s() are O(1) amortized, as their window heads only move forward.
+ * getTps() with any other window rescans the ring.
+ *
+ * **/
+#ifndef _TURN_STATS_HPP
+#define _TURN_STATS_HPP
+
+#include <cstdint>
+#include "CubeModel.hpp"
+
+#define TURN_STATS_HISTORY 128 // timestamps kept, enough for 5 s at 25 TPS
+#define TURN_STATS_BUCKETS 16  // up to 2^15 ms, longer gaps go to the last bucket
+#define TURN_STATS_PAUSE_US 1000000u // gaps from this long count as pauses
+
+class TurnStats
+{
+    private:
+        uint64_t times[TURN_STATS_HISTORY]; // ring buffer of move timestamps
+        uint32_t count;                     // moves since reset
+        uint32_t head1s, head5s;            // oldest move inside each window
+        uint32_t faceTurns[6][2];           // [face][0 - clockwise, 1 - counter-clockwise], half turns count as clockwise
+        uint32_t gapHistogram[TURN_STATS_BUCKETS];
+        uint32_t pauses;
+        uint32_t longestGap;
+        uint32_t _windowCount(uint32_t &head, uint64_t window, uint64_t now);
+    public:
+        TurnStats();
+        void reset();
+        void onMove(MOVE move, uint64_t timestamp);
+        float getTps(uint64_t now, uint32_t window = 1000000); // turns per second over the last window us (up to TURN_STATS_HISTORY moves)
+        float getTps1s(uint64_t now); // now must not go backwards between calls
+        float getTps5s(uint64_t now);
+        uint32_t getCount() const;
+        uint32_t getFaceTurns(FACE face) const;
+        uint32_t getFaceTurns(FACE face, uint8_t dir) const; // dir 0 - clockwise, 1 - counter-clockwise
+        uint32_t getGapCount(uint8_t bucket) const;
+        uint32_t getPauses() const;
+        uint32_t getLongestGap() const; // us
+};
+
+TurnStats::TurnStats()
+{
+    this->reset();
+}
+void TurnStats::reset()
+{
+    this->count = 0;
+    this->head1s = 0;
+    this->head5s = 0;
+    for(uint8_t f = 0; f < 6; f++) this->faceTurns[f][0] = this->faceTurns[f][1] = 0;
+    for(uint8_t i = 0; i < TURN_STATS_BUCKETS; i++) this->gapHistogram[i] = 0;
+    this->pauses = 0;
+    this->longestGap = 0;
+}
+void TurnStats::onMove(MOVE move, uint64_t timestamp)
+{
+    if(move >= MOVE::NONE) return;
+    uint8_t face = (uint8_t)move / 3, turn = (uint8_t)move % 3;
+    if(turn == 2) this->faceTurns[face][1]++;
+    else this->faceTurns[face][0]++;
+    if(this->count)
+    {
+        uint64_t last = this->times[(this->count - 1) % TURN_STATS_HISTORY];
+        uint32_t gap = timestamp > last ? (uint32_t)(timestamp - last) : 0;
+        uint32_t ms = gap / 1000;
+        uint8_t bucket = 0;
+        while(ms > 1 && bucket < TURN_STATS_BUCKETS - 1)
+        {
+            ms >>= 1;
+            bucket++;
+        }
+        this->gapHistogram[bucket]++;
+        if(gap >= TURN_STATS_PAUSE_US) this->pauses++;
+        if(gap > this->longestGap) this->longestGap = gap;
+    }
+    this->times[this->count % TURN_STATS_HISTORY] = timestamp;
+    this->count++;
+}
+// Moves in (now - window, now], moving head forward past older moves.
+uint32_t TurnStats::_windowCount(uint32_t &head, uint64_t window, uint64_t now)
+{
+    if(this->count > TURN_STATS_HISTORY && head < this->count - TURN_STATS_HISTORY) head = this->count - TURN_STATS_HISTORY;
+    while(head < this->count && this->times[head % TURN_STATS_HISTORY] + window <= now) head++;
+    return this->count - head;
+}
+float TurnStats::getTps(uint64_t now, uint32_t window)
+{
+    uint32_t head = this->count > TURN_STATS_HISTORY ? this->count - TURN_STATS_HISTORY : 0;
+    return this->_windowCount(head, window, now) * 1000000.0f / window;
+}
+float TurnStats::getTps1s(uint64_t now)
+{
+    return this->_windowCount(this->head1s, 1000000, now);
+}
+float TurnStats::getTps5s(uint64_t now)
+{
+    return this->_windowCount(this->head5s, 5000000, now) / 5.0f;
+}
+uint32_t TurnStats::getCount() const
+{
+    return this->count;
+}
+uint32_t TurnStats::getFaceTurns(FACE face) const
+{
+    if(face >= FACE::NONE) return 0;
+    return this->faceTurns[(uint8_t)face][0] + this->faceTurns[(uint8_t)face][1];
+}
+uint32_t TurnStats::getFaceTurns(FACE face, uint8_t dir) const
+{
+    if(face >= FACE::NONE || dir > 1) return 0;
+    return this->faceTurns[(uint8_t)face][dir];
+}
+uint32_t TurnStats::getGapCount(uint8_t bucket) const
+{
+    return bucket < TURN_STATS_BUCKETS ? this->gapHistogram[bucket] : 0;
+}
+uint32_t TurnStats::getPauses() const
+{
+    return this->pauses;
+}
+uint32_t TurnStats::getLongestGap() const
+{
+    return this->longestGap;
+}
+#endif
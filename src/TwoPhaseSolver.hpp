@@ -0,0 +1,308 @@
+/**
+ * @author Matrixchung
+ * @brief  Kociemba's two-phase solver, sized to fit the ESP32 by default.
+ *
+ * Phase 1 brings the cube into <U, D, L2, F2, R2, B2> (all orientations solved, middle layer edges in the middle layer),
+ * phase 2 solves it inside that group. Both phases are IDA* over CubieCube states, with pruning tables of
+ * distances to the phase goal, 4 bits per entry, built by breadth-first search on first use:
+ *
+ *  default (ESP32, ~45 KB) : max of twist, flip, slice (phase 1) and cornerPerm, edgePermUD, slicePerm (phase 2) alone
+ *  TWO_PHASE_FULL_TABLES   : twist x slice, flip x slice, cornerPerm x slicePerm and edgePermUD x slicePerm (~2 MB, host only).
+ *                            The much tighter bounds find 20 - 21 move solutions in a few ms.
+ *
+ * Coordinates are computed from the cubies at each node instead of coming from move tables (~1.6 MB for phase 2 alone),
+ * which is slower but keeps the ESP32 version in RAM. The small tables are weak bounds though: a random state takes
+ * ~10^7 nodes for 24 moves (against ~3 * 10^5 with the full tables), 1.2 s on average and up to ~5 s on a desktop core
+ * (~9 M nodes/s). The ESP32 is some 50 - 100x slower per node (estimated, not measured), so a scramble takes ~1 - 2 minutes
+ * there and several minutes for the hard states: a job for an idle-priority task, one scramble at a time.
+ * Capping phase 2 to make it cheaper costs more than it saves, the weak phase 1 bounds make each extra phase 1 solution dear.
+ *
+ * The tables are shared and read only after build(), so several TwoPhaseSolvers (one per thread) can use one TwoPhaseTables.
+ *
+ * **/
+#ifndef _TWO_PHASE_SOLVER_HPP
+#define _TWO_PHASE_SOLVER_HPP
+
+#include <cstdint>
+#include <vector>
+using std::vector;
+#include "CubeModel.hpp"
+#include "CubieCube.hpp"
+
+#define TWO_PHASE_MAX_LENGTH  32
+#define TWO_PHASE_NODE_BUDGET 100000000 // nodes per solve() before giving up
+
+#define TWIST_COUNT       2187
+#define FLIP_COUNT        2048
+#define SLICE_COUNT       495
+#define CORNER_PERM_COUNT 40320
+#define EDGE_PERM_COUNT   40320
+#define SLICE_PERM_COUNT  24
+
+// Moves of phase 2: quarter turns of U and D, half turns of the others
+const static MOVE PHASE2_MOVES[10] = {MOVE::U, MOVE::U2, MOVE::U_, MOVE::L2, MOVE::F2, MOVE::R2, MOVE::B2, MOVE::D, MOVE::D2, MOVE::D_};
+
+// Distances, 2 entries per byte, 0xF - not reached yet.
+class NibbleTable
+{
+    private:
+        vector<uint8_t> data;
+    public:
+        void resize(uint32_t size) { this->data.assign((size + 1) / 2, 0xFF); }
+        uint8_t get(uint32_t index) const { return (this->data[index >> 1] >> ((index & 1) << 2)) & 0xF; }
+        void prefetch(uint32_t index) const { __builtin_prefetch(this->data.data() + (index >> 1)); } // before a get() that would miss the cache
+        void set(uint32_t index, uint8_t value) { this->data[index >> 1] &= ~(0xF << ((index & 1) << 2)); this->data[index >> 1] |= value << ((index & 1) << 2); }
+        size_t bytes() const { return this->data.size(); }
+        uint8_t *raw() { return this->data.data(); } // for saving / loading
+        const uint8_t *raw() const { return this->data.data(); }
+};
+
+// Distances mod 3, 4 entries per byte (entry i in bits 2 * (i % 4) of byte i / 4). One move changes a distance by at most
+// one, so the exact distance of a state follows from that of a neighbor: mod3Distance(). See KorfSolver.hpp.
+#define MOD3_BYTES(size) (((size) + 3) / 4)
+static inline uint8_t mod3Get(const uint8_t *data, uint32_t index) { return (data[index >> 2] >> ((index & 3) << 1)) & 3; }
+static inline uint8_t mod3Distance(uint8_t neighbor, uint8_t stored) { return neighbor + (stored + 4 - neighbor % 3) % 3 - 1; }
+void packMod3(const NibbleTable &table, uint32_t size, uint8_t *out); // every entry reached, out has MOD3_BYTES(size)
+
+class TwoPhaseTables
+{
+    public:
+        typedef uint16_t (*GetCoord)(const CubieCube &cube);
+        typedef void (*SetCoord)(CubieCube &cube, uint16_t coord);
+    private:
+        #ifdef TWO_PHASE_FULL_TABLES
+        NibbleTable twistSlice, flipSlice;
+        NibbleTable cornerSlicePerm, edgeSlicePerm;
+        #else
+        NibbleTable twist, flip, slice;
+        NibbleTable cornerPerm, edgePerm, slicePerm;
+        #endif
+        bool built;
+        static void _build(NibbleTable &table, uint16_t sizeA, GetCoord getA, SetCoord setA, uint16_t sizeB, GetCoord getB, SetCoord setB, bool phase2);
+    public:
+        TwoPhaseTables();
+        void build(); // ~1 s on the ESP32
+        bool isBuilt() const;
+        size_t bytes() const;
+        uint8_t phase1Bound(const CubieCube &cube) const; // lower bound of moves to the phase 2 group
+        uint8_t phase2Bound(const CubieCube &cube) const; // lower bound of phase 2 moves to solved, for a cube in the phase 2 group
+};
+
+class TwoPhaseSolver
+{
+    private:
+        const TwoPhaseTables &tables;
+        MOVE path[TWO_PHASE_MAX_LENGTH];
+        uint8_t maxLength, length;
+        uint32_t nodes, budget;
+        bool _phase1(const CubieCube &cube, uint8_t depth, uint8_t togo, uint8_t lastFace);
+        bool _solvePhase2(const CubieCube &cube, uint8_t depth, uint8_t lastFace);
+        bool _phase2(const CubieCube &cube, uint8_t depth, uint8_t togo, uint8_t lastFace);
+    public:
+        TwoPhaseSolver(const TwoPhaseTables &tables);
+        // Writes a solution of at most maxLength moves, returns its length or -1 if none was found within the node budget.
+        int8_t solve(const CubieCube &cube, MOVE *solution, uint8_t maxLength, uint32_t budget = TWO_PHASE_NODE_BUDGET);
+        uint32_t getNodes() const; // searched by the last solve()
+};
+
+static inline bool skipAfter(uint8_t face, uint8_t lastFace)
+{
+    // no face twice in a row, and opposite faces in one order only
+    return face == lastFace || (lastFace < 6 && (uint8_t)OPPOSITE_FACE[lastFace] == face && face < lastFace);
+}
+
+void packMod3(const NibbleTable &table, uint32_t size, uint8_t *out)
+{
+    for(uint32_t i = 0; i < MOD3_BYTES(size); i++) out[i] = 0;
+    for(uint32_t i = 0; i < size; i++) out[i >> 2] |= table.get(i) % 3 << ((i & 3) << 1);
+}
+
+TwoPhaseTables::TwoPhaseTables()
+{
+    this->built = false;
+}
+void TwoPhaseTables::build()
+{
+    if(this->built) return;
+    GetCoord getTwist = [](const CubieCube &c) -> uint16_t { return c.getTwist(); };
+    SetCoord setTwist = [](CubieCube &c, uint16_t v) { c.setTwist(v); };
+    GetCoord getFlip = [](const CubieCube &c) -> uint16_t { return c.getFlip(); };
+    SetCoord setFlip = [](CubieCube &c, uint16_t v) { c.setFlip(v); };
+    GetCoord getSlice = [](const CubieCube &c) -> uint16_t { return c.getSlice(); };
+    SetCoord setSlice = [](CubieCube &c, uint16_t v) { c.setSlice(v); };
+    GetCoord getCornerPerm = [](const CubieCube &c) -> uint16_t { return c.getCornerPerm(); };
+    SetCoord setCornerPerm = [](CubieCube &c, uint16_t v) { c.setCornerPerm(v); };
+    GetCoord getEdgePerm = [](const CubieCube &c) -> uint16_t { return c.getEdgePermUD(); };
+    SetCoord setEdgePerm = [](CubieCube &c, uint16_t v) { c.setEdgePermUD(v); };
+    GetCoord getSlicePerm = [](const CubieCube &c) -> uint16_t { return c.getSlicePerm(); };
+    SetCoord setSlicePerm = [](CubieCube &c, uint16_t v) { c.setSlicePerm(v); };
+    #ifdef TWO_PHASE_FULL_TABLES
+    _build(this->twistSlice, TWIST_COUNT, getTwist, setTwist, SLICE_COUNT, getSlice, setSlice, false);
+    _build(this->flipSlice, FLIP_COUNT, getFlip, setFlip, SLICE_COUNT, getSlice, setSlice, false);
+    _build(this->cornerSlicePerm, CORNER_PERM_COUNT, getCornerPerm, setCornerPerm, SLICE_PERM_COUNT, getSlicePerm, setSlicePerm, true);
+    _build(this->edgeSlicePerm, EDGE_PERM_COUNT, getEdgePerm, setEdgePerm, SLICE_PERM_COUNT, getSlicePerm, setSlicePerm, true);
+    #else
+    GetCoord none = [](const CubieCube &) -> uint16_t { return 0; };
+    SetCoord setNone = [](CubieCube &, uint16_t) {};
+    _build(this->twist, TWIST_COUNT, getTwist, setTwist, 1, none, setNone, false);
+    _build(this->flip, FLIP_COUNT, getFlip, setFlip, 1, none, setNone, false);
+    _build(this->slice, SLICE_COUNT, getSlice, setSlice, 1, none, setNone, false);
+    _build(this->cornerPerm, CORNER_PERM_COUNT, getCornerPerm, setCornerPerm, 1, none, setNone, true);
+    _build(this->edgePerm, EDGE_PERM_COUNT, getEdgePerm, setEdgePerm, 1, none, setNone, true);
+    _build(this->slicePerm, SLICE_PERM_COUNT, getSlicePerm, setSlicePerm, 1, none, setNone, true);
+    #endif
+    this->built = true;
+}
+bool TwoPhaseTables::isBuilt() const
+{
+    return this->built;
+}
+size_t TwoPhaseTables::bytes() const
+{
+    #ifdef TWO_PHASE_FULL_TABLES
+    return this->twistSlice.bytes() + this->flipSlice.bytes() + this->cornerSlicePerm.bytes() + this->edgeSlicePerm.bytes();
+    #else
+    return this->twist.bytes() + this->flip.bytes() + this->slice.bytes() + this->cornerPerm.bytes() + this->edgePerm.bytes() + this->slicePerm.bytes();
+    #endif
+}
+uint8_t TwoPhaseTables::phase1Bound(const CubieCube &cube) const
+{
+    #ifdef TWO_PHASE_FULL_TABLES
+    uint16_t slice = cube.getSlice();
+    uint8_t a = this->twistSlice.get((uint32_t)cube.getTwist() * SLICE_COUNT + slice);
+    uint8_t b = this->flipSlice.get((uint32_t)cube.getFlip() * SLICE_COUNT + slice);
+    return a > b ? a : b;
+    #else
+    uint8_t a = this->twist.get(cube.getTwist()), b = this->flip.get(cube.getFlip()), c = this->slice.get(cube.getSlice());
+    if(b > a) a = b;
+    return c > a ? c : a;
+    #endif
+}
+uint8_t TwoPhaseTables::phase2Bound(const CubieCube &cube) const
+{
+    #ifdef TWO_PHASE_FULL_TABLES
+    uint8_t slicePerm = cube.getSlicePerm();
+    uint8_t a = this->cornerSlicePerm.get((uint32_t)cube.getCornerPerm() * SLICE_PERM_COUNT + slicePerm);
+    uint8_t b = this->edgeSlicePerm.get((uint32_t)cube.getEdgePermUD() * SLICE_PERM_COUNT + slicePerm);
+    return a > b ? a : b;
+    #else
+    uint8_t a = this->cornerPerm.get(cube.getCornerPerm()), b = this->edgePerm.get(cube.getEdgePermUD()), c = this->slicePerm.get(cube.getSlicePerm());
+    if(b > a) a = b;
+    return c > a ? c : a;
+    #endif
+}
+// Breadth-first search over the pair (a, b), one depth at a time, expanding the entries found at the previous depth.
+void TwoPhaseTables::_build(NibbleTable &table, uint16_t sizeA, GetCoord getA, SetCoord setA, uint16_t sizeB, GetCoord getB, SetCoord setB, bool phase2)
+{
+    uint32_t size = (uint32_t)sizeA * sizeB;
+    table.resize(size);
+    CubieCube solved;
+    table.set((uint32_t)getA(solved) * sizeB + getB(solved), 0);
+    uint8_t moveCount = phase2 ? 10 : 18;
+    bool found = true;
+    for(uint8_t depth = 0; found && depth < 14; depth++)
+    {
+        found = false;
+        for(uint32_t index = 0; index < size; index++)
+        {
+            if(table.get(index) != depth) continue;
+            CubieCube cube;
+            setA(cube, index / sizeB);
+            setB(cube, index % sizeB);
+            for(uint8_t m = 0; m < moveCount; m++)
+            {
+                CubieCube next = cube;
+                next.applyMove(phase2 ? PHASE2_MOVES[m] : (MOVE)m);
+                uint32_t nextIndex = (uint32_t)getA(next) * sizeB + getB(next);
+                if(table.get(nextIndex) == 0xF)
+                {
+                    table.set(nextIndex, depth + 1);
+                    found = true;
+                }
+            }
+        }
+    }
+}
+
+TwoPhaseSolver::TwoPhaseSolver(const TwoPhaseTables &tables) : tables(tables)
+{
+    this->maxLength = 0;
+    this->length = 0;
+    this->nodes = 0;
+    this->budget = 0;
+}
+int8_t TwoPhaseSolver::solve(const CubieCube &cube, MOVE *solution, uint8_t maxLength, uint32_t budget)
+{
+    if(!this->tables.isBuilt()) return -1;
+    if(maxLength > TWO_PHASE_MAX_LENGTH) maxLength = TWO_PHASE_MAX_LENGTH;
+    this->maxLength = maxLength;
+    this->nodes = 0;
+    this->budget = budget;
+    for(uint8_t depth = this->tables.phase1Bound(cube); depth <= maxLength && this->nodes < budget; depth++)
+    {
+        if(!this->_phase1(cube, 0, depth, (uint8_t)FACE::NONE)) continue;
+        for(uint8_t i = 0; i < this->length; i++) solution[i] = this->path[i];
+        return this->length;
+    }
+    return -1;
+}
+uint32_t TwoPhaseSolver::getNodes() const
+{
+    return this->nodes;
+}
+bool TwoPhaseSolver::_phase1(const CubieCube &cube, uint8_t depth, uint8_t togo, uint8_t lastFace)
+{
+    if(++this->nodes > this->budget) return false;
+    if(this->tables.phase1Bound(cube) > togo) return false;
+    if(togo == 0)
+    {
+        // a phase 1 solution ending in a phase 2 move was already tried one move shorter
+        if(depth && (lastFace == (uint8_t)FACE::UP || lastFace == (uint8_t)FACE::DOWN || moveQuarters(this->path[depth - 1]) == 2)) return false;
+        return this->_solvePhase2(cube, depth, lastFace);
+    }
+    for(uint8_t face = 0; face < 6; face++)
+    {
+        if(skipAfter(face, lastFace)) continue;
+        for(uint8_t turn = 0; turn < 3; turn++)
+        {
+            CubieCube next = cube;
+            this->path[depth] = (MOVE)(face * 3 + turn);
+            next.applyMove(this->path[depth]);
+            if(this->_phase1(next, depth + 1, togo - 1, face)) return true;
+            if(this->nodes > this->budget) return false;
+        }
+    }
+    return false;
+}
+bool TwoPhaseSolver::_solvePhase2(const CubieCube &cube, uint8_t depth, uint8_t lastFace)
+{
+    for(uint8_t togo = this->tables.phase2Bound(cube); depth + togo <= this->maxLength; togo++)
+    {
+        if(this->_phase2(cube, depth, togo, lastFace))
+        {
+            this->length = depth + togo;
+            return true;
+        }
+        if(this->nodes > this->budget) return false;
+    }
+    return false;
+}
+bool TwoPhaseSolver::_phase2(const CubieCube &cube, uint8_t depth, uint8_t togo, uint8_t lastFace)
+{
+    if(++this->nodes > this->budget) return false;
+    uint8_t bound = this->tables.phase2Bound(cube);
+    if(bound > togo) return false;
+    if(togo == 0) return true;
+    for(uint8_t m = 0; m < 10; m++)
+    {
+        uint8_t face = (uint8_t)PHASE2_MOVES[m] / 3;
+        if(skipAfter(face, lastFace)) continue;
+        CubieCube next = cube;
+        this->path[depth] = PHASE2_MOVES[m];
+        next.applyMove(this->path[depth]);
+        if(this->_phase2(next, depth + 1, togo - 1, face)) return true;
+        if(this->nodes > this->budget) return false;
+    }
+    return false;
+}
+#endif
@@ -15,12 +15,52 @@
 #include <Arduino.h>
 #include "BLEDevice.h"
 #include "CubeModel.hpp"
+#include "CubePacket.hpp"
 #include "utils.hpp"
+#include "SolveTimer.hpp"
+#include "AlgMatcher.hpp"
+#include "TurnStats.hpp"
+#include "SessionStats.hpp"
+#include "SolveLog.hpp"
+#include "ScrambleVerifier.hpp"
+#include "ScrambleGenerator.hpp"
+#include "CornerTable.hpp"
+#include "F2lHints.hpp"
+#include "Timeline.hpp"
+#include "PowerStats.hpp"
+#include <LittleFS.h>
+#include "esp_timer.h"
 
 #define SHOW_SCAN_RESULT 0 // For showing bluetooth scan results without connecting to the cube.
 #define REGISTER_BATTERY_CALLBACK 0 // For seeing the battery level of cube
 #define MAX_CONNECT_RETRIES 10
 #define DEBUG_SERIAL_OUTPUT false
+#define AUTO_INSPECTION_DELAY 2000 // ms of stillness after scrambling before inspection starts, 0 - disabled
+#define NOTIFY_QUEUE_LENGTH 32
+#define SCRAMBLE_POOL_LENGTH 1 // random-state scrambles kept ready for "next", each ~1 - 2 min of CPU (ScrambleGenerator.hpp)
+#define SERIAL_MOVE_STREAM 0 // Also write each solve's range coded moves as a binary frame: 'M' 'S', moveCount, bytes (uint16 LE), data
+#define F2L_HINTS 0 // Print the shortest insertion of an F2L pair when the cube goes still during a CFOP solve's F2L
+#define F2L_HINT_NODES 30000 // search budget per hint, no hint beyond it. ~60 - 90 ms on the ESP32 (host ~10 M nodes/s, ~25x slower)
+#define SESSION_TIMELINE_MOVES 30000 // moves kept for "at <n>", ~1.2 bytes each
+/**
+ * Light sleep between notifications with BLE modem sleep. Not usable with the stock Arduino framework of platformio.ini:
+ * its prebuilt sdkconfig has neither CONFIG_PM_ENABLE nor CONFIG_FREERTOS_USE_TICKLESS_IDLE, so this only builds with a
+ * framework built with both (e.g. framework = arduino, espidf and an sdkconfig.defaults that sets them).
+ * The chip only sleeps when every task is blocked, so the scramble generator runs on request here: see scrambleTask().
+*/
+#define POWER_SAVE_MODE 0
+#define LOOP_POLL_MS (POWER_SAVE_MODE ? 500 : 20) // loop() sleeps between serial console polls, each poll is a wake-up
+#define DECODE_IDLE_MS 100 // the cube still this long: the last move is final, and the decode task does its idle work
+
+#if POWER_SAVE_MODE
+#if !defined(CONFIG_PM_ENABLE) || !defined(CONFIG_FREERTOS_USE_TICKLESS_IDLE)
+#error "POWER_SAVE_MODE needs a framework built with CONFIG_PM_ENABLE and CONFIG_FREERTOS_USE_TICKLESS_IDLE"
+#endif
+#include "esp_pm.h"
+#include "esp_bt.h"
+#include "esp_sleep.h"
+#include "driver/uart.h"
+#endif
 
 const String CUBE_MAC = "C2:B5:A6:8D:1E:73"; // Please change this to your own cube's MAC address
 static BLEUUID CUBE_DATA_SERVICE_UUID("0000aadb-0000-1000-8000-00805f9b34fb");
@@ -29,18 +69,65 @@ static BLEUUID CUBE_RW_SERVICE_UUID("0000aaaa-0000-1000-8000-00805f9b34fb");
 static BLEUUID CUBE_RW_READ_CHAR_UUID("0000aaab-0000-1000-8000-00805f9b34fb");
 static BLEUUID CUBE_RW_WRITE_CHAR_UUID("0000aaac-0000-1000-8000-00805f9b34fb");
 
-const static int AES_KEY[36] = {176,81,104,224,86,137,237,119,38,26,193,161,210,126,150,81,93,13,236,249,89,235,88,24,113,81,214,131,130,199,2,169,39,165,171,41}; // Keys to decrypt cube color data
-
 BLEAdvertisedDevice *pDevice;
 BLERemoteCharacteristic *pColorCharacter;
 bool deviceFound = false;
 bool deviceConnected = false;
 uint8_t batteryLevel = 0;
 
-// Return i-th half byte of pData
-uint8_t getHalfByte(uint8_t* pData, int i){
-  return i%2==1?(pData[(i/2)|0]%16):(0|(pData[(i/2)|0]/16));
-}
+// Raw notify with its arrival time, handed from the BLE callback to the decode task.
+struct NotifyPacket {
+  int64_t timestamp;
+  uint8_t data[20];
+};
+QueueHandle_t notifyQueue;
+// Scramble typed on the serial console ("scramble R U2 F' ..."), handed from loop() to the decode task.
+struct ScrambleCommand {
+  char notation[160];
+};
+QueueHandle_t scrambleQueue;
+// Random-state scrambles, filled by the generator task whenever there is room.
+QueueHandle_t scramblePool;
+#if POWER_SAVE_MODE
+SemaphoreHandle_t scrambleRequest; // given by "next" on an empty pool, the generator only runs on request
+volatile bool scrambleRequested = false; // until the requested scramble is in the pool
+#endif
+// Move numbers typed on the serial console ("at 57"), handed from loop() to the decode task that owns the timeline.
+QueueHandle_t seekQueue;
+// "power [mW]" and "power reset", handed from loop() to the decode task that owns powerStats.
+struct PowerCommand {
+  bool reset;
+  float milliwatts; // for the energy per move, 0 - not measured
+};
+QueueHandle_t powerQueue;
+// "method cfop|roux|zz", handed from loop() to the decode task that owns solveTimer.
+QueueHandle_t methodQueue;
+// The decode task blocks on all of its queues at once, so it sleeps until one of them has something.
+QueueSetHandle_t decodeEvents;
+TwoPhaseTables twoPhaseTables;
+FlashCornerTable cornerTable; // mapped from the cornerdb partition, see tools/gen_corner_table.cpp
+F2lHintTables f2lHintTables;
+F2lHints f2lHints(f2lHintTables);
+ScrambleVerifier scrambleVerifier;
+SolveTimer solveTimer;
+AlgMatcher algMatcher;
+TurnStats turnStats;
+SessionStats sessionStats;
+SolveLog solveLog;
+Timeline sessionTimeline; // every move since the cube was synced
+PowerStats powerStats;
+uint32_t loggedMoves = 0, loggedBytes = 0; // for bits per move of this session
+
+// Algorithms reported when executed during a solve: {name, notation}
+const static char *ALG_LIBRARY[][2] = {
+  {"Sexy", "R U R' U'"},
+  {"Sledgehammer", "R' F R F'"},
+  {"Sune", "R U R' U R U2 R'"},
+  {"Antisune", "R U2 R' U' R U' R'"},
+  {"T-Perm", "R U R' U' R' F R2 U' R' U' R U R' F'"},
+  {"Jb-Perm", "R U R' F' R U R' U' R' F R2 U' R'"},
+  {"Y-Perm", "F R U' R' U' R U R' F' R U R' U' R' F R F'"},
+};
 
 class AdvertisedDevCallback : public BLEAdvertisedDeviceCallbacks {
   void onResult(BLEAdvertisedDevice device){
@@ -124,25 +211,252 @@ bool registerBatteryCallback(BLEClient *client){
 }
 #endif
 static void onDataNotifyCallback(BLERemoteCharacteristic* pCharacter, uint8_t* pData, size_t length, bool isNotify){
-  #if DEBUG_SERIAL_OUTPUT
+  NotifyPacket packet;
+  packet.timestamp = esp_timer_get_time();
   if(length != 20){
+    #if DEBUG_SERIAL_OUTPUT
     Serial.print("Received data with invalid length: ");
     Serial.println(length);
+    #endif
     return;
   }
-  #endif
-  bool isEncrypted = pData[18] == 0xA7; // if pData[18] is 0xA7(167), then the color data is encrypted by AES.
-  if(isEncrypted){
-    uint8_t offset1 = getHalfByte(pData, 38);
-    uint8_t offset2 = getHalfByte(pData, 39);
-    for(int i = 0; i < 20; i++) pData[i] += (AES_KEY[offset1+i]+AES_KEY[offset2+i]); // Decrypt AES
+  memcpy(packet.data, pData, 20);
+  if(xQueueSend(notifyQueue, &packet, 0) != pdTRUE) Serial.println("Notify queue full, a move was dropped.");
+}
+static void printAverage(const char *name, uint32_t average){
+  if(average == AVERAGE_NONE) return;
+  Serial.print(name);
+  if(average == SOLVE_TIME_DNF) Serial.print("DNF");
+  else Serial.print(average / 1000000.0, 3);
+}
+static void addToSession(const SolveRecord &record){
+  if(record.flags & SOLVE_FLAG_DNF) sessionStats.add(SOLVE_TIME_DNF);
+  else sessionStats.add(record.solveTime + (record.flags & SOLVE_FLAG_PLUS_TWO ? 2000000 : 0));
+}
+static void onReplay(const LogRecord &record){
+  addToSession(record.solve);
+}
+#if SERIAL_MOVE_STREAM
+static void writeMoveFrame(const LogRecord &logged){
+  vector<uint8_t> data(logged.moveBytes);
+  if(!solveLog.readMoveData(logged, data.data())) return;
+  uint8_t header[6] = {'M', 'S', (uint8_t)logged.moveCount, (uint8_t)(logged.moveCount >> 8), (uint8_t)logged.moveBytes, (uint8_t)(logged.moveBytes >> 8)};
+  Serial.write(header, sizeof(header));
+  Serial.write(data.data(), logged.moveBytes);
+}
+#endif
+static void onSolve(const SolveRecord &record){
+  addToSession(record);
+  LogRecord logged;
+  if(solveLog.append(record, esp_timer_get_time()) && solveLog.getRecent(0, logged) && logged.moveCount){
+    loggedMoves += logged.moveCount;
+    loggedBytes += logged.moveBytes;
+    Serial.print("Logged ");
+    Serial.print(logged.moveBytes);
+    Serial.print(" bytes, ");
+    Serial.print(logged.moveBytes * 8.0 / logged.moveCount, 2);
+    Serial.print(" bits/move, session ");
+    Serial.print(loggedBytes * 8.0 / loggedMoves, 2);
+    Serial.println(" bits/move");
+    #if SERIAL_MOVE_STREAM
+    writeMoveFrame(logged);
+    #endif
+  }
+  Serial.print("Solve: ");
+  Serial.print(record.solveTime / 1000000.0, 3);
+  if(record.flags & SOLVE_FLAG_DNF) Serial.print(" DNF");
+  else if(record.flags & SOLVE_FLAG_PLUS_TWO) Serial.print(" +2");
+  Serial.print(" s, inspection ");
+  Serial.print(record.inspectionTime / 1000000.0, 3);
+  Serial.print(" s, ");
+  Serial.print(record.moveCount);
+  Serial.print(" moves (");
+  Serial.print(record.etm);
+  Serial.print(" ETM, ");
+  Serial.print(record.htm);
+  Serial.print(" HTM, ");
+  Serial.print(record.qtm);
+  Serial.println(" QTM)");
+  Serial.print("  TPS ");
+  Serial.print(record.solveTime ? record.moveCount * 1000000.0 / record.solveTime : 0, 2);
+  Serial.print(", last 5 s ");
+  Serial.print(turnStats.getTps5s(esp_timer_get_time()), 2);
+  Serial.print(", ");
+  Serial.print(turnStats.getPauses());
+  Serial.print(" pauses, longest ");
+  Serial.print(turnStats.getLongestGap() / 1000000.0, 3);
+  Serial.println(" s");
+  const MethodProfile &profile = METHOD_PROFILES[(record.flags & SOLVE_FLAG_METHOD_MASK) >> SOLVE_FLAG_METHOD_SHIFT];
+  Serial.print("  ");
+  Serial.println(profile.name);
+  uint32_t last = 0;
+  for(int i = 0; i < profile.stepCount; i++){
+    Serial.print("  ");
+    Serial.print(profile.steps[i].name);
+    Serial.print(": ");
+    Serial.print((record.splits[i] - last) / 1000000.0, 3);
+    Serial.println(" s");
+    last = record.splits[i];
+  }
+  if(record.ollCase != LL_UNKNOWN){
+    Serial.print("  OLL ");
+    Serial.print(record.ollCase);
+  }
+  if(record.pllCase != LL_UNKNOWN){
+    Serial.print(", PLL ");
+    Serial.print(PLL_NAMES[record.pllCase]);
+  }
+  Serial.println();
+  Serial.print("Session: ");
+  Serial.print(sessionStats.getSolves());
+  Serial.print(" solves");
+  printAverage(", mean ", sessionStats.getMean());
+  printAverage(", best ", sessionStats.getBest());
+  printAverage(", ao5 ", sessionStats.ao5.get());
+  printAverage(", ao12 ", sessionStats.ao12.get());
+  printAverage(", ao50 ", sessionStats.ao50.get());
+  printAverage(", ao100 ", sessionStats.ao100.get());
+  printAverage(", ao1000 ", sessionStats.ao1000.get());
+  Serial.println();
+}
+static void onAlgMatch(const AlgMatch &match){
+  Serial.print("Alg: ");
+  Serial.print(algMatcher.getName(match.alg));
+  Serial.print(" in ");
+  Serial.print((match.endTime - match.startTime) / 1000000.0, 3);
+  Serial.println(" s");
+}
+static void onScrambleMove(SCRAMBLE_STATE state, int64_t timestamp){
+  switch(state){
+    case SCRAMBLE_STATE::ON_PATH:
+    case SCRAMBLE_STATE::HALF_TURN:
+      Serial.print("Scramble ");
+      Serial.print(scrambleVerifier.getIndex());
+      Serial.print('/');
+      Serial.print(scrambleVerifier.getLength());
+      Serial.print(state == SCRAMBLE_STATE::HALF_TURN ? ", finish " : ", next ");
+      Serial.println(moveToString(scrambleVerifier.getNextMove()).c_str());
+      break;
+    case SCRAMBLE_STATE::OFF_PATH:
+      if(!scrambleVerifier.getCorrectionLength()){
+        Serial.println("Scramble lost, solve the cube and start again.");
+        break;
+      }
+      Serial.print("Wrong move, correct with:");
+      for(uint8_t i = 0; i < scrambleVerifier.getCorrectionLength(); i++){
+        Serial.print(' ');
+        Serial.print(moveToString(scrambleVerifier.getCorrection(i)).c_str());
+      }
+      Serial.println();
+      break;
+    case SCRAMBLE_STATE::DONE:
+      Serial.println("Scramble verified, inspection starts.");
+      scrambleVerifier.end();
+      solveTimer.startInspection(timestamp);
+      break;
+    default:
+      break;
+  }
+}
+// Only from a solved cube: the target is then the scrambled state itself, and the timer is SOLVED, where scramble moves
+// cannot start a solve and DONE's startInspection() finds it SCRAMBLED.
+static void startScramble(const char *notation){
+  if(!solveTimer.isSynced()){
+    Serial.println("No cube connected.");
+    return;
+  }
+  if(!solveTimer.getCube().isSolved() || solveTimer.getState() != TIMER_STATE::SOLVED){
+    Serial.println("Solve the cube first, scrambles start from a solved cube.");
+    return;
   }
+  if(!scrambleVerifier.begin(solveTimer.getCube(), notation)){
+    Serial.println("Invalid scramble.");
+    return;
+  }
+  Serial.print("Scramble 0/");
+  Serial.print(scrambleVerifier.getLength());
+  Serial.print(", next ");
+  Serial.println(moveToString(scrambleVerifier.getNextMove()).c_str());
+}
+#if F2L_HINTS
+bool f2lHintPending = false; // a move of the solve came since the last hint
+// Runs from the idle branch of the decode task, so a search never delays the moves of a fingertrick sequence.
+// ~250 nodes for the first pair and ~3,000 for the last on average, up to ~85,000 (cut at F2L_HINT_NODES). The time
+// printed with each hint is the one measured on the device.
+static void printF2lHint(){
+  const CfopTracker &cfop = solveTimer.getCfop();
+  if(solveTimer.getState() != TIMER_STATE::SOLVING || solveTimer.getMethodTracker().getMethod() != METHOD::CFOP) return;
+  if(cfop.getStep() < CFOP_STEP::F2L_1 || cfop.getStep() > CFOP_STEP::F2L_4) return;
+  F2lHints::Hint hint;
+  uint64_t start = esp_timer_get_time();
+  if(!f2lHints.find(solveTimer.getCube(), cfop.getCrossFace(), hint, F2L_HINT_MAX_LENGTH, F2L_HINT_NODES)) return;
+  uint32_t time = esp_timer_get_time() - start;
+  Serial.print("F2L hint:");
+  for(uint8_t i = 0; i < hint.length; i++){
+    Serial.print(' ');
+    Serial.print(moveToString(hint.moves[i]).c_str());
+  }
+  Serial.print(" (");
+  Serial.print(f2lHints.getNodes());
+  Serial.print(" nodes, ");
+  Serial.print(time);
+  Serial.println(" us)");
+}
+#endif
+// Takes over a full decoded state: after connecting, or when the tracked cube no longer matches the packets.
+// A solve in progress is dropped without a record, and the timeline starts again from this state.
+static void resync(const CubeModel &cube, uint64_t timestamp){
+  solveTimer.sync(cube, timestamp);
+  sessionTimeline.begin(cube);
+  if(scrambleVerifier.getState() != SCRAMBLE_STATE::IDLE){
+    scrambleVerifier.end();
+    Serial.println("Scramble stopped, start it again.");
+  }
+}
+static void decodePacket(NotifyPacket &packet){
+  uint8_t *pData = packet.data;
+  decryptPacket(pData); // if pData[18] is 0xA7(167), then the color data is encrypted by AES.
   uint8_t colorData[36] = {0};
   for(int i = 0; i < 36; i++) colorData[i] = getHalfByte(pData, i);
   CubeModel newCube = CubeModel(colorData);
+  if(!solveTimer.isSynced()) resync(newCube, packet.timestamp);
+  else{
+    if(sessionTimeline.size() < SESSION_TIMELINE_MOVES) sessionTimeline.append(newCube.turnedMove());
+    TIMER_STATE before = solveTimer.getState();
+    // A move in inspection always starts the solve. Stats are fed first, so they are complete when onSolve() runs.
+    if(before == TIMER_STATE::INSPECTION){
+      algMatcher.reset();
+      turnStats.reset();
+      solveLog.startSolve();
+    }
+    if(before == TIMER_STATE::INSPECTION || before == TIMER_STATE::SOLVING){
+      algMatcher.onMove(newCube.turnedMove(), packet.timestamp);
+      turnStats.onMove(newCube.turnedMove(), packet.timestamp);
+      solveLog.onMove(newCube.turnedMove(), packet.timestamp);
+    }
+    solveTimer.onMove(newCube.turnedMove(), packet.timestamp);
+    // every packet carries the whole state, so a dropped notify or a misread turn shows up here
+    if(solveTimer.getCube() != newCube){
+      Serial.println("Lost track of the cube, synced again from its state.");
+      resync(newCube, packet.timestamp);
+    }
+    else{
+      TIMER_STATE after = solveTimer.getState();
+      if(after == TIMER_STATE::SOLVED && before == TIMER_STATE::SOLVING) algMatcher.flush();
+      #if F2L_HINTS
+      if(after == TIMER_STATE::SOLVING) f2lHintPending = true;
+      #endif
+      if(scrambleVerifier.getState() != SCRAMBLE_STATE::IDLE) onScrambleMove(scrambleVerifier.onMove(newCube.turnedMove()), packet.timestamp);
+    }
+  }
   #if DEBUG_SERIAL_OUTPUT
   if(newCube.isSolved()) Serial.println("Cube is solved.");
   printCube(newCube);
+  if(cornerTable.isReady()){
+    Serial.print("Corners: at least ");
+    Serial.print(cornerTable.bound(CubieCube(newCube)));
+    Serial.println(" moves from solved");
+  }
   for(int i = 0; i < 36; i++){
     Serial.print(colorData[i], HEX);
     if(i == 7 || i == 15 || i == 27 || i == 31) Serial.println();
@@ -151,11 +465,157 @@ static void onDataNotifyCallback(BLERemoteCharacteristic* pCharacter, uint8_t* p
   Serial.println();
   Serial.println("--------------------");
   #else
-  Serial.print((uint8_t)newCube.turnedFace);
+  Serial.print(colorData[32]);
   Serial.print(' ');
   Serial.println(newCube.turnedDir);
   #endif
 }
+// The cube after the first index moves of the session.
+static void printTimeline(uint32_t index){
+  CubieCube cube;
+  if(!sessionTimeline.seek(index, cube)){
+    Serial.print("Only ");
+    Serial.print(sessionTimeline.size());
+    Serial.println(" moves so far.");
+    return;
+  }
+  Serial.print("After move ");
+  Serial.print(index);
+  if(index > 0){
+    Serial.print(", ");
+    Serial.print(moveToString(sessionTimeline.getMove(index - 1)).c_str());
+  }
+  Serial.println(":");
+  CubeModel model = cube.toCubeModel();
+  printCube(model);
+}
+static void printPower(float milliwatts){
+  uint64_t now = esp_timer_get_time();
+  Serial.print(POWER_SAVE_MODE ? "Light sleep, " : "Always on, ");
+  Serial.print(powerStats.getCount());
+  Serial.print(" notifies in ");
+  Serial.print(powerStats.getElapsed(now) / 1000000.0, 0);
+  Serial.println(" s");
+  Serial.print("Notify latency: mean ");
+  Serial.print(powerStats.getLatencyMean());
+  Serial.print(" us, p50 < ");
+  Serial.print(powerStats.getLatencyPercentile(50));
+  Serial.print(" us, p99 < ");
+  Serial.print(powerStats.getLatencyPercentile(99));
+  Serial.print(" us, max ");
+  Serial.print(powerStats.getLatencyMax());
+  Serial.println(" us");
+  if(milliwatts > 0){
+    Serial.print("Energy per move: ");
+    Serial.print(powerStats.getEnergyPerMove(now, milliwatts), 2);
+    Serial.println(" mJ");
+  }
+  else Serial.println("Give the measured average power (\"power <mW>\") for the energy per move.");
+}
+// Decoding and timing run here instead of in the BLE callback, so the callback only stamps and queues the packet.
+// With nothing left to do (no idle work, no inspection to start) the task waits without a timeout.
+static void decodeTask(void *param){
+  NotifyPacket packet;
+  ScrambleCommand command;
+  uint32_t index;
+  PowerCommand power;
+  METHOD method;
+  TickType_t wait = portMAX_DELAY;
+  while(true){
+    QueueSetMemberHandle_t ready = xQueueSelectFromSet(decodeEvents, wait);
+    wait = pdMS_TO_TICKS(DECODE_IDLE_MS);
+    if(ready == notifyQueue && xQueueReceive(notifyQueue, &packet, 0) == pdTRUE){
+      decodePacket(packet);
+      powerStats.onNotify(packet.timestamp, esp_timer_get_time());
+    }
+    else if(ready == scrambleQueue && xQueueReceive(scrambleQueue, &command, 0) == pdTRUE) startScramble(command.notation);
+    else if(ready == seekQueue && xQueueReceive(seekQueue, &index, 0) == pdTRUE) printTimeline(index);
+    else if(ready == powerQueue && xQueueReceive(powerQueue, &power, 0) == pdTRUE){
+      if(power.reset) powerStats.reset(esp_timer_get_time());
+      else printPower(power.milliwatts);
+    }
+    else if(ready == methodQueue && xQueueReceive(methodQueue, &method, 0) == pdTRUE) solveTimer.setMethod(method);
+    else if(!ready){
+      algMatcher.flush(); // the cube went still, the last move is final
+      #if F2L_HINTS
+      if(f2lHintPending){
+        f2lHintPending = false;
+        printF2lHint();
+      }
+      #endif
+      solveLog.maintain(esp_timer_get_time()); // flash writes only happen while idle
+      if(!solveLog.hasWork()) wait = portMAX_DELAY;
+    }
+    // while a scramble is verified, its DONE starts inspection instead of a pause
+    if(scrambleVerifier.getState() != SCRAMBLE_STATE::IDLE) continue;
+    uint64_t now = esp_timer_get_time();
+    solveTimer.update(now);
+    uint64_t deadline = solveTimer.getInspectionDeadline();
+    if(deadline){
+      TickType_t untilInspection = deadline > now ? pdMS_TO_TICKS((deadline - now) / 1000 + 1) : 1;
+      if(wait == portMAX_DELAY || untilInspection < wait) wait = untilInspection;
+    }
+  }
+}
+static uint32_t hardwareRandom(){
+  return esp_random(); // true random while the radio is on
+}
+// Lowest priority: a scramble takes ~1 - 2 minutes here (estimated, several for the hard states), and only runs when nothing
+// else has to. With one scramble in the pool, the task is busy after boot and after each "next" until the pool is full again.
+// Light sleep needs every task blocked, and this one is runnable all that time, so in power save builds it waits for a
+// "next" on an empty pool instead: the minutes of CPU are then spent only when asked for, and "next" has to wait for them.
+static void scrambleTask(void *param){
+  ScrambleGenerator generator(twoPhaseTables, hardwareRandom);
+  Scramble scramble;
+  while(true){
+    #if POWER_SAVE_MODE
+    xSemaphoreTake(scrambleRequest, portMAX_DELAY);
+    #endif
+    twoPhaseTables.build();
+    if(generator.generate(scramble)) xQueueSend(scramblePool, &scramble, portMAX_DELAY);
+    #if POWER_SAVE_MODE
+    scrambleRequested = false;
+    Serial.println("Scramble ready, type next.");
+    #endif
+  }
+}
+#if POWER_SAVE_MODE
+// Light sleep whenever all tasks are blocked. The BLE controller holds a lock while its radio is on, and modem sleep
+// releases it between connection events. UART input wakes the chip, but the characters that wake it are lost.
+static void enablePowerSave(){
+  esp_pm_config_esp32_t config = {};
+  config.max_freq_mhz = 240;
+  config.min_freq_mhz = 80;
+  config.light_sleep_enable = true;
+  esp_err_t err = esp_pm_configure(&config);
+  if(err == ESP_OK) err = esp_bt_sleep_enable();
+  if(err == ESP_OK){
+    uart_set_wakeup_threshold(UART_NUM_0, 3);
+    esp_sleep_enable_uart_wakeup(UART_NUM_0);
+  }
+  Serial.print("Power save: ");
+  Serial.println(err == ESP_OK ? "light sleep between notifications" : esp_err_to_name(err));
+}
+#endif
+static void nextScramble(){
+  Scramble scramble;
+  if(xQueueReceive(scramblePool, &scramble, 0) != pdTRUE){
+    Serial.println("No scramble ready yet, one takes a minute or two.");
+    #if POWER_SAVE_MODE
+    if(!scrambleRequested){
+      scrambleRequested = true;
+      xSemaphoreGive(scrambleRequest);
+    }
+    #endif
+    return;
+  }
+  ScrambleCommand command;
+  strncpy(command.notation, scramble.toString().c_str(), sizeof(command.notation) - 1);
+  command.notation[sizeof(command.notation) - 1] = 0;
+  Serial.print("Scramble: ");
+  Serial.println(command.notation);
+  xQueueSend(scrambleQueue, &command, 0);
+}
 bool connectToServer(BLEAdvertisedDevice device){
   bool connected = false;
   #if DEBUG_SERIAL_OUTPUT
@@ -217,7 +677,44 @@ bool connectToServer(BLEAdvertisedDevice device){
 void setup(){
   digitalWrite(LED_BUILTIN, LOW);
   Serial.begin(115200);
+  notifyQueue = xQueueCreate(NOTIFY_QUEUE_LENGTH, sizeof(NotifyPacket));
+  scrambleQueue = xQueueCreate(2, sizeof(ScrambleCommand));
+  scramblePool = xQueueCreate(SCRAMBLE_POOL_LENGTH, sizeof(Scramble));
+  #if POWER_SAVE_MODE
+  scrambleRequest = xSemaphoreCreateBinary();
+  #endif
+  seekQueue = xQueueCreate(2, sizeof(uint32_t));
+  powerQueue = xQueueCreate(2, sizeof(PowerCommand));
+  methodQueue = xQueueCreate(2, sizeof(METHOD));
+  decodeEvents = xQueueCreateSet(NOTIFY_QUEUE_LENGTH + 2 + 2 + 2 + 2);
+  xQueueAddToSet(notifyQueue, decodeEvents);
+  xQueueAddToSet(scrambleQueue, decodeEvents);
+  xQueueAddToSet(seekQueue, decodeEvents);
+  xQueueAddToSet(powerQueue, decodeEvents);
+  xQueueAddToSet(methodQueue, decodeEvents);
+  if(LittleFS.begin(true) && solveLog.begin()){
+    solveLog.replay(1000, onReplay);
+    Serial.print("Solve log: ");
+    Serial.print(solveLog.size());
+    Serial.println(" solves");
+  }
+  else Serial.println("Failed to open the solve log.");
+  if(cornerTable.begin()) Serial.println("Corner table mapped from flash.");
+  else Serial.println("No corner table in flash, see tools/gen_corner_table.cpp.");
+  #if F2L_HINTS
+  f2lHintTables.build();
+  #endif
+  solveTimer.setInspectionDelay(AUTO_INSPECTION_DELAY * 1000);
+  solveTimer.setCallback(onSolve);
+  for(auto &alg : ALG_LIBRARY) algMatcher.addAlgorithm(alg[0], alg[1]);
+  algMatcher.build();
+  algMatcher.setCallback(onAlgMatch);
+  xTaskCreate(decodeTask, "decode", 8192, nullptr, 2, nullptr);
+  xTaskCreate(scrambleTask, "scramble", 8192, nullptr, tskIDLE_PRIORITY, nullptr);
   BLEDevice::init("");
+  #if POWER_SAVE_MODE
+  enablePowerSave();
+  #endif
   BLEScan *pBLEScan = BLEDevice::getScan();
   pBLEScan->setAdvertisedDeviceCallbacks(new AdvertisedDevCallback);
   pBLEScan->setActiveScan(true);
@@ -234,4 +731,35 @@ void loop(){
   if(deviceFound){
 
   }
+  if(Serial.available()){
+    String line = Serial.readStringUntil('\n');
+    line.trim();
+    if(line.startsWith("scramble ")){
+      ScrambleCommand command;
+      strncpy(command.notation, line.c_str() + 9, sizeof(command.notation) - 1);
+      command.notation[sizeof(command.notation) - 1] = 0;
+      xQueueSend(scrambleQueue, &command, 0);
+    }
+    else if(line == "next") nextScramble();
+    else if(line == "power" || line.startsWith("power ")){
+      PowerCommand command;
+      command.reset = line == "power reset";
+      command.milliwatts = command.reset || line.length() <= 6 ? 0 : atof(line.c_str() + 6);
+      xQueueSend(powerQueue, &command, 0);
+    }
+    else if(line.startsWith("at ")){
+      uint32_t index = strtoul(line.c_str() + 3, nullptr, 10);
+      xQueueSend(seekQueue, &index, 0);
+    }
+    else if(line.startsWith("method ")){
+      METHOD method = parseMethod(line.c_str() + 7);
+      if(method == (METHOD)METHOD_COUNT) Serial.println("Unknown method, use cfop, roux or zz.");
+      else{
+        xQueueSend(methodQueue, &method, 0);
+        Serial.print("Splits from the next solve: ");
+        Serial.println(METHOD_PROFILES[(uint8_t)method].name);
+      }
+    }
+  }
+  delay(LOOP_POLL_MS); // lets the idle task run, which is where the CPU sleeps
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <Arduino.h>
 #include <CubeModel.hpp>
+#include <FaceletCube.hpp>
 string colorToString(COLOR color)
 {
     switch(color)
@@ -20,51 +21,48 @@ string colorToString(COLOR color)
             return "X";
     }
 }
-void printCube(CubeModel &cube)
+void printCube(const FaceletCube &cube)
 {
-    array<array<COLOR, 3>, 3> tempFaceColor;
     string res = "";
     // First print UP face
-    tempFaceColor = cube.getFaceColors(FACE::UP);
     for(uint8_t i = 0; i < 3; i++)
     {
         Serial.print("      ");
         for(uint8_t j = 0; j < 3; j++)
         {
-            res = colorToString(tempFaceColor[i][j]);
+            res = colorToString(cube.getColor(FACE::UP, i, j));
             Serial.print(res.c_str());
             Serial.print(" ");
         }
         Serial.println();
     }
-    array<array<array<COLOR, 3>, 3>, 4> tempFaceColors;
-    tempFaceColors[0] = cube.getFaceColors(FACE::LEFT);
-    tempFaceColors[1] = cube.getFaceColors(FACE::FRONT);
-    tempFaceColors[2] = cube.getFaceColors(FACE::RIGHT);
-    tempFaceColors[3] = cube.getFaceColors(FACE::BACK);
+    const FACE sides[4] = {FACE::LEFT, FACE::FRONT, FACE::RIGHT, FACE::BACK};
     for(uint8_t i = 0; i < 3; i++)
     {
         for(uint8_t p = 0; p < 4; p++)
         {
             for(uint8_t j = 0; j < 3; j++)
             {
-                res = colorToString(tempFaceColors[p][i][j]);
+                res = colorToString(cube.getColor(sides[p], i, j));
                 Serial.print(res.c_str());
                 Serial.print(" ");
             }
         }
         Serial.println();
     }
-    tempFaceColor = cube.getFaceColors(FACE::DOWN);
     for(uint8_t i = 0; i < 3; i++)
     {
         Serial.print("      ");
         for(uint8_t j = 0; j < 3; j++)
         {
-            res = colorToString(tempFaceColor[i][j]);
+            res = colorToString(cube.getColor(FACE::DOWN, i, j));
             Serial.print(res.c_str());
             Serial.print(" ");
         }
         Serial.println();
     }
+}
+void printCube(CubeModel &cube)
+{
+    printCube(FaceletCube(cube));
 }
\ No newline at end of file
@@ -0,0 +1,81 @@
+/**
+ * @author Matrixchung
+ * @brief  The cubeData of a tracked cube, as the cube would send it, decodes back to the same state.
+ *
+ * Run: pio test -e native
+ *
+ * **/
+#include <unity.h>
+#include <random>
+#include "CubeModel.hpp"
+
+// The 36 half bytes of CubeModel(const uint8_t *data), without the turned faces.
+static void encode(const CubeModel &cube, uint8_t *data)
+{
+    memset(data, 0, 36);
+    uint16_t flips = 0;
+    for(uint8_t i = 0; i < 8; i++)
+    {
+        CubeModel::Cubie corner = cube.getCorner((CORNER)i);
+        data[i] = corner.index + 1;
+        data[i + 8] = (uint8_t)corner.orientation;
+    }
+    for(uint8_t i = 0; i < 12; i++)
+    {
+        CubeModel::Cubie edge = cube.getEdge((EDGE)i);
+        data[i + 16] = edge.index + 1;
+        if(edge.orientation == DIR::FLIPPED) flips |= 1u << (11 - i);
+    }
+    data[28] = flips >> 8;
+    data[29] = flips >> 4 & 0x0F;
+    data[30] = flips & 0x0F;
+}
+
+// Tracks the moves, then decodes the state back and checks its flipped edges.
+static void checkFlips(const char *notation, uint16_t expected)
+{
+    MOVE moves[16];
+    int16_t count = parseMoves(notation, moves, 16);
+    CubeModel cube;
+    for(int16_t i = 0; i < count; i++) cube.applyMove(moves[i]);
+    uint8_t data[36];
+    encode(cube, data);
+    TEST_ASSERT_EQUAL_HEX16(expected, data[28] << 8 | data[29] << 4 | data[30]);
+    TEST_ASSERT_TRUE(CubeModel(data) == cube);
+}
+
+// The patterns the cube sends after single turns, and sequences flipping other sets of edges.
+void test_flip_patterns(void)
+{
+    checkFlips("F", 0x262);
+    checkFlips("B", 0x898);
+    checkFlips("F B", 0xAFA);
+    checkFlips("F R", 0x342);
+    checkFlips("F U", 0x462);
+    checkFlips("F R U' B D2 L F'", 0xB5E);
+}
+
+// Every state along random move sequences, as main.cpp compares them after each move.
+void test_random_sequences(void)
+{
+    std::mt19937 random(1);
+    for(uint16_t s = 0; s < 200; s++)
+    {
+        CubeModel cube;
+        for(uint8_t i = 0; i < 40; i++)
+        {
+            cube.applyMove((MOVE)(random() % 18));
+            uint8_t data[36];
+            encode(cube, data);
+            TEST_ASSERT_TRUE(CubeModel(data) == cube);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_flip_patterns);
+    RUN_TEST(test_random_sequences);
+    return UNITY_END();
+}
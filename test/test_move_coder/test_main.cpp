@@ -0,0 +1,142 @@
+/**
+ * @author Matrixchung
+ * @brief  Round trips of MoveEncoder / MoveDecoder, and SolveLog reading moves stored before the range coder (varints).
+ *
+ * Run: pio test -e native
+ *
+ * **/
+#include <unity.h>
+#include <cstdlib>
+#include <random>
+#include "MoveCoder.hpp"
+#include "SolveLog.hpp"
+
+#define TEST_MAX_MOVES 256
+
+static uint8_t buffer[4096];
+
+static void roundTrip(const MOVE *moves, const uint32_t *deltas, uint16_t count)
+{
+    MoveEncoder encoder;
+    encoder.begin(buffer, sizeof(buffer));
+    for(uint16_t i = 0; i < count; i++) encoder.encode(moves[i], deltas[i]);
+    uint16_t length = encoder.finish();
+    TEST_ASSERT_FALSE(encoder.overflowed());
+    MoveDecoder decoder;
+    decoder.begin(buffer, length);
+    for(uint16_t i = 0; i < count; i++)
+    {
+        MOVE move;
+        uint32_t delta;
+        TEST_ASSERT_TRUE(decoder.decode(move, delta));
+        TEST_ASSERT_EQUAL_UINT8((uint8_t)moves[i], (uint8_t)move);
+        TEST_ASSERT_EQUAL_UINT32(deltas[i], delta);
+    }
+}
+
+// Finger trick pace, 90 - 240 ms between turns: the Rice path only.
+void test_solve_pace(void)
+{
+    std::mt19937 random(1);
+    MOVE moves[TEST_MAX_MOVES];
+    uint32_t deltas[TEST_MAX_MOVES];
+    for(uint16_t i = 0; i < TEST_MAX_MOVES; i++)
+    {
+        moves[i] = (MOVE)(random() % 18);
+        deltas[i] = i ? 90 + random() % 150 : 0;
+    }
+    roundTrip(moves, deltas, TEST_MAX_MOVES);
+}
+
+// Pauses long enough to escape, up to the full 32 bits.
+void test_escaped_deltas(void)
+{
+    const uint32_t deltas[] = {0, 120, 60000, 100, 1u << 20, 150, 0x7FFFFFFFu, 1u << 31, 0xFFFFFFFFu, 80, 0x80000001u, 0, 16, 3000000000u};
+    const uint16_t count = sizeof(deltas) / sizeof(deltas[0]);
+    MOVE moves[count];
+    for(uint16_t i = 0; i < count; i++) moves[i] = (MOVE)(i * 5 % 18);
+    roundTrip(moves, deltas, count);
+}
+
+// Every escape length: the mean is pulled up and down between them, so k and the escape threshold move as well.
+void test_every_length(void)
+{
+    MOVE moves[2 * 33];
+    uint32_t deltas[2 * 33];
+    for(uint8_t bits = 0; bits <= 32; bits++)
+    {
+        moves[2 * bits] = MOVE::R;
+        deltas[2 * bits] = bits ? (uint32_t)(0xFFFFFFFFull >> (32 - bits)) : 0;
+        moves[2 * bits + 1] = MOVE::U_;
+        deltas[2 * bits + 1] = 1;
+    }
+    roundTrip(moves, deltas, 2 * 33);
+}
+
+// A log written before the range coder: one record whose moves are varints of (ms since the previous move << 5 | MOVE).
+void test_varint_record(void)
+{
+    char root[] = "/tmp/move_coder_XXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(root));
+    const MOVE moves[] = {MOVE::R, MOVE::U, MOVE::R_, MOVE::U_, MOVE::F2, MOVE::D};
+    const uint32_t deltas[] = {0, 130, 95, 2000, 70000, 1};
+    const uint16_t count = sizeof(moves) / sizeof(moves[0]);
+    uint8_t data[64];
+    uint16_t bytes = 0;
+    for(uint16_t i = 0; i < count; i++)
+    {
+        uint32_t value = deltas[i] << 5 | (uint8_t)moves[i];
+        for(; value >= 0x80; value >>= 7) data[bytes++] = (value & 0x7F) | 0x80;
+        data[bytes++] = value;
+    }
+    LogRecord record;
+    memset(&record, 0, sizeof(record));
+    record.magic = SOLVE_LOG_MAGIC;
+    record.moveBytes = bytes;
+    record.moveCount = count;
+    record.moveFormat = SOLVE_LOG_MOVES_VARINT;
+    record.crc = crc32Update((const uint8_t *)&record, offsetof(LogRecord, crc));
+    MovesHeader header = {SOLVE_LOG_MOVES_MAGIC, 0};
+    char path[64];
+    snprintf(path, sizeof(path), "%s/solves.log", root);
+    FILE *file = fopen(path, "wb");
+    TEST_ASSERT_NOT_NULL(file);
+    fwrite(&record, sizeof(record), 1, file);
+    fclose(file);
+    snprintf(path, sizeof(path), "%s/moves.log", root);
+    file = fopen(path, "wb");
+    TEST_ASSERT_NOT_NULL(file);
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(data, 1, bytes, file);
+    fclose(file);
+
+    SolveLog log;
+    TEST_ASSERT_TRUE(log.begin(root));
+    TEST_ASSERT_EQUAL_UINT32(1, log.size());
+    LogRecord read;
+    TEST_ASSERT_TRUE(log.getRecent(0, read));
+    MOVE decoded[count];
+    uint32_t times[count], time = 0;
+    TEST_ASSERT_EQUAL_INT16(count, log.readMoves(read, decoded, times, count));
+    for(uint16_t i = 0; i < count; i++)
+    {
+        time += deltas[i];
+        TEST_ASSERT_EQUAL_UINT8((uint8_t)moves[i], (uint8_t)decoded[i]);
+        TEST_ASSERT_EQUAL_UINT32(time, times[i]);
+    }
+    snprintf(path, sizeof(path), "%s/solves.log", root);
+    remove(path);
+    snprintf(path, sizeof(path), "%s/moves.log", root);
+    remove(path);
+    rmdir(root);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_solve_pace);
+    RUN_TEST(test_escaped_deltas);
+    RUN_TEST(test_every_length);
+    RUN_TEST(test_varint_record);
+    return UNITY_END();
+}
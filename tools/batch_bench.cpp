@@ -0,0 +1,134 @@
+/**
+ * @author Matrixchung
+ * @brief  CubeBatch against loops over CubeModel and CubieCube, in ns per state for each operation.
+ *
+ * Build: g++ -O2 -std=gnu++17 -I src tools/batch_bench.cpp -o batch_bench
+ * Usage: ./batch_bench [states, 100000] [rounds, 20]
+ *
+ * States are random move sequences of 0 - 24 moves, so some are solved or have the cross. Every batch result is
+ * checked against the loops.
+ *
+ * **/
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include "CubeBatch.hpp"
+#include "CfopTracker.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static double seconds(Clock::time_point from)
+{
+    return std::chrono::duration<double>(Clock::now() - from).count();
+}
+static uint32_t failed = 0;
+// model < 0: CubeModel has no such operation
+static void report(const char *name, double model, double cubie, double batch, size_t states, uint32_t rounds, bool ok)
+{
+    double scale = 1e9 / states / rounds;
+    printf("%-12s  ", name);
+    if(model < 0) printf("%9s", "-");
+    else printf("%9.2f", model * scale);
+    printf("  %9.2f  %9.2f  %10.1fx%s\n", cubie * scale, batch * scale, cubie / batch, ok ? "" : "  FAILED");
+    if(!ok) failed++;
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000;
+    uint32_t rounds = argc > 2 ? atoi(argv[2]) : 20;
+    std::mt19937 random(1);
+    vector<CubeModel> models(n), others(n);
+    vector<CubieCube> cubies(n);
+    CubeBatch batch(n), otherBatch(n);
+    for(size_t i = 0; i < n; i++)
+    {
+        uint8_t length = random() % 25;
+        for(uint8_t m = 0; m < length; m++) models[i].applyMove((MOVE)(random() % 18));
+        others[i] = random() % 2 ? models[i] : CubeModel();
+        cubies[i] = CubieCube(models[i]);
+        batch.set(i, models[i]);
+        otherBatch.set(i, others[i]);
+    }
+    vector<uint8_t> expected(n), out(n);
+    vector<uint16_t> expectedCoord(n), coord(n);
+    const uint32_t cross = CROSS_MASK[(uint8_t)FACE::DOWN];
+    Clock::time_point start;
+    double model, cubie, batched;
+    size_t sink = 0;
+    printf("ns / state    CubeModel  CubieCube  CubeBatch  vs CubieCube\n");
+
+    start = Clock::now();
+    for(uint32_t r = 0; r < rounds; r++) for(size_t i = 0; i < n; i++) sink += expected[i] = models[i].isSolved();
+    model = seconds(start);
+    start = Clock::now();
+    for(uint32_t r = 0; r < rounds; r++) for(size_t i = 0; i < n; i++) sink += cubies[i].isSolved();
+    cubie = seconds(start);
+    start = Clock::now();
+    for(uint32_t r = 0; r < rounds; r++) sink += batch.isSolved(out.data());
+    batched = seconds(start);
+    report("isSolved", model, cubie, batched, n, rounds, out == expected);
+
+    start = Clock::now();
+    for(uint32_t r = 0; r < rounds; r++) for(size_t i = 0; i < n; i++) sink += expected[i] = (models[i].getSolvedMask() & cross) == cross;
+    model = seconds(start);
+    start = Clock::now();
+    for(uint32_t r = 0; r < rounds; r++) for(size_t i = 0; i < n; i++)
+    {
+        bool home = true;
+        for(uint8_t s = 8; s < 12; s++) home = home && cubies[i].ep[s] == s && !cubies[i].eo[s];
+        sink += home;
+    }
+    cubie = seconds(start);
+    start = Clock::now();
+    for(uint32_t r = 0; r < rounds; r++) sink += batch.piecesSolved(cross, out.data());
+    batched = seconds(start);
+    report("cross solved", model, cubie, batched, n, rounds, out == expected);
+
+    vector<CubieCube> otherCubies(n);
+    for(size_t i = 0; i < n; i++) otherCubies[i] = CubieCube(others[i]);
+    start = Clock::now();
+    for(uint32_t r = 0; r < rounds; r++) for(size_t i = 0; i < n; i++) sink += expected[i] = models[i] == others[i];
+    model = seconds(start);
+    start = Clock::now();
+    for(uint32_t r = 0; r < rounds; r++) for(size_t i = 0; i < n; i++) sink += cubies[i] == otherCubies[i];
+    cubie = seconds(start);
+    start = Clock::now();
+    for(uint32_t r = 0; r < rounds; r++) sink += batch.equals(otherBatch, out.data());
+    batched = seconds(start);
+    report("equals", model, cubie, batched, n, rounds, out == expected);
+
+    start = Clock::now();
+    for(uint32_t r = 0; r < rounds; r++) for(size_t i = 0; i < n; i++) sink += expectedCoord[i] = cubies[i].getTwist();
+    cubie = seconds(start);
+    start = Clock::now();
+    for(uint32_t r = 0; r < rounds; r++) batch.getTwist(coord.data());
+    batched = seconds(start);
+    report("twist", -1, cubie, batched, n, rounds, coord == expectedCoord);
+
+    start = Clock::now();
+    for(uint32_t r = 0; r < rounds; r++) for(size_t i = 0; i < n; i++) sink += expectedCoord[i] = cubies[i].getFlip();
+    cubie = seconds(start);
+    start = Clock::now();
+    for(uint32_t r = 0; r < rounds; r++) batch.getFlip(coord.data());
+    batched = seconds(start);
+    report("flip", -1, cubie, batched, n, rounds, coord == expectedCoord);
+
+    // every move once per round, so all of them are timed and the states stay scrambled
+    start = Clock::now();
+    for(uint32_t r = 0; r < rounds; r++) for(uint8_t m = 0; m < 18; m++) for(size_t i = 0; i < n; i++) models[i].applyMove((MOVE)m);
+    model = seconds(start) / 18;
+    start = Clock::now();
+    for(uint32_t r = 0; r < rounds; r++) for(uint8_t m = 0; m < 18; m++) for(size_t i = 0; i < n; i++) cubies[i].applyMove((MOVE)m);
+    cubie = seconds(start) / 18;
+    start = Clock::now();
+    for(uint32_t r = 0; r < rounds; r++) for(uint8_t m = 0; m < 18; m++) batch.applyMove((MOVE)m);
+    batched = seconds(start) / 18;
+    bool same = true;
+    for(size_t i = 0; i < n && same; i++) same = batch.get(i) == models[i] && batch.getCubie(i) == cubies[i];
+    report("applyMove", model, cubie, batched, n, rounds, same);
+
+    printf("%s%s\n", batch.size() && sink ? "" : " ", failed ? "FAILED" : "all results agree");
+    return failed ? 1 : 0;
+}
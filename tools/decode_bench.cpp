@@ -0,0 +1,73 @@
+/**
+ * @author Matrixchung
+ * @brief  Packets per second of decodeBatch() against the one packet at a time path, which must agree on every half byte.
+ *
+ * Build: g++ -O2 -std=gnu++17 -I src tools/decode_bench.cpp -o decode_bench
+ * Usage: ./decode_bench [capture file of raw 20 byte packets | packet count, 4000000] [rounds, 10]
+ *
+ * Without a capture file the packets are random bytes, half of them marked encrypted, which costs the same to decode.
+ *
+ * **/
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include "CubePacket.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static double seconds(Clock::time_point from)
+{
+    return std::chrono::duration<double>(Clock::now() - from).count();
+}
+static bool readCapture(const char *path, vector<uint8_t> &bytes)
+{
+    FILE *file = fopen(path, "rb");
+    if(!file) return false;
+    uint8_t buffer[4096];
+    size_t length;
+    while((length = fread(buffer, 1, sizeof(buffer), file)) > 0) bytes.insert(bytes.end(), buffer, buffer + length);
+    fclose(file);
+    bytes.resize(bytes.size() / CUBE_PACKET_LENGTH * CUBE_PACKET_LENGTH);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    vector<uint8_t> bytes;
+    if(argc < 2 || !readCapture(argv[1], bytes))
+    {
+        size_t count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 4000000;
+        std::mt19937 random(1);
+        bytes.resize(count * CUBE_PACKET_LENGTH);
+        for(size_t i = 0; i < bytes.size(); i++) bytes[i] = random();
+        for(size_t p = 0; p < count; p += 2) bytes[p * CUBE_PACKET_LENGTH + 18] = CUBE_PACKET_ENCRYPTED;
+    }
+    uint32_t rounds = argc > 2 ? atoi(argv[2]) : 10;
+    size_t n = bytes.size() / CUBE_PACKET_LENGTH;
+    const uint8_t (*packets)[CUBE_PACKET_LENGTH] = (const uint8_t (*)[CUBE_PACKET_LENGTH])bytes.data();
+    DecodedBatch scalar, batch;
+    decodeBatchScalar(packets, n, scalar);
+    decodeBatch(packets, n, batch);
+    size_t mismatches = 0;
+    for(uint8_t i = 0; i < CUBE_PACKET_NIBBLES; i++)
+    {
+        for(size_t p = 0; p < n; p++) mismatches += scalar.nibbles[i][p] != batch.nibbles[i][p];
+    }
+    Clock::time_point start = Clock::now();
+    for(uint32_t r = 0; r < rounds; r++) decodeBatchScalar(packets, n, scalar);
+    double scalarTime = seconds(start);
+    start = Clock::now();
+    for(uint32_t r = 0; r < rounds; r++) decodeBatch(packets, n, batch);
+    double batchTime = seconds(start);
+    #ifdef CUBE_PACKET_AVX2
+    bool avx2 = __builtin_cpu_supports("avx2");
+    #else
+    bool avx2 = false;
+    #endif
+    printf("%zu packets, %s\n", n, avx2 ? "AVX2" : "no AVX2, both scalar");
+    printf("scalar : %7.1f M packets/s\n", n * rounds / scalarTime / 1e6);
+    printf("batch  : %7.1f M packets/s, %.2fx\n", n * rounds / batchTime / 1e6, scalarTime / batchTime);
+    if(mismatches) printf("%zu half bytes differ\n", mismatches);
+    return mismatches ? 1 : 0;
+}
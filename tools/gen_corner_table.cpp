@@ -0,0 +1,62 @@
+/**
+ * @author Matrixchung
+ * @brief  Writes the corner distance table of CornerTable.hpp for the "cornerdb" flash partition.
+ *
+ * Build: g++ -O2 -std=gnu++17 -I src tools/gen_corner_table.cpp -o gen_corner_table
+ * Usage: ./gen_corner_table corner_table.bin [bits per entry, 2]
+ * Flash: esptool.py --chip esp32 write_flash 0x1D0000 corner_table.bin (the offset of cornerdb in partitions.csv)
+ *
+ * The table takes ~3 s to build. With 2 bits (distances mod 3) the file is 918,556 bytes and fits the cornerdb partition,
+ * with 4 bits it is 1,837,096 bytes and needs the partition grown to 0x1C1000. Flashing the app does not touch the
+ * partition, so this is done once.
+ *
+ * **/
+#include <cstdio>
+#include <cstdlib>
+#include "CornerTable.hpp"
+
+int main(int argc, char **argv)
+{
+    if(argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <output file> [bits per entry, 2 or 4]\n", argv[0]);
+        return 1;
+    }
+    uint8_t bits = argc > 2 ? atoi(argv[2]) : 2;
+    if(bits != 2 && bits != 4)
+    {
+        fprintf(stderr, "Bits per entry are 2 or 4\n");
+        return 1;
+    }
+    NibbleTable table;
+    buildCornerTable(table);
+    vector<uint8_t> entries(table.raw(), table.raw() + table.bytes());
+    if(bits == 2)
+    {
+        entries.resize(MOD3_BYTES(CORNER_TABLE_SIZE));
+        packMod3(table, CORNER_TABLE_SIZE, entries.data());
+    }
+    uint8_t header[CORNER_TABLE_HEADER];
+    cornerTableHeader(header, bits);
+    FILE *file = fopen(argv[1], "wb");
+    if(!file)
+    {
+        fprintf(stderr, "Could not open %s\n", argv[1]);
+        return 1;
+    }
+    bool ok = fwrite(header, 1, sizeof(header), file) == sizeof(header);
+    ok = ok && fwrite(entries.data(), 1, entries.size(), file) == entries.size();
+    if(fclose(file) != 0 || !ok)
+    {
+        fprintf(stderr, "Could not write %s\n", argv[1]);
+        return 1;
+    }
+    uint32_t count[16] = {0};
+    for(uint32_t i = 0; i < CORNER_TABLE_SIZE; i++) count[table.get(i)]++;
+    for(uint8_t d = 0; d < 16; d++)
+    {
+        if(count[d]) fprintf(stderr, "%2u moves: %u\n", d, count[d]);
+    }
+    fprintf(stderr, "Wrote %zu bytes to %s\n", sizeof(header) + entries.size(), argv[1]);
+    return 0;
+}
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+"""
+Generates the tables of src/FaceletCube.hpp.
+
+Facelet f * 9 + row * 3 + col is the sticker at (row, col) of face f (FACE order U L F R B D), laid out as in
+CubeModel::getColor(): U with B on top, D with F on top, the side faces with U on top.
+A clockwise quarter turn of a face moves 20 stickers in five 4-cycles, written like FACE_CORNERS: new[c[i]] = old[c[i+1]].
+CORNER_FACELETS / EDGE_FACELETS give the facelet of each slot's stickers, in the order of CORNER_FACES / EDGE_FACES.
+
+Usage: python3 tools/gen_facelet_tables.py > facelet_tables.txt
+"""
+
+# x - R, y - B, z - U
+NORMAL = {'U': (0, 0, 1), 'D': (0, 0, -1), 'R': (1, 0, 0), 'L': (-1, 0, 0), 'F': (0, -1, 0), 'B': (0, 1, 0)}
+FACES = ['U', 'L', 'F', 'R', 'B', 'D']
+# Same layout as CORNER_FACES / EDGE_FACES of CubeModel.hpp
+CORNER_FACES = ['ULB', 'UFL', 'URF', 'UBR', 'DBL', 'DLF', 'DFR', 'DRB']
+EDGE_FACES = ['UB', 'UL', 'UF', 'UR', 'BL', 'FL', 'FR', 'BR', 'DB', 'DL', 'DF', 'DR']
+# (up, right) of each face as drawn
+LAYOUT = {'U': ('B', 'R'), 'L': ('U', 'F'), 'F': ('U', 'R'), 'R': ('U', 'B'), 'B': ('U', 'L'), 'D': ('F', 'R')}
+
+def cross(a, b): return (a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0])
+def dot(a, b): return sum(x * y for x, y in zip(a, b))
+def turn(v, n):  # clockwise quarter turn seen from outside along n
+    c = cross(n, v); d = dot(n, v)
+    return tuple(-c[i] + n[i] * d for i in range(3))
+
+def stickers():
+    result = []
+    for f in FACES:
+        n = NORMAL[f]; up = NORMAL[LAYOUT[f][0]]; right = NORMAL[LAYOUT[f][1]]
+        for row in range(3):
+            for col in range(3):
+                pos = tuple(n[i] + right[i] * (col - 1) + up[i] * (1 - row) for i in range(3))
+                result.append((pos, n))
+    return result
+
+def cycles(face, st):
+    n = NORMAL[face]
+    # where each sticker goes
+    dest = {}
+    for i, (p, v) in enumerate(st):
+        if dot(p, n) == 1: dest[i] = st.index((turn(p, n), turn(v, n)))
+    seen, result = set(), []
+    for i in sorted(dest):
+        if i in seen or dest[i] == i: continue
+        c, j = [], i
+        while j not in seen:
+            seen.add(j); c.append(j); j = dest[j]
+        # c[k] moves to c[k+1], so new[c[k+1]] = old[c[k]]: reverse for new[c[i]] = old[c[i+1]]
+        result.append(list(reversed(c)))
+    if len(result) != 5 or any(len(c) != 4 for c in result): raise ValueError('not five 4-cycles')
+    return result
+
+def slot_facelets(slots, st):
+    result = []
+    for s in slots:
+        pos = tuple(sum(NORMAL[f][i] for f in s) for i in range(3))
+        result.append([st.index((pos, NORMAL[f])) for f in s])
+    return result
+
+def emit(name, rows):
+    print('const static uint8_t %s[%d][%d] = {' % (name, len(rows), len(rows[0])))
+    print('    ' + ', '.join('{' + ', '.join(str(i) for i in row) + '}' for row in rows))
+    print('};')
+
+if __name__ == '__main__':
+    st = stickers()
+    print('const static uint8_t FACELET_CYCLES[6][5][4] = {')
+    for k, f in enumerate(FACES):
+        print('    {' + ', '.join('{' + ', '.join(str(i) for i in c) + '}' for c in cycles(f, st)) + '}' + (',' if k < 5 else ''))
+    print('};')
+    emit('CORNER_FACELETS', slot_facelets(CORNER_FACES, st))
+    emit('EDGE_FACELETS', slot_facelets(EDGE_FACES, st))
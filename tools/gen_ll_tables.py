@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+"""
+Generates OLL_TABLE / PLL_TABLE of src/LastLayer.hpp.
+
+Every case is set up on a solved cube by the inverse of a well known algorithm (wide moves, slices and
+rotations allowed), then fingerprinted exactly like recognizeOll() / recognizePll() do, for all 4 AUFs.
+
+Usage: python3 tools/gen_ll_tables.py > tables.txt
+"""
+import sys
+
+# x - R, y - B, z - U
+NORMAL = {'U': (0, 0, 1), 'D': (0, 0, -1), 'R': (1, 0, 0), 'L': (-1, 0, 0), 'F': (0, -1, 0), 'B': (0, 1, 0)}
+FACES = ['U', 'L', 'F', 'R', 'B', 'D']
+# Same layout as CubeModel.hpp
+CORNER_FACES = ['ULB', 'UFL', 'URF', 'UBR', 'DBL', 'DLF', 'DFR', 'DRB']
+EDGE_FACES = ['UB', 'UL', 'UF', 'UR', 'BL', 'FL', 'FR', 'BR', 'DB', 'DL', 'DF', 'DR']
+FACE_CORNERS = [[0, 1, 2, 3], [0, 4, 5, 1], [1, 5, 6, 2], [2, 6, 7, 3], [0, 3, 7, 4], [4, 7, 6, 5]]
+FACE_EDGES = [[0, 1, 2, 3], [1, 4, 9, 5], [2, 5, 10, 6], [3, 6, 11, 7], [4, 0, 7, 8], [9, 8, 11, 10]]
+
+OLL_ALGS = [
+    "R U2 R2 F R F' U2 R' F R F'", "F R U R' U' F' f R U R' U' f'", "f R U R' U' f' U' F R U R' U' F'",
+    "f R U R' U' f' U F R U R' U' F'", "r' U2 R U R' U r", "r U2 R' U' R U' r'", "r U R' U R U2 r'",
+    "l' U' L U' L' U2 l", "R U R' U' R' F R2 U R' U' F'", "R U R' U R' F R F' R U2 R'",
+    "r U R' U R' F R F' R U2 r'", "M' R' U' R U' R' U2 R U' R r'", "F U R U' R2 F' R U R U' R'",
+    "R' F R U R' F' R F U' F'", "l' U' l L' U' L U l' U l", "r U r' R U R' U' r U' r'",
+    "F R' F' R2 r' U R U' R' U' M'", "r U R' U R U2 r2 U' R U' R' U2 r", "r' R U R U R' U' M' R' F R F'",
+    "r U R' U' M2 U R U' R' U' M'", "R U2 R' U' R U R' U' R U' R'", "R U2 R2 U' R2 U' R2 U2 R",
+    "R2 D' R U2 R' D R U2 R", "r U R' U' r' F R F'", "F' r U R' U' r' F R", "R U2 R' U' R U' R'",
+    "R U R' U R U2 R'", "r U R' U' r' R U R U' R'", "R U R' U' R U' R' F' U' F R U R'",
+    "F R' F R2 U' R' U' R U R' F2", "R' U' F U R U' R' F' R", "L U F' U' L' U L F L'",
+    "R U R' U' R' F R F'", "R U R2 U' R' F R U R U' F'", "R U2 R2 F R F' R U2 R'",
+    "L' U' L U' L' U L U L F' L' F", "F R' F' R U R U' R'", "R U R' U R U' R' U' R' F R F'",
+    "L F' L' U' L U F U' L'", "R' F R U R' U' F' U R", "R U R' U R U2 R' F R U R' U' F'",
+    "R' U' R U' R' U2 R F R U R' U' F'", "F' U' L' U L F", "F U R U' R' F'", "F R U R' U' F'",
+    "R' U' R' F R F' U R", "R' U' R' F R F' R' F R F' U R", "F R U R' U' R U R' U' F'",
+    "r U' r2 U r2 U r2 U' r", "r' U r2 U' r2 U' r2 U r'", "F U R U' R' U R U' R' F'",
+    "R U R' U R U' B U' B' R'", "l' U2 L U L' U' L U L' U l", "r U2 R' U' R U R' U' R U' r'",
+    "R' F R U R U' R2 F' R2 U' R' U R U R'", "r' U' r U' R' U R U' R' U R r' U r", "R U R' U' M' U R U' r'",
+]
+PLL_NAMES = ["Aa", "Ab", "E", "F", "Ga", "Gb", "Gc", "Gd", "H", "Ja", "Jb", "Na", "Nb", "Ra", "Rb", "T", "Ua", "Ub", "V", "Y", "Z"]
+PLL_ALGS = [
+    "x R' U R' D2 R U' R' D2 R2 x'", "x R2 D2 R U R' D2 R U' R x'", "x' R U' R' D R U R' D' R U R' D R U' R' D' x",
+    "R' U' F' R U R' U' R' F R2 U' R' U' R U R' U R", "R2 U R' U R' U' R U' R2 U' D R' U R D'",
+    "R' U' R U D' R2 U R' U R U' R U' R2 D", "R2 U' R U' R U R' U R2 U D' R U' R' D",
+    "R U R' U' D R2 U' R U' R' U R' U R2 D'", "M2 U M2 U2 M2 U M2", "R' U L' U2 R U' R' U2 R L",
+    "R U R' F' R U R' U' R' F R2 U' R'", "R U R' U R U R' F' R U R' U' R' F R2 U' R' U2 R U' R'",
+    "R' U R U' R' F' U' F R U R' F R' F' R U' R", "R U' R' U' R U R D R' U' R D' R' U2 R'",
+    "R2 F R U R U' R' F' R U2 R' U2 R", "R U R' U' R' F R2 U' R' U' R U R' F'", "M2 U M U2 M' U M2",
+    "M2 U' M U2 M' U' M2", "R' U R' U' y R' F' R2 U' R' U R' F R F", "F R U' R' U' R U R' F' R U R' U' R' F R F'",
+    "M' U M2 U M2 U M' U2 M2",
+]
+
+def cross(a, b): return (a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0])
+def dot(a, b): return sum(x * y for x, y in zip(a, b))
+def turn(v, n):  # clockwise quarter turn seen from outside along n
+    c = cross(n, v); d = dot(n, v)
+    return tuple(-c[i] + n[i] * d for i in range(3))
+def face_of(v):
+    return [f for f, n in NORMAL.items() if n == v][0]
+def slot_pos(faces): return tuple(sum(NORMAL[f][i] for f in faces) for i in range(3))
+
+# move letter -> (axis face, layers as set of dot(pos, axis))
+MOVES = {f: (f, {1}) for f in FACES}
+MOVES.update({f.lower(): (f, {0, 1}) for f in FACES})
+MOVES.update({'M': ('L', {0}), 'E': ('D', {0}), 'S': ('F', {0}), 'x': ('R', {-1, 0, 1}), 'y': ('U', {-1, 0, 1}), 'z': ('F', {-1, 0, 1})})
+
+def solved():
+    # sticker: (position, normal) -> color (home face)
+    st = {}
+    for x in (-1, 0, 1):
+        for y in (-1, 0, 1):
+            for z in (-1, 0, 1):
+                for f, n in NORMAL.items():
+                    if dot((x, y, z), n) == 1: st[((x, y, z), n)] = f
+    return st
+
+def apply(st, alg):
+    for tok in alg.split():
+        axis, layers = MOVES[tok[0]]
+        n = NORMAL[axis]
+        times = 2 if tok[1:] == '2' else 3 if tok[1:] == "'" else 1
+        for _ in range(times):
+            st = {((turn(p, n), turn(v, n)) if dot(p, n) in layers else (p, v)): c for (p, v), c in st.items()}
+    return st
+
+def invert(alg):
+    out = []
+    for tok in reversed(alg.split()):
+        out.append(tok if tok.endswith('2') else tok[0] if tok.endswith("'") else tok + "'")
+    return ' '.join(out)
+
+def reorient(st):
+    for a in ['', 'x', 'x2', "x'", 'z', "z'"]:
+        for b in ['', 'y', 'y2', "y'"]:
+            s = apply(st, (a + ' ' + b).strip()) if (a or b) else st
+            if all(s[(NORMAL[f], NORMAL[f])] == f for f in FACES): return s
+    raise ValueError('no orientation')
+
+def to_cubies(st):
+    """-> (corner piece, corner twist, edge piece, edge flip) per slot, CubeModel convention"""
+    cp, co, ep, eo = [], [], [], []
+    for faces in CORNER_FACES:
+        pos = slot_pos(faces)
+        colors = [st[(pos, NORMAL[f])] for f in faces]
+        piece = [i for i, g in enumerate(CORNER_FACES) if set(g) == set(colors)][0]
+        cp.append(piece); co.append(colors.index(CORNER_FACES[piece][0]))
+    for faces in EDGE_FACES:
+        pos = slot_pos(faces)
+        colors = [st[(pos, NORMAL[f])] for f in faces]
+        piece = [i for i, g in enumerate(EDGE_FACES) if set(g) == set(colors)][0]
+        ep.append(piece); eo.append(colors.index(EDGE_FACES[piece][0]))
+    return cp, co, ep, eo
+
+def f2l_solved(c):
+    cp, co, ep, eo = c
+    return all(cp[i] == i and co[i] == 0 for i in range(4, 8)) and all(ep[i] == i and eo[i] == 0 for i in range(4, 12))
+
+def oll_index(c, top='U'):
+    cp, co, ep, eo = c
+    t = FACES.index(top)
+    idx, mul = 0, 1
+    for i in range(4):
+        s = FACE_CORNERS[t][i]
+        k = CORNER_FACES[s].index(top)
+        n = (k - co[s]) % 3
+        m = CORNER_FACES[cp[s]].index(top)
+        idx += ((n + 3 - m) % 3) * mul; mul *= 3
+    for i in range(4):
+        s = FACE_EDGES[t][i]
+        k = EDGE_FACES[s].index(top)
+        if EDGE_FACES[ep[s]][(k + eo[s]) % 2] != top: idx += 81 << i
+    return idx
+
+def rank(perm):
+    r = 0
+    for i in range(len(perm)):
+        r = r * (len(perm) - i) + sum(1 for j in perm[i + 1:] if j < perm[i])
+    return r
+
+def pll_index(c, top='U'):
+    cp, co, ep, eo = c
+    t = FACE_CORNERS[FACES.index(top)]; e = FACE_EDGES[FACES.index(top)]
+    p = [t.index(cp[s]) for s in t]
+    q = [e.index(ep[s]) for s in e]
+    return rank([(x - p[0]) % 4 for x in p[1:]]) * 24 + rank([(x - p[0]) % 4 for x in q])
+
+def build(algs, index, size):
+    table = [0xFF] * size
+    cases = [''] + algs
+    for case, alg in enumerate(cases):
+        st = reorient(apply(solved(), invert(alg))) if alg else solved()
+        if not f2l_solved(to_cubies(st)): raise ValueError('F2L broken by case %d: %s' % (case, alg))
+        for auf in range(4):
+            # the solver sees the case after `auf` turns of U, and has to undo them first
+            i = index(to_cubies(apply(st, ' '.join(['U'] * auf))))
+            seen_auf = (4 - auf) % 4
+            if table[i] != 0xFF and (table[i] & 0x3F) != case: raise ValueError('case %d collides with %d' % (case, table[i] & 0x3F))
+            if table[i] == 0xFF or (table[i] >> 6) > seen_auf: table[i] = case | (seen_auf << 6)
+    return table
+
+def emit(name, table, per_line=24):
+    print('const static uint8_t %s[%d] = {' % (name, len(table)))
+    for i in range(0, len(table), per_line):
+        print('    ' + ', '.join('0x%02X' % v for v in table[i:i + per_line]) + (',' if i + per_line < len(table) else ''))
+    print('};')
+
+if __name__ == '__main__':
+    oll = build(OLL_ALGS, oll_index, 1296)
+    pll = build(PLL_ALGS, pll_index, 144)
+    sys.stderr.write('OLL fingerprints: %d, PLL fingerprints: %d\n' % (sum(v != 0xFF for v in oll), sum(v != 0xFF for v in pll)))
+    emit('OLL_TABLE', oll)
+    emit('PLL_TABLE', pll)
@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""
+Generates the tables of src/RotationTables.hpp.
+
+Rotation u * 4 + k holds the protocol face u up (FACE order U L F R B D), then turns the whole cube k times by y.
+Face u is first brought up by the quarter turn about the axis perpendicular to it and U (x2 for D).
+Every table is checked for handedness and group closure before printing.
+
+Usage: python3 tools/gen_rotation_tables.py > rotation_tables.txt
+"""
+import sys
+
+# x - R, y - B, z - U
+NORMAL = {'U': (0, 0, 1), 'D': (0, 0, -1), 'R': (1, 0, 0), 'L': (-1, 0, 0), 'F': (0, -1, 0), 'B': (0, 1, 0)}
+FACES = ['U', 'L', 'F', 'R', 'B', 'D']
+# Same layout as CORNER_FACES / EDGE_FACES of CubeModel.hpp: U/D (or F/B) sticker first, corners clockwise
+CORNER_FACES = ['ULB', 'UFL', 'URF', 'UBR', 'DBL', 'DLF', 'DFR', 'DRB']
+EDGE_FACES = ['UB', 'UL', 'UF', 'UR', 'BL', 'FL', 'FR', 'BR', 'DB', 'DL', 'DF', 'DR']
+
+def cross(a, b): return (a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0])
+def dot(a, b): return sum(x * y for x, y in zip(a, b))
+def face_of(v): return [f for f, n in NORMAL.items() if n == v][0]
+
+def quarter(axis):  # quarter turn about axis, as a function on vectors: a x v + a (a . v)
+    return lambda v: tuple(c + axis[i] * dot(axis, v) for i, c in enumerate(cross(axis, v)))
+
+def face_map(fn): return [FACES.index(face_of(fn(NORMAL[f]))) for f in FACES]
+
+def rotations():
+    y = quarter(NORMAL['D'])  # y takes F to L, like a clockwise U turn
+    result = []
+    for up in FACES:
+        if up == 'U': base = lambda v: v
+        elif up == 'D': base = lambda v: quarter(NORMAL['R'])(quarter(NORMAL['R'])(v))
+        else: base = quarter(cross(NORMAL[up], NORMAL['U']))
+        for k in range(4):
+            def fn(v, base=base, k=k):
+                v = base(v)
+                for _ in range(k): v = y(v)
+                return v
+            result.append(face_map(fn))
+    return result
+
+def slot_map(slots, faces):
+    table, delta = [], []
+    for s in slots:
+        mapped = [FACES[faces[FACES.index(f)]] for f in s]
+        target = [i for i, t in enumerate(slots) if set(t) == set(mapped)][0]
+        d = slots[target].index(mapped[0])
+        # the other stickers have to follow in the same order, a rotation keeps the handedness
+        if any(slots[target][(k + d) % len(s)] != mapped[k] for k in range(len(s))): raise ValueError('handedness')
+        table.append(target)
+        delta.append(d)
+    return table, delta
+
+def emit(name, rows):
+    if isinstance(rows[0], list):
+        print('constexpr static uint8_t %s[%d][%d] = {' % (name, len(rows), len(rows[0])))
+        for i, row in enumerate(rows):
+            print('    {' + ', '.join('0xFF' if v == 0xFF else str(v) for v in row) + '}' + (',' if i + 1 < len(rows) else ''))
+    else:
+        print('constexpr static uint8_t %s[%d] = {' % (name, len(rows)))
+        print('    ' + ', '.join(str(v) for v in rows))
+    print('};')
+
+if __name__ == '__main__':
+    rots = rotations()
+    if len(set(map(tuple, rots))) != 24 or rots[0] != list(range(6)): raise ValueError('not 24 rotations')
+    compose = [[rots.index([b[a[f]] for f in range(6)]) for b in rots] for a in rots]
+    inverse = [row.index(0) for row in compose]
+    of = [[0xFF] * 6 for _ in range(6)]
+    for r, faces in enumerate(rots):
+        of[faces.index(0)][faces.index(2)] = r
+    corners = [slot_map(CORNER_FACES, faces) for faces in rots]
+    edges = [slot_map(EDGE_FACES, faces) for faces in rots]
+    sys.stderr.write('24 rotations, closed under composition\n')
+    emit('ROTATION_FACE', rots)
+    emit('ROTATION_MOVE', [[faces[m // 3] * 3 + m % 3 for m in range(18)] for faces in rots])
+    emit('ROTATION_CORNER', [c[0] for c in corners])
+    emit('ROTATION_CORNER_TWIST', [c[1] for c in corners])
+    emit('ROTATION_EDGE', [e[0] for e in edges])
+    emit('ROTATION_EDGE_FLIP', [e[1] for e in edges])
+    emit('ROTATION_INVERSE', inverse)
+    emit('ROTATION_COMPOSE', compose)
+    emit('ROTATION_OF', of)
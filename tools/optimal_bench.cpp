@@ -0,0 +1,92 @@
+/**
+ * @author Matrixchung
+ * @brief  Compares the two optimal solvers by scramble depth: KorfSolver (IDA* with pattern databases) and MitmSolver.
+ *
+ * Build: g++ -O2 -std=gnu++17 -I src tools/optimal_bench.cpp -o optimal_bench
+ *        (add -DKORF_EDGE_GROUP=6 for 21 MB edge tables built in ~40 s instead of minutes)
+ * Usage: ./optimal_bench <tables file> [max depth, 12] [positions per depth, 20] [memory cap in MB, 1024]
+ *
+ * The tables are loaded from the file, or built and saved there. Positions are random face turn sequences of each
+ * depth, so some are shorter to solve. Both solvers have to agree on the length, and both solutions are checked.
+ *
+ * **/
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include "KorfSolver.hpp"
+#include "MitmSolver.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static double seconds(Clock::time_point from)
+{
+    return std::chrono::duration<double>(Clock::now() - from).count();
+}
+static bool solves(const CubeModel &cube, const MOVE *solution, int8_t length)
+{
+    if(length < 0) return false;
+    CubeModel result = cube;
+    for(int8_t i = 0; i < length; i++) result.applyMove(solution[i]);
+    return result.isSolved();
+}
+
+int main(int argc, char **argv)
+{
+    if(argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <tables file> [max depth] [positions per depth] [memory cap in MB]\n", argv[0]);
+        return 1;
+    }
+    uint8_t maxDepth = argc > 2 ? atoi(argv[2]) : 12;
+    uint32_t positions = argc > 3 ? atoi(argv[3]) : 20;
+    size_t memoryCap = (argc > 4 ? strtoull(argv[4], nullptr, 10) : 1024) << 20;
+    static KorfTables tables;
+    Clock::time_point start = Clock::now();
+    if(tables.load(argv[1])) fprintf(stderr, "Loaded %zu bytes of tables in %.1f s\n", tables.bytes(), seconds(start));
+    else
+    {
+        tables.build();
+        fprintf(stderr, "Built %zu bytes of tables in %.1f s\n", tables.bytes(), seconds(start));
+        if(!tables.save(argv[1])) fprintf(stderr, "Could not save the tables to %s\n", argv[1]);
+    }
+    KorfSolver korf(tables);
+    MitmSolver mitm(memoryCap);
+    std::mt19937 random(1);
+    printf("depth  optimal  IDA* ms      nodes     MITM ms     states  speedup\n");
+    for(uint8_t depth = 1; depth <= maxDepth; depth++)
+    {
+        double korfTime = 0, mitmTime = 0, optimal = 0;
+        uint64_t nodes = 0, states = 0;
+        uint32_t failed = 0;
+        for(uint32_t p = 0; p < positions; p++)
+        {
+            CubeModel cube;
+            uint8_t lastFace = 6;
+            for(uint8_t i = 0; i < depth; i++)
+            {
+                uint8_t move;
+                do move = random() % 18; while(move / 3 == lastFace);
+                lastFace = move / 3;
+                cube.applyMove((MOVE)move);
+            }
+            MOVE a[KORF_MAX_LENGTH], b[MITM_MAX_LENGTH];
+            start = Clock::now();
+            int8_t korfLength = korf.solve(cube, a, depth);
+            korfTime += seconds(start);
+            nodes += korf.getNodes();
+            start = Clock::now();
+            int8_t mitmLength = mitm.solve(cube, b, depth);
+            mitmTime += seconds(start);
+            states += mitm.getStates();
+            if(korfLength != mitmLength || !solves(cube, a, korfLength) || !solves(cube, b, mitmLength)) failed++;
+            optimal += korfLength;
+        }
+        printf("%5u  %7.2f  %7.3f  %9llu  %10.3f  %9llu  %6.2fx", depth, optimal / positions, korfTime * 1000 / positions,
+               (unsigned long long)(nodes / positions), mitmTime * 1000 / positions, (unsigned long long)(states / positions), korfTime / mitmTime);
+        if(failed) printf("  %u FAILED%s", failed, mitm.isOutOfMemory() ? " (memory cap)" : "");
+        printf("\n");
+        fflush(stdout);
+    }
+    return 0;
+}
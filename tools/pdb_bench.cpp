@@ -0,0 +1,155 @@
+/**
+ * @author Matrixchung
+ * @brief  KorfSolver on tables loaded with each kind of pages (PageMemory.hpp), shared or one copy per NUMA node:
+ *         load time, huge page coverage, nodes per second and data TLB misses per node.
+ *
+ * Build: g++ -O2 -std=gnu++17 -pthread -I src tools/pdb_bench.cpp -o pdb_bench
+ * Usage: ./pdb_bench <tables file from optimal_bench> [depth, 13] [positions, 12] [threads, all CPUs]
+ *
+ * Thread t runs on node t % nodes and solves every threads-th position, with the shared tables or with the copy made
+ * on its node. Every run searches the same positions, so the node counts have to agree. TLB misses are counted with
+ * perf_event_open per thread (user space only); "-" where the kernel or the virtual machine has no such counter.
+ * Explicit huge pages need a reserved pool first, ~65 pages per copy of the 7-edge tables (~130 with KORF_TABLE_BITS 4):
+ *  echo 300 > /proc/sys/vm/nr_hugepages
+ *
+ * **/
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "KorfSolver.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static double seconds(Clock::time_point from)
+{
+    return std::chrono::duration<double>(Clock::now() - from).count();
+}
+// Data TLB read misses of the calling thread, -1 if not available.
+static int openTlbCounter()
+{
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+struct Run
+{
+    uint64_t nodes, misses;
+    bool counted;
+};
+static void solvePart(const KorfTables *tables, const std::vector<CubieCube> *cubes, uint32_t thread, uint32_t threads,
+                       uint8_t nodes, uint8_t depth, Run *run)
+{
+    pinToNode(thread % nodes);
+    KorfSolver solver(*tables);
+    int counter = openTlbCounter();
+    if(counter >= 0) ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    run->nodes = 0;
+    for(size_t i = thread; i < cubes->size(); i += threads)
+    {
+        MOVE solution[KORF_MAX_LENGTH];
+        solver.solve((*cubes)[i], solution, depth);
+        run->nodes += solver.getNodes();
+    }
+    run->counted = counter >= 0 && read(counter, &run->misses, sizeof(run->misses)) == sizeof(run->misses);
+    if(counter >= 0) close(counter);
+}
+
+int main(int argc, char **argv)
+{
+    if(argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <tables file> [depth] [positions] [threads]\n", argv[0]);
+        return 1;
+    }
+    uint8_t depth = argc > 2 ? atoi(argv[2]) : 13;
+    uint32_t positions = argc > 3 ? atoi(argv[3]) : 12;
+    uint32_t threads = argc > 4 ? atoi(argv[4]) : std::thread::hardware_concurrency();
+    if(threads == 0) threads = 1;
+    uint8_t nodes = numaNodes();
+    std::mt19937 random(1);
+    std::vector<CubieCube> cubes(positions);
+    for(uint32_t p = 0; p < positions; p++)
+    {
+        uint8_t lastFace = 6;
+        for(uint8_t i = 0; i < depth; i++)
+        {
+            uint8_t move;
+            do move = random() % 18; while(move / 3 == lastFace);
+            lastFace = move / 3;
+            cubes[p].applyMove((MOVE)move);
+        }
+    }
+    printf("%u positions of depth %u, %u threads, %u NUMA nodes\n", positions, depth, threads, nodes);
+    printf("pages        copies  load s  huge MB    Mn/s  TLB misses / node\n");
+    uint64_t expected = 0;
+    bool failed = false;
+    const PAGES kinds[3] = {PAGES::NORMAL, PAGES::TRANSPARENT, PAGES::EXPLICIT};
+    for(uint8_t k = 0; k < 3; k++)
+    {
+        const uint8_t copyCounts[2] = {1, nodes};
+        for(uint8_t n = 0; n < (nodes > 1 ? 2 : 1); n++)
+        {
+            uint8_t copies = copyCounts[n];
+            // copy c is loaded or replicated by a thread on node c, so its pages are first written there
+            std::vector<KorfTables> tables(copies);
+            bool loaded = true;
+            Clock::time_point start = Clock::now();
+            std::thread([&]() { pinToNode(0); loaded = tables[0].load(argv[1], kinds[k]); }).join();
+            for(uint8_t c = 1; c < copies && loaded; c++)
+            {
+                std::thread([&]() { pinToNode(c); loaded = tables[c].replicate(tables[0], kinds[k]); }).join();
+            }
+            double loadTime = seconds(start);
+            if(!loaded)
+            {
+                fprintf(stderr, "Could not load %s with %s pages\n", argv[1], pagesName(kinds[k]));
+                return 1;
+            }
+            size_t huge = 0;
+            for(uint8_t c = 0; c < copies; c++) huge += tables[c].getHugeBytes();
+            std::vector<Run> runs(threads);
+            std::vector<std::thread> workers;
+            start = Clock::now();
+            for(uint32_t t = 0; t < threads; t++)
+            {
+                workers.emplace_back(solvePart, &tables[copies > 1 ? t % nodes : 0], &cubes, t, threads, nodes, depth, &runs[t]);
+            }
+            for(auto &worker : workers) worker.join();
+            double time = seconds(start);
+            uint64_t searched = 0, misses = 0;
+            bool counted = true;
+            for(uint32_t t = 0; t < threads; t++)
+            {
+                searched += runs[t].nodes;
+                misses += runs[t].misses;
+                counted = counted && runs[t].counted;
+            }
+            if(!expected) expected = searched;
+            printf("%-11s  %6u  %6.2f  %7zu  %6.2f  ", pagesName(tables[0].getPages()), copies, loadTime, huge >> 20, searched / time / 1e6);
+            if(counted) printf("%17.2f", (double)misses / searched);
+            else printf("%17s", "-");
+            if(searched != expected)
+            {
+                printf("  FAILED, %llu nodes instead of %llu", (unsigned long long)searched, (unsigned long long)expected);
+                failed = true;
+            }
+            printf("\n");
+            fflush(stdout);
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,69 @@
+/**
+ * @author Matrixchung
+ * @brief  Writes random-state scrambles for test datasets, one per line, with the generator of the ESP32 build.
+ *
+ * Build: g++ -O2 -std=gnu++17 -pthread -DTWO_PHASE_FULL_TABLES -I src tools/scramble_gen.cpp -o scramble_gen
+ * Usage: ./scramble_gen <count> [threads] [max length, 22] > scrambles.txt
+ *
+ * The full tables take ~8 s to build and ~2 MB, shared by all threads. Each thread has its own solver and random generator.
+ *
+ * **/
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+#include "ScrambleGenerator.hpp"
+
+#define OUTPUT_CHUNK 256 // scrambles written at once
+
+static TwoPhaseTables tables;
+static std::atomic<int64_t> remaining;
+static std::mutex outputLock;
+static thread_local std::mt19937 threadRandom;
+
+static uint32_t nextRandom()
+{
+    return threadRandom();
+}
+static void worker(uint32_t seed, uint8_t maxLength)
+{
+    threadRandom.seed(seed);
+    ScrambleGenerator generator(tables, nextRandom, maxLength);
+    string output;
+    uint32_t buffered = 0;
+    while(remaining.fetch_sub(1) > 0)
+    {
+        Scramble scramble;
+        while(!generator.generate(scramble));
+        output += scramble.toString();
+        output += '\n';
+        if(++buffered < OUTPUT_CHUNK) continue;
+        std::lock_guard<std::mutex> lock(outputLock);
+        fwrite(output.data(), 1, output.size(), stdout);
+        output.clear();
+        buffered = 0;
+    }
+    std::lock_guard<std::mutex> lock(outputLock);
+    fwrite(output.data(), 1, output.size(), stdout);
+}
+
+int main(int argc, char **argv)
+{
+    if(argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <count> [threads] [max length]\n", argv[0]);
+        return 1;
+    }
+    remaining = strtoll(argv[1], nullptr, 10);
+    uint32_t threads = argc > 2 ? atoi(argv[2]) : std::thread::hardware_concurrency();
+    uint8_t maxLength = argc > 3 ? atoi(argv[3]) : 22;
+    if(threads == 0) threads = 1;
+    tables.build();
+    std::random_device device;
+    std::vector<std::thread> workers;
+    for(uint32_t i = 0; i < threads; i++) workers.emplace_back(worker, device(), maxLength);
+    for(auto &thread : workers) thread.join();
+    return 0;
+}
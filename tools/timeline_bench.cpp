@@ -0,0 +1,68 @@
+/**
+ * @author Matrixchung
+ * @brief  Seek times of Timeline against its memory, for each checkpoint interval, on a long session of random moves.
+ *
+ * Build: g++ -O2 -std=gnu++17 -I src tools/timeline_bench.cpp -o timeline_bench
+ * Usage: ./timeline_bench [session moves, 100000] [seeks, 1000000]
+ *
+ * Seeks go to random moves of the session. Every 1000th is checked against a cube replayed from the start.
+ * The desktop numbers are for comparing intervals; applyMove() is ~10x slower on the ESP32.
+ *
+ * **/
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include "Timeline.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static double seconds(Clock::time_point from)
+{
+    return std::chrono::duration<double>(Clock::now() - from).count();
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t length = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+    uint32_t seeks = argc > 2 ? strtoul(argv[2], nullptr, 10) : 1000000;
+    std::mt19937 random(1);
+    vector<MOVE> session(length);
+    for(uint32_t i = 0; i < length; i++) session[i] = (MOVE)(random() % 18);
+    vector<uint32_t> targets(seeks);
+    for(uint32_t i = 0; i < seeks; i++) targets[i] = random() % (length + 1);
+    // references for the checked seeks, replayed once in target order
+    vector<CubieCube> expected((seeks + 999) / 1000);
+    for(uint32_t i = 0; i < seeks; i += 1000)
+    {
+        for(uint32_t m = 0; m < targets[i]; m++) expected[i / 1000].applyMove(session[m]);
+    }
+    printf("interval    bytes  bytes/move  append ns/move  seek ns\n");
+    const uint16_t intervals[] = {1, 4, 16, 64, 256, 1024};
+    for(uint16_t interval : intervals)
+    {
+        Timeline timeline(interval);
+        Clock::time_point start = Clock::now();
+        for(MOVE move : session) timeline.append(move);
+        double appendTime = seconds(start);
+        CubieCube cube;
+        volatile uint8_t sink = 0; // keeps the seeks from being optimized out
+        start = Clock::now();
+        for(uint32_t i = 0; i < seeks; i++)
+        {
+            timeline.seek(targets[i], cube);
+            sink = sink + cube.cp[0];
+        }
+        double seekTime = seconds(start);
+        uint32_t failed = 0;
+        for(uint32_t i = 0; i < seeks; i += 1000)
+        {
+            if(!timeline.seek(targets[i], cube) || !(cube == expected[i / 1000])) failed++;
+        }
+        printf("%8u  %7zu  %10.3f  %14.1f  %7.1f", interval, timeline.bytes(), (double)timeline.bytes() / length,
+               appendTime * 1e9 / length, seekTime * 1e9 / seeks);
+        if(failed) printf("  %u FAILED", failed);
+        printf("\n");
+    }
+    return 0;
+}